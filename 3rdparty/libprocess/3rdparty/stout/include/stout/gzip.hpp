@@ -23,7 +23,7 @@
 #include "try.hpp"
 
 // Compression utilities.
-// TODO(bmahler): Provide streaming compression / decompression as well.
+// TODO(bmahler): Provide streaming compression as well.
 namespace gzip {
 
 // We use a 16KB buffer with zlib compression / decompression.
@@ -144,6 +144,98 @@ inline Try<std::string> decompress(const std::string& compressed)
   return result;
 }
 
+
+// Streaming decompression, for when the compressed data arrives in
+// pieces (e.g., off a socket) and holding all of it in memory before
+// decompressing is undesirable. Each call to 'decompress' returns the
+// data that can be decompressed from the input so far.
+class Decompressor
+{
+public:
+  Decompressor() : initialized(false), finished_(false)
+  {
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    code = inflateInit2(
+        &stream,
+        MAX_WBITS + 16); // Zlib magic for gzip compression / decompression.
+
+    initialized = code == Z_OK;
+  }
+
+  ~Decompressor()
+  {
+    if (initialized) {
+      inflateEnd(&stream);
+    }
+  }
+
+  Try<std::string> decompress(const std::string& compressed)
+  {
+    if (!initialized) {
+      return Error("Failed to initialize zlib: " + stringify(code));
+    }
+
+    if (finished_) {
+      // Ignore trailing data after the end of the stream, like gzip.
+      return std::string();
+    }
+
+    stream.next_in =
+      const_cast<Bytef*>(reinterpret_cast<const Bytef*>(compressed.data()));
+    stream.avail_in = compressed.length();
+
+    // Decompress as much as we can from the input.
+    Bytef buffer[GZIP_BUFFER_SIZE];
+    std::string result = "";
+    do {
+      stream.next_out = buffer;
+      stream.avail_out = GZIP_BUFFER_SIZE;
+      code = inflate(&stream, Z_SYNC_FLUSH);
+
+      if (code == Z_BUF_ERROR) {
+        break; // Need more input.
+      } else if (code != Z_OK && code != Z_STREAM_END) {
+        return Error(stream.msg != NULL ? stream.msg : stringify(code));
+      }
+
+      // Consume output.
+      result.append(
+          reinterpret_cast<char*>(buffer),
+          GZIP_BUFFER_SIZE - stream.avail_out);
+    } while (code != Z_STREAM_END &&
+             (stream.avail_in > 0 || stream.avail_out == 0));
+
+    finished_ = code == Z_STREAM_END;
+
+    // Don't hold on to the caller's buffer.
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    return result;
+  }
+
+  // Returns true once the end of the compressed stream was reached.
+  bool finished() const
+  {
+    return finished_;
+  }
+
+private:
+  // Not copyable, the zlib stream can't be shared.
+  Decompressor(const Decompressor&);
+  Decompressor& operator = (const Decompressor&);
+
+  z_stream_s stream;
+  int code;
+  bool initialized;
+  bool finished_;
+};
+
 } // namespace gzip {
 
 #endif // __STOUT_GZIP_HPP__
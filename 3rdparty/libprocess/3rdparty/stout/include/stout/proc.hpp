@@ -20,7 +20,11 @@
 #endif
 
 #include <errno.h>
+#include <fcntl.h>
 #include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <sys/types.h> // For pid_t.
 
@@ -162,25 +166,97 @@ struct ProcessStatus
 };
 
 
+namespace internal {
+
+// Parses the next (space separated) number in 'data', advancing
+// 'data' past it. Returns false if there isn't a number next.
+template <typename T>
+inline bool next(const char** data, const char* end, T* value)
+{
+  const char* p = *data;
+
+  while (p < end && *p == ' ') {
+    p++;
+  }
+
+  bool negative = false;
+  if (p < end && *p == '-') {
+    negative = true;
+    p++;
+  }
+
+  if (p == end || *p < '0' || *p > '9') {
+    return false;
+  }
+
+  unsigned long long result = 0;
+  while (p < end && *p >= '0' && *p <= '9') {
+    result = result * 10 + (*p - '0');
+    p++;
+  }
+
+  *value = negative ? (T) -(long long) result : (T) result;
+  *data = p;
+  return true;
+}
+
+} // namespace internal {
+
+
 // Returns the process statistics from /proc/[pid]/stat.
 // The return value is None if the process does not exist.
 inline Result<ProcessStatus> status(pid_t pid)
 {
-  std::string path = "/proc/" + stringify(pid) + "/stat";
+  char path[64];
+  ::snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+  // NOTE: We read the file into a buffer on the stack and parse it by
+  // hand (rather than using 'os::read' and an 'std::istringstream')
+  // since this gets called for every process on the host when
+  // walking process trees.
+  char buffer[4096];
+  ssize_t length = -1;
+
+  int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    do {
+      length = ::read(fd, buffer, sizeof(buffer));
+    } while (length < 0 && errno == EINTR);
+
+    ::close(fd);
+  }
+
+  if (length < 0) {
+    ErrnoError error("Failed to read '" + std::string(path) + "'");
 
-  Try<std::string> read = os::read(path);
-  if (read.isError()) {
     // Need to check if file exists AFTER we open it to guarantee
     // process hasn't terminated.
     if (!os::exists(path)) {
       return None();
     }
-    return Error(read.error());
+    return error;
+  }
+
+  const char* data = buffer;
+  const char* end = buffer + length;
+
+  // The command (i.e., 'comm') is in parentheses and can contain any
+  // character (including spaces and parentheses), so it ends at the
+  // last ')'.
+  const char* open = (const char*) ::memchr(buffer, '(', length);
+  const char* close = NULL;
+  for (const char* p = end - 1; p > open && open != NULL; p--) {
+    if (*p == ')') {
+      close = p;
+      break;
+    }
   }
 
-  std::istringstream data(read.get());
+  if (open == NULL || close == NULL || close + 2 >= end) {
+    return Error("Failed to read/parse '" + std::string(path) + "'");
+  }
 
-  std::string comm;
+  std::string comm(open + 1, close - open - 1);
   char state;
   pid_t ppid;
   pid_t pgrp;
@@ -224,27 +300,45 @@ inline Result<ProcessStatus> status(pid_t pid)
   // unsigned long guest_time;
   // unsigned int cguest_time;
 
-  std::string _; // For ignoring fields.
-
-  // Parse all fields from stat.
-  data >> _ >> comm >> state >> ppid >> pgrp >> session >> tty_nr
-       >> tpgid >> flags >> minflt >> cminflt >> majflt >> cmajflt
-       >> utime >> stime >> cutime >> cstime >> priority >> nice
-       >> num_threads >> itrealvalue >> starttime >> vsize >> rss
-       >> rsslim >> startcode >> endcode >> startstack >> kstkeip
-       >> signal >> blocked >> sigcatch >> wchan >> nswap >> cnswap;
-
-  // Check for any read/parse errors.
-  if (data.fail() && !data.eof()) {
-    return Error("Failed to read/parse '" + path + "'");
+  state = close[2];
+  data = close + 3;
+
+  // Parse the rest of the fields from stat.
+  if (!internal::next(&data, end, &ppid) ||
+      !internal::next(&data, end, &pgrp) ||
+      !internal::next(&data, end, &session) ||
+      !internal::next(&data, end, &tty_nr) ||
+      !internal::next(&data, end, &tpgid) ||
+      !internal::next(&data, end, &flags) ||
+      !internal::next(&data, end, &minflt) ||
+      !internal::next(&data, end, &cminflt) ||
+      !internal::next(&data, end, &majflt) ||
+      !internal::next(&data, end, &cmajflt) ||
+      !internal::next(&data, end, &utime) ||
+      !internal::next(&data, end, &stime) ||
+      !internal::next(&data, end, &cutime) ||
+      !internal::next(&data, end, &cstime) ||
+      !internal::next(&data, end, &priority) ||
+      !internal::next(&data, end, &nice) ||
+      !internal::next(&data, end, &num_threads) ||
+      !internal::next(&data, end, &itrealvalue) ||
+      !internal::next(&data, end, &starttime) ||
+      !internal::next(&data, end, &vsize) ||
+      !internal::next(&data, end, &rss) ||
+      !internal::next(&data, end, &rsslim) ||
+      !internal::next(&data, end, &startcode) ||
+      !internal::next(&data, end, &endcode) ||
+      !internal::next(&data, end, &startstack) ||
+      !internal::next(&data, end, &kstkeip) ||
+      !internal::next(&data, end, &signal) ||
+      !internal::next(&data, end, &blocked) ||
+      !internal::next(&data, end, &sigcatch) ||
+      !internal::next(&data, end, &wchan) ||
+      !internal::next(&data, end, &nswap) ||
+      !internal::next(&data, end, &cnswap)) {
+    return Error("Failed to read/parse '" + std::string(path) + "'");
   }
 
-  // Remove the parentheses that is wrapped around 'comm' (when
-  // printing out the process in a process tree we use parentheses to
-  // indicate "zombie" processes).
-  comm = strings::remove(comm, "(", strings::PREFIX);
-  comm = strings::remove(comm, ")", strings::SUFFIX);
-
   return ProcessStatus(pid, comm, state, ppid, pgrp, session, tty_nr,
                        tpgid, flags, minflt, cminflt, majflt, cmajflt,
                        utime, stime, cutime, cstime, priority, nice,
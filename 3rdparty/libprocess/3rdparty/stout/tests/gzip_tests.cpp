@@ -50,4 +50,38 @@ TEST(GzipTest, CompressDecompressString)
   ASSERT_SOME(decompressed);
   ASSERT_EQ(s, decompressed.get());
 }
+
+
+TEST(GzipTest, StreamingDecompress)
+{
+  // A 1MB random string, so that it doesn't compress well and spans
+  // many of the decompressor's buffers.
+  string s = "";
+  while (s.length() < (1024 * 1024)) {
+    s.append(1, ' ' + (rand() % ('~' - ' ')));
+  }
+
+  Try<string> compressed = gzip::compress(s);
+  ASSERT_SOME(compressed);
+
+  // Feed the compressed data in odd sized pieces.
+  gzip::Decompressor decompressor;
+  string decompressed = "";
+  for (size_t i = 0; i < compressed.get().length(); i += 1021) {
+    EXPECT_FALSE(decompressor.finished());
+
+    Try<string> piece =
+      decompressor.decompress(compressed.get().substr(i, 1021));
+
+    ASSERT_SOME(piece);
+    decompressed += piece.get();
+  }
+
+  EXPECT_TRUE(decompressor.finished());
+  EXPECT_EQ(s, decompressed);
+
+  // Corrupted data should fail.
+  gzip::Decompressor corrupted;
+  EXPECT_ERROR(corrupted.decompress("not gzip compressed data"));
+}
 #endif // HAVE_LIBZ
@@ -5,10 +5,15 @@
 #include <gmock/gmock.h>
 
 #include <set>
+#include <sstream>
+#include <string>
 
 #include <stout/abort.hpp>
 #include <stout/gtest.hpp>
+#include <stout/os.hpp>
 #include <stout/proc.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 using proc::CPU;
@@ -57,6 +62,46 @@ TEST(ProcTest, ProcessStatus)
 }
 
 
+// Compares parsing /proc/[pid]/stat in place against tokenizing it
+// with a stream, which is how it used to get parsed.
+TEST(ProcTest, DISABLED_ProcessStatusBenchmark)
+{
+  const size_t iterations = 10000;
+  const std::string path = "/proc/" + stringify(getpid()) + "/stat";
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Result<ProcessStatus> status = proc::status(getpid());
+    ASSERT_SOME(status);
+    EXPECT_EQ(getpid(), status.get().pid);
+  }
+
+  const Duration parsed = stopwatch.elapsed();
+
+  stopwatch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<std::string> read = os::read(path);
+    ASSERT_SOME(read);
+
+    std::istringstream data(read.get());
+    std::string token;
+    size_t tokens = 0;
+    while (data >> token) {
+      tokens++;
+    }
+    EXPECT_LE(44u, tokens);
+  }
+
+  const Duration streamed = stopwatch.elapsed();
+
+  std::cout << "Parsed " << iterations << " statuses in " << parsed
+            << " (" << streamed << " using a stream)" << std::endl;
+}
+
+
 TEST(ProcTest, SingleThread)
 {
   pid_t pid = ::fork();
@@ -139,7 +139,9 @@ struct Response
   // already specified.
   //
   // PATH: Attempts to perform a 'sendfile' operation on the file
-  // found at 'path'.
+  // found at 'path'. If the 'Content-Range' header is set (i.e.,
+  // 'bytes <first>-<last>/<size>') only that range of the file gets
+  // sent.
   //
   // PIPE: Splices data from 'pipe' using 'Transfer-Encoding=chunked'.
   // Note that the read end of the pipe will be closed by libprocess
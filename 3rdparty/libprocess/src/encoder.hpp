@@ -219,8 +219,10 @@ public:
 class FileEncoder : public Encoder
 {
 public:
-  FileEncoder(const Socket& s, int _fd, size_t _size)
-    : Encoder(s), fd(_fd), size(_size), index(0) {}
+  // Sends the file from 'offset' up to 'size' (i.e., the end of
+  // what gets sent).
+  FileEncoder(const Socket& s, int _fd, size_t _size, off_t offset = 0)
+    : Encoder(s), fd(_fd), size(_size), index(offset) {}
 
   virtual ~FileEncoder()
   {
@@ -1720,18 +1720,53 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
         VLOG(1) << "Returning '404 Not Found' for directory '" << path << "'";
         socket_manager->send(NotFound(), request, socket);
       } else {
+        // Send only the range of the file asked for, if any.
+        off_t first = 0;
+        off_t last = s.st_size - 1;
+
+        bool satisfiable = true;
+        if (response.headers.contains("Content-Range")) {
+          long long first_, last_;
+          if (sscanf(response.headers["Content-Range"].c_str(),
+                     "bytes %lld-%lld/",
+                     &first_,
+                     &last_) != 2) {
+            satisfiable = false;
+          } else {
+            first = first_;
+            last = last_;
+            satisfiable = first >= 0 && first <= last && last < s.st_size;
+          }
+        }
+
+        if (!satisfiable) {
+          // The file must have been truncated.
+          VLOG(1) << "Failed to send range '"
+                  << response.headers["Content-Range"] << "' of file at '"
+                  << path << "' with length " << s.st_size;
+          os::close(fd);
+          Response response;
+          response.status = "416 Requested Range Not Satisfiable";
+          response.headers["Content-Range"] = "bytes */" + stringify(s.st_size);
+          socket_manager->send(response, request, socket);
+          return true; // All done, can process next request.
+        }
+
+        const off_t length = last - first + 1;
+
         // While the user is expected to properly set a 'Content-Type'
         // header, we fill in (or overwrite) 'Content-Length' header.
         stringstream out;
-        out << s.st_size;
+        out << length;
         response.headers["Content-Length"] = out.str();
 
-        if (s.st_size == 0) {
+        if (length == 0) {
+          os::close(fd);
           socket_manager->send(response, request, socket);
           return true; // All done, can process next request.
         }
 
-        VLOG(1) << "Sending file at '" << path << "' with length " << s.st_size;
+        VLOG(1) << "Sending file at '" << path << "' with length " << length;
 
         // TODO(benh): Consider a way to have the socket manager turn
         // on TCP_CORK for both sends and then turn it off.
@@ -1741,7 +1776,7 @@ bool HttpProxy::process(const Future<Response>& future, const Request& request)
 
         // Note the file descriptor gets closed by FileEncoder.
         socket_manager->send(
-            new FileEncoder(socket, fd, s.st_size),
+            new FileEncoder(socket, fd, last + 1, first),
             request.keepAlive);
       }
     }
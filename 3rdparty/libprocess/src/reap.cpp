@@ -1,17 +1,27 @@
+#include <errno.h>
+#include <unistd.h>
+
 #include <glog/logging.h>
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif // __linux__
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <process/defer.hpp>
 #include <process/delay.hpp>
 #include <process/future.hpp>
 #include <process/id.hpp>
+#include <process/io.hpp>
 #include <process/once.hpp>
 #include <process/owned.hpp>
 #include <process/reap.hpp>
 
 #include <stout/check.hpp>
 #include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
 #include <stout/multihashmap.hpp>
 #include <stout/none.hpp>
 #include <stout/os.hpp>
@@ -20,11 +30,29 @@
 
 namespace process {
 
+#if defined(__linux__) && !defined(SYS_pidfd_open)
+#define SYS_pidfd_open 434 // Same on all architectures.
+#endif
+
+
+// Returns a file descriptor that becomes readable once the process
+// terminates (a 'pidfd', Linux 5.3 and later), or None if that's not
+// supported.
+static Option<int> pidfd(pid_t pid)
+{
+#ifdef __linux__
+  int fd = ::syscall(SYS_pidfd_open, pid, 0);
+  if (fd >= 0) {
+    return fd;
+  }
+#endif // __linux__
+  return None();
+}
 
-// TODO(bmahler): This can be optimized to use a thread per pid, where
-// each thread makes a blocking call to waitpid. This eliminates the
-// unfortunate 1 second reap delay.
 
+// Processes are watched using a 'pidfd' (when supported) which gets
+// polled on the event loop, so they are reaped as soon as they
+// terminate. Otherwise, processes get checked every second.
 class ReaperProcess : public Process<ReaperProcess>
 {
 public:
@@ -39,6 +67,16 @@ public:
       // The process exists, we add it to the promises map.
       Owned<Promise<Option<int> > > promise(new Promise<Option<int> >());
       promises.put(pid, promise);
+
+      if (!pidfds.contains(pid)) {
+        Option<int> fd = pidfd(pid);
+        if (fd.isSome()) {
+          pidfds[pid] = fd.get();
+          io::poll(fd.get(), io::READ)
+            .onAny(defer(self(), &ReaperProcess::polled, pid));
+        }
+      }
+
       return promise->future();
     } else if (process.isNone()) {
       return None();
@@ -53,37 +91,59 @@ protected:
   virtual void initialize() { wait(); }
 
   void wait()
+  {
+    foreach (pid_t pid, promises.keys()) {
+      // Processes that get polled are checked once they terminate.
+      if (pidfds.contains(pid)) {
+        continue;
+      }
+
+      check(pid);
+    }
+
+    delay(Seconds(1), self(), &ReaperProcess::wait); // Reap forever!
+  }
+
+  // Invoked once the process has terminated, or polling failed.
+  void polled(pid_t pid)
+  {
+    CHECK(pidfds.contains(pid));
+    os::close(pidfds[pid]);
+    pidfds.erase(pid);
+
+    // NOTE: If polling failed and the process is still running it
+    // gets checked every second instead.
+    check(pid);
+  }
+
+  void check(pid_t pid)
   {
     // There are a few cases to consider here for each pid:
     //   1) The process is our child. In this case, we will notify
     //      with the exit status once it terminates.
     //   2) The process exists but is not our child. In this case,
-    //      we'll notify with None() once it no longer exists, since
-    //      we cannot reap it.
+    //      we'll notify with None() once it terminates, since we
+    //      cannot reap it.
     //   3) The process does not exist, notify with None() since it
     //      has likely been reaped elsewhere.
-
-    foreach (pid_t pid, promises.keys()) {
-      int status;
-      if (waitpid(pid, &status, WNOHANG) > 0) {
-        // Terminated child process.
-        notify(pid, status);
-      } else if (errno == ECHILD) {
-        // The process is not our child, or does not exist. We want to
-        // notify with None() once it no longer exists (reaped by
-        // someone else).
-        const Result<os::Process>& process = os::process(pid);
-
-        if (process.isError()) {
-          notify(pid, Error(process.error()));
-        } else if (process.isNone()) {
-          // The process has been reaped.
-          notify(pid, None());
-        }
+    int status;
+    pid_t result = waitpid(pid, &status, WNOHANG);
+    if (result > 0) {
+      // Terminated child process.
+      notify(pid, status);
+    } else if (result < 0 && errno == ECHILD) {
+      // The process is not our child, or does not exist. We want to
+      // notify with None() once it has terminated (to be reaped by
+      // someone else).
+      const Result<os::Process>& process = os::process(pid);
+
+      if (process.isError()) {
+        notify(pid, Error(process.error()));
+      } else if (process.isNone() || process.get().zombie) {
+        // The process has been (or is about to be) reaped.
+        notify(pid, None());
       }
     }
-
-    delay(Seconds(1), self(), &ReaperProcess::wait); // Reap forever!
   }
 
   void notify(pid_t pid, Result<int> status)
@@ -102,6 +162,9 @@ protected:
 
 private:
   multihashmap<pid_t, Owned<Promise<Option<int> > > > promises;
+
+  // The pidfds of the processes that are being polled.
+  hashmap<pid_t, int> pidfds;
 };
 
 
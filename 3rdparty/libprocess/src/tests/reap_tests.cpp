@@ -1,8 +1,12 @@
+#include <errno.h>
 #include <signal.h>
 #include <unistd.h>
 
 #include <sys/wait.h>
 
+#include <iostream>
+#include <list>
+
 #include <gtest/gtest.h>
 
 #include <process/clock.hpp>
@@ -12,13 +16,18 @@
 #include <process/reap.hpp>
 
 #include <stout/exit.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
+#include <stout/os.hpp>
 #include <stout/os/fork.hpp>
 #include <stout/os/pstree.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/try.hpp>
 
 using namespace process;
 
+using std::list;
+
 using os::Exec;
 using os::Fork;
 using os::ProcessTree;
@@ -177,3 +186,61 @@ TEST(Reap, TerminatedChildProcess)
 
   Clock::resume();
 }
+
+
+// Checks that many short-lived children get reaped as soon as they
+// exit, rather than on the next check of the reaper.
+TEST(Reap, ChildProcessLatency)
+{
+  ASSERT_TRUE(GTEST_IS_THREADSAFE);
+
+  // The children block until the pipe gets closed.
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  list<pid_t> children;
+  list<Future<Option<int> > > statuses;
+
+  for (int i = 0; i < 100; i++) {
+    pid_t pid = ::fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+      ::close(pipes[1]);
+      char c;
+      while (::read(pipes[0], &c, 1) == -1 && errno == EINTR);
+      ::_exit(0);
+    }
+
+    children.push_back(pid);
+    statuses.push_back(process::reap(pid));
+  }
+
+  ::close(pipes[0]);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  ::close(pipes[1]);
+
+  foreach (const Future<Option<int> >& status, statuses) {
+    AWAIT_READY(status);
+    ASSERT_SOME(status.get());
+    EXPECT_TRUE(WIFEXITED(status.get().get()));
+  }
+
+  std::cout << "Reaped " << children.size() << " children in "
+            << stopwatch.elapsed() << std::endl;
+
+#ifdef __linux__
+  // Without a pidfd (before Linux 5.3) the children only get checked
+  // once per second.
+  Try<os::Release> release = os::release();
+  ASSERT_SOME(release);
+
+  if (release.get().version > 5 ||
+      (release.get().version == 5 && release.get().major >= 3)) {
+    EXPECT_LT(stopwatch.elapsed(), Seconds(1));
+  }
+#endif // __linux__
+}
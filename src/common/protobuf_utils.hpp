@@ -25,6 +25,7 @@
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/net.hpp>
 #include <stout/none.hpp>
 #include <stout/stringify.hpp>
@@ -98,6 +99,42 @@ inline Task createTask(const TaskInfo& task,
   return t;
 }
 
+// Returns a copy of the status with only the fields needed to keep
+// track of a task's history, i.e., without the 'data' which can be
+// arbitrarily large. The 'message' is kept since it tells operators
+// why a task failed. This is what the master stores.
+inline TaskStatus compact(const TaskStatus& status)
+{
+  TaskStatus compacted;
+  compacted.mutable_task_id()->MergeFrom(status.task_id());
+  compacted.set_state(status.state());
+
+  if (status.has_message()) {
+    compacted.set_message(status.message());
+  }
+
+  if (status.has_timestamp()) {
+    compacted.set_timestamp(status.timestamp());
+  }
+
+  return compacted;
+}
+
+
+// Returns a copy of the task with all of its statuses compacted.
+inline Task compact(const Task& task)
+{
+  Task compacted(task);
+  compacted.clear_statuses();
+
+  foreach (const TaskStatus& status, task.statuses()) {
+    compacted.add_statuses()->MergeFrom(compact(status));
+  }
+
+  return compacted;
+}
+
+
 // Helper function that creates a MasterInfo from UPID.
 inline MasterInfo createMasterInfo(const process::UPID& pid)
 {
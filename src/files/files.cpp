@@ -1,22 +1,30 @@
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif // __linux__
 #include <sys/stat.h>
 
 #include <algorithm>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/shared_array.hpp>
 
+#include <process/defer.hpp>
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
+#include <process/delay.hpp>
 #include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/http.hpp>
 #include <process/io.hpp>
 #include <process/mime.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 
+#include <stout/duration.hpp>
 #include <stout/error.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/json.hpp>
@@ -56,7 +64,7 @@ namespace internal {
 class FilesProcess : public Process<FilesProcess>
 {
 public:
-  FilesProcess();
+  explicit FilesProcess(const Bytes& maxReadLength);
 
   // Files implementation.
   Future<Nothing> attach(const string& path, const string& name);
@@ -64,6 +72,7 @@ public:
 
 protected:
   virtual void initialize();
+  virtual void finalize();
 
 private:
   // Resolves the virtual path to an actual path.
@@ -91,15 +100,70 @@ private:
   //   path: The directory to browse. Required.
   Future<Response> download(const Request& request);
 
+  // Returns the raw contents of a file, or of a range of it, which
+  // get sent straight from the file (i.e., using 'sendfile').
+  // Requests have the following parameters:
+  //   path: The file to read. Required.
+  //   offset: Where to start reading from, defaults to 0.
+  //   length: How much to read, defaults to the rest of the file.
+  //   follow: If 'true' and there is nothing to read at the offset,
+  //     wait for the file to grow (at most 'timeout', which defaults
+  //     to 10 seconds) rather than returning nothing right away.
+  // A 'Range' header (e.g., 'bytes=0-99', 'bytes=100-', 'bytes=-100')
+  // can be used in place of offset and length. Reads are capped at
+  // 'maxReadLength', a partial read is returned as '206 Partial
+  // Content' with a 'Content-Range' header.
+  Future<Response> raw(const Request& request);
+
+  // Returns the response for reading (at most) 'length' bytes at
+  // 'offset' of the file, where a negative offset is relative to the
+  // end of the file (i.e., a suffix range).
+  Response serve(
+      const string& path,
+      off_t offset,
+      const Option<off_t>& length,
+      bool ranged);
+
   // Returns the internal virtual path mapping.
   Future<Response> debug(const Request& request);
 
+  const Bytes maxReadLength;
+
   hashmap<string, string> paths;
+
+#ifdef __linux__
+  // A read waiting for the file to grow.
+  struct Follower
+  {
+    int fd; // The inotify instance.
+    int wd; // The watch of the file.
+    string path;
+    off_t offset;
+    Option<off_t> length;
+    bool ranged;
+    Future<short> poll; // Whether the inotify instance is readable.
+    Owned<Promise<Response> > promise;
+  };
+
+  // Completes the read once the file has changed (or the wait for it
+  // expired).
+  void _raw(uint64_t id);
+
+  // Ends the wait for the file to change.
+  void expire(uint64_t id);
+
+  hashmap<uint64_t, Follower> followers;
+  uint64_t nextFollower;
+#endif // __linux__
 };
 
 
-FilesProcess::FilesProcess()
-  : ProcessBase("files")
+FilesProcess::FilesProcess(const Bytes& _maxReadLength)
+  : ProcessBase("files"),
+    maxReadLength(_maxReadLength)
+#ifdef __linux__
+    , nextFollower(0)
+#endif // __linux__
 {}
 
 
@@ -108,10 +172,28 @@ void FilesProcess::initialize()
   route("/browse.json", None(), &FilesProcess::browse);
   route("/read.json", None(), &FilesProcess::read);
   route("/download.json", None(), &FilesProcess::download);
+  route("/raw", None(), &FilesProcess::raw);
   route("/debug.json", None(), &FilesProcess::debug);
 }
 
 
+void FilesProcess::finalize()
+{
+#ifdef __linux__
+  // Return whatever there is to read to the pending followers.
+  foreachvalue (Follower& follower, followers) {
+    if (follower.poll.isPending()) {
+      // Wakes up the poll, which closes the inotify instance.
+      ::inotify_rm_watch(follower.fd, follower.wd);
+    }
+    follower.promise->set(serve(
+        follower.path, follower.offset, follower.length, follower.ranged));
+  }
+  followers.clear();
+#endif // __linux__
+}
+
+
 Future<Nothing> FilesProcess::attach(const string& path, const string& name)
 {
   Result<string> result = os::realpath(path);
@@ -365,6 +447,275 @@ Future<Response> FilesProcess::download(const Request& request)
 }
 
 
+// Parses a (single range) 'Range' header into an offset and length,
+// see 'FilesProcess::serve'.
+static Try<std::pair<off_t, Option<off_t> > > range(const string& header)
+{
+  if (!strings::startsWith(header, "bytes=") ||
+      header.find(',') != string::npos) {
+    return Error("Only a single byte range is supported");
+  }
+
+  const string& value = strings::trim(header.substr(strlen("bytes=")));
+
+  size_t dash = value.find('-');
+  if (dash == string::npos) {
+    return Error("Expecting '<first>-<last>'");
+  }
+
+  const string& first = value.substr(0, dash);
+  const string& last = value.substr(dash + 1);
+
+  if (first.empty()) {
+    // A suffix range, i.e., the last 'n' bytes.
+    Try<off_t> n = numify<off_t>(last);
+    if (n.isError() || n.get() <= 0) {
+      return Error("Invalid suffix length '" + last + "'");
+    }
+    return std::make_pair(-n.get(), Option<off_t>::none());
+  }
+
+  Try<off_t> offset = numify<off_t>(first);
+  if (offset.isError() || offset.get() < 0) {
+    return Error("Invalid first byte position '" + first + "'");
+  }
+
+  if (last.empty()) {
+    return std::make_pair(offset.get(), Option<off_t>::none());
+  }
+
+  Try<off_t> end = numify<off_t>(last);
+  if (end.isError() || end.get() < offset.get()) {
+    return Error("Invalid last byte position '" + last + "'");
+  }
+
+  return std::make_pair(
+      offset.get(), Option<off_t>(end.get() - offset.get() + 1));
+}
+
+
+// Closes the inotify instance of a follower once it's been polled.
+static void closeInotify(int fd)
+{
+  os::close(fd);
+}
+
+
+Future<Response> FilesProcess::raw(const Request& request)
+{
+  Option<string> path = request.query.get("path");
+
+  if (!path.isSome() || path.get().empty()) {
+    return BadRequest("Expecting 'path=value' in query.\n");
+  }
+
+  off_t offset = 0;
+  Option<off_t> length = None();
+  bool ranged = false;
+
+  if (request.headers.contains("Range")) {
+    Try<std::pair<off_t, Option<off_t> > > result =
+      range(request.headers.get("Range").get());
+
+    // Like other servers we ignore a 'Range' header we don't support
+    // and return the whole file instead.
+    if (result.isSome()) {
+      offset = result.get().first;
+      length = result.get().second;
+      ranged = true;
+    } else {
+      VLOG(1) << "Ignoring 'Range: " << request.headers.get("Range").get()
+              << "': " << result.error();
+    }
+  }
+
+  if (!ranged && request.query.get("offset").isSome()) {
+    Try<off_t> result = numify<off_t>(request.query.get("offset").get());
+    if (result.isError() || result.get() < 0) {
+      return BadRequest("Failed to parse offset: " +
+                        (result.isError() ? result.error() : "Negative") +
+                        ".\n");
+    }
+    offset = result.get();
+  }
+
+  if (!ranged && request.query.get("length").isSome()) {
+    Try<off_t> result = numify<off_t>(request.query.get("length").get());
+    if (result.isError() || result.get() < 0) {
+      return BadRequest("Failed to parse length: " +
+                        (result.isError() ? result.error() : "Negative") +
+                        ".\n");
+    }
+    length = result.get();
+  }
+
+  Duration timeout = Seconds(10);
+
+  if (request.query.get("timeout").isSome()) {
+    Try<Duration> result = Duration::parse(request.query.get("timeout").get());
+    if (result.isError()) {
+      return BadRequest("Failed to parse timeout: " + result.error() + ".\n");
+    }
+    timeout = result.get();
+  }
+
+  Result<string> resolvedPath = resolve(path.get());
+
+  if (resolvedPath.isError()) {
+    return BadRequest(resolvedPath.error() + ".\n");
+  } else if (!resolvedPath.isSome()) {
+    return NotFound();
+  }
+
+  // Don't read directories.
+  if (os::isdir(resolvedPath.get())) {
+    return BadRequest("Cannot read a directory.\n");
+  }
+
+  if (request.query.get("follow") != string("true") || offset < 0) {
+    return serve(resolvedPath.get(), offset, length, ranged);
+  }
+
+#ifdef __linux__
+  int fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    PLOG(WARNING) << "Failed to initialize inotify";
+    return serve(resolvedPath.get(), offset, length, ranged);
+  }
+
+  int wd = ::inotify_add_watch(
+      fd,
+      resolvedPath.get().c_str(),
+      IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+
+  if (wd < 0) {
+    PLOG(WARNING) << "Failed to watch '" << resolvedPath.get() << "'";
+    os::close(fd);
+    return serve(resolvedPath.get(), offset, length, ranged);
+  }
+
+  // Check the size only once watched, so that we don't miss a write
+  // that happens in between.
+  struct stat s;
+  if (::stat(resolvedPath.get().c_str(), &s) < 0 || offset < s.st_size) {
+    os::close(fd);
+    return serve(resolvedPath.get(), offset, length, ranged);
+  }
+
+  const uint64_t id = nextFollower++;
+
+  Follower follower;
+  follower.fd = fd;
+  follower.wd = wd;
+  follower.path = resolvedPath.get();
+  follower.offset = offset;
+  follower.length = length;
+  follower.ranged = ranged;
+  follower.poll = io::poll(fd, io::READ);
+  follower.promise.reset(new Promise<Response>());
+
+  followers[id] = follower;
+
+  // NOTE: The instance is closed by the poll callback (rather than
+  // when the follower is done) since closing it while it's being
+  // polled isn't safe.
+  follower.poll
+    .onAny(lambda::bind(&closeInotify, fd))
+    .onAny(defer(self(), &Self::_raw, id));
+
+  delay(timeout, self(), &Self::expire, id);
+
+  return follower.promise->future();
+#else
+  return serve(resolvedPath.get(), offset, length, ranged);
+#endif // __linux__
+}
+
+
+Response FilesProcess::serve(
+    const string& path,
+    off_t offset,
+    const Option<off_t>& length,
+    bool ranged)
+{
+  struct stat s;
+  if (::stat(path.c_str(), &s) < 0) {
+    if (errno == ENOENT) {
+      return NotFound();
+    }
+    string error = "Failed to stat '" + path + "': " + strerror(errno);
+    LOG(WARNING) << error;
+    return InternalServerError(error + ".\n");
+  }
+
+  const off_t size = s.st_size;
+
+  if (offset < 0) {
+    offset = std::max<off_t>(size + offset, 0);
+  }
+
+  if (offset >= size) {
+    if (ranged) {
+      Response response;
+      response.status = "416 Requested Range Not Satisfiable";
+      response.headers["Content-Range"] = "bytes */" + stringify(size);
+      return response;
+    }
+    return OK();
+  }
+
+  off_t last = size - 1;
+  if (length.isSome()) {
+    last = std::min(last, offset + length.get() - 1);
+  }
+  last = std::min<off_t>(last, offset + maxReadLength.bytes() - 1);
+
+  Response response;
+  response.status = "200 OK";
+  response.type = response.PATH;
+  response.path = path;
+  response.headers["Content-Type"] = "application/octet-stream";
+  response.headers["Accept-Ranges"] = "bytes";
+
+  // NOTE: The range is also what gets libprocess to send only that
+  // part of the file.
+  if (ranged || offset > 0 || last < size - 1) {
+    response.status = "206 Partial Content";
+    response.headers["Content-Range"] =
+      "bytes " + stringify(offset) + "-" + stringify(last) + "/" +
+      stringify(size);
+  }
+
+  return response;
+}
+
+
+#ifdef __linux__
+void FilesProcess::_raw(uint64_t id)
+{
+  if (!followers.contains(id)) {
+    return;
+  }
+
+  Follower follower = followers[id];
+  followers.erase(id);
+
+  follower.promise->set(serve(
+      follower.path, follower.offset, follower.length, follower.ranged));
+}
+
+
+void FilesProcess::expire(uint64_t id)
+{
+  // Removing the watch queues an event, which wakes up the poll. If
+  // the poll is done the inotify instance might be closed already.
+  if (followers.contains(id) && followers[id].poll.isPending()) {
+    ::inotify_rm_watch(followers[id].fd, followers[id].wd);
+  }
+}
+#endif // __linux__
+
+
 Future<Response> FilesProcess::debug(const Request& request)
 {
   JSON::Object object;
@@ -442,9 +793,9 @@ Result<string> FilesProcess::resolve(const string& path)
 }
 
 
-Files::Files()
+Files::Files(const Bytes& maxReadLength)
 {
-  process = new FilesProcess();
+  process = new FilesProcess(maxReadLength);
   spawn(process);
 }
 
@@ -29,6 +29,7 @@
 #include <process/future.hpp>
 #include <process/http.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/format.hpp>
 #include <stout/json.hpp>
 #include <stout/nothing.hpp>
@@ -50,7 +51,9 @@ class FilesProcess;
 class Files
 {
 public:
-  Files();
+  // Reads of the raw contents of a file are capped at
+  // 'maxReadLength' per request.
+  explicit Files(const Bytes& maxReadLength = Megabytes(1));
   ~Files();
 
   // Returns the result of trying to attach the specified path
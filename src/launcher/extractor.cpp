@@ -0,0 +1,474 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <string>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/numify.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "launcher/extractor.hpp"
+
+#include "logging/logging.hpp"
+
+using std::string;
+
+namespace mesos {
+namespace internal {
+
+static const size_t BLOCK_SIZE = 512;
+
+
+// Parses an octal (or, for large values, base-256) header field.
+static Try<uint64_t> number(const char* field, size_t length)
+{
+  uint64_t value = 0;
+
+  if (field[0] & 0x80) {
+    for (size_t i = 1; i < length; i++) {
+      value = (value << 8) | (unsigned char) field[i];
+    }
+    return value;
+  }
+
+  size_t i = 0;
+  while (i < length && field[i] == ' ') {
+    i++;
+  }
+
+  for (; i < length && field[i] != '\0' && field[i] != ' '; i++) {
+    if (field[i] < '0' || field[i] > '7') {
+      return Error("Invalid number in tar header");
+    }
+    value = (value << 3) | (field[i] - '0');
+  }
+
+  return value;
+}
+
+
+// Returns a NUL terminated header field as a string.
+static string field(const char* field, size_t length)
+{
+  return string(field, strnlen(field, length));
+}
+
+
+// Refuses to extract through a symbolic link: checks that none of the
+// existing components of 'relative', a path within 'directory', is a
+// symbolic link (as created by an earlier entry, for instance).
+static Try<Nothing> nofollow(const string& directory, const string& relative)
+{
+  string path = directory;
+
+  foreach (const string& component, strings::tokenize(relative, "/")) {
+    path = path::join(path, component);
+
+    struct stat s;
+    if (::lstat(path.c_str(), &s) < 0) {
+      if (errno == ENOENT) {
+        return Nothing(); // The rest doesn't exist (yet) either.
+      }
+      return ErrnoError("Failed to stat '" + path + "'");
+    }
+
+    if (S_ISLNK(s.st_mode)) {
+      return Error("Refusing to extract through symbolic link '" + path + "'");
+    }
+  }
+
+  return Nothing();
+}
+
+
+// Returns true if a symbolic link at 'name' (relative to the directory)
+// pointing to 'target' would point outside of the directory.
+static bool escapes(const string& name, const string& target)
+{
+  if (target.empty() || strings::startsWith(target, "/")) {
+    return true;
+  }
+
+  // Start from the directory containing the link.
+  int depth = -1;
+  foreach (const string& component, strings::tokenize(name, "/")) {
+    if (component != ".") {
+      depth++;
+    }
+  }
+
+  foreach (const string& component, strings::tokenize(target, "/")) {
+    if (component == "..") {
+      if (--depth < 0) {
+        return true;
+      }
+    } else if (component != ".") {
+      depth++;
+    }
+  }
+
+  return false;
+}
+
+
+Extractor::Extractor(const string& _directory)
+  : directory(_directory),
+    remaining(0),
+    padding(0),
+    type('\0'),
+    mode(0),
+    mtime(0),
+    fd(-1),
+    zeros(0) {}
+
+
+Extractor::~Extractor()
+{
+  if (fd >= 0) {
+    os::close(fd);
+  }
+}
+
+
+Try<Nothing> Extractor::write(const char* data, size_t length)
+{
+  Try<string> decompressed = decompressor.decompress(string(data, length));
+
+  if (decompressed.isError()) {
+    return Error("Failed to decompress: " + decompressed.error());
+  }
+
+  return untar(decompressed.get().data(), decompressed.get().length());
+}
+
+
+Try<Nothing> Extractor::close()
+{
+  if (!decompressor.finished()) {
+    return Error("Unexpected end of gzip stream");
+  } else if (remaining > 0 || !block.empty()) {
+    return Error("Unexpected end of tar archive");
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> Extractor::untar(const char* data, size_t length)
+{
+  while (length > 0) {
+    size_t size;
+
+    if (remaining > 0) {
+      size = std::min<uint64_t>(remaining, length);
+      Try<Nothing> consumed = consume(data, size);
+      if (consumed.isError()) {
+        return consumed;
+      }
+
+      remaining -= size;
+      if (remaining == 0) {
+        Try<Nothing> finished = finish();
+        if (finished.isError()) {
+          return finished;
+        }
+      }
+    } else if (padding > 0) {
+      size = std::min<uint64_t>(padding, length);
+      padding -= size;
+    } else if (zeros == 2) {
+      // End of archive, ignore anything that follows like tar does.
+      return Nothing();
+    } else {
+      size = std::min(BLOCK_SIZE - block.length(), length);
+      block.append(data, size);
+
+      if (block.length() == BLOCK_SIZE) {
+        Try<Nothing> parsed = header(block.data());
+        block.clear();
+        if (parsed.isError()) {
+          return parsed;
+        }
+      }
+    }
+
+    data += size;
+    length -= size;
+  }
+
+  return Nothing();
+}
+
+
+Try<string> Extractor::resolve(const string& name)
+{
+  if (strings::startsWith(name, "/")) {
+    return Error("Refusing to extract absolute path '" + name + "'");
+  }
+
+  foreach (const string& component, strings::tokenize(name, "/")) {
+    if (component == "..") {
+      return Error("Refusing to extract path '" + name + "'");
+    }
+  }
+
+  return path::join(directory, name);
+}
+
+
+Try<Nothing> Extractor::header(const char* block)
+{
+  unsigned int checksum = 0;
+  for (size_t i = 0; i < BLOCK_SIZE; i++) {
+    // The checksum field itself is taken to be all spaces.
+    checksum += (i >= 148 && i < 156) ? ' ' : (unsigned char) block[i];
+  }
+
+  if (checksum == ' ' * 8) {
+    zeros++; // A zero block, two of which mark the end of the archive.
+    return Nothing();
+  }
+
+  zeros = 0;
+
+  Try<uint64_t> expected = number(block + 148, 8);
+  if (expected.isError() || expected.get() != checksum) {
+    return Error("Invalid tar header checksum");
+  }
+
+  Try<uint64_t> size = number(block + 124, 12);
+  Try<uint64_t> mode_ = number(block + 100, 8);
+  Try<uint64_t> mtime_ = number(block + 136, 12);
+
+  if (size.isError() || mode_.isError() || mtime_.isError()) {
+    return Error("Invalid tar header");
+  }
+
+  type = block[156];
+  mode = mode_.get() & 0777;
+  mtime = mtime_.get();
+  remaining = size.get();
+  padding = (BLOCK_SIZE - size.get() % BLOCK_SIZE) % BLOCK_SIZE;
+
+  // GNU long names and pax headers describe the entry that follows.
+  if (type == 'L' || type == 'K' || type == 'x') {
+    extended.clear();
+    return remaining == 0 ? finish() : Nothing();
+  }
+
+  string name = field(block, 100);
+  if (memcmp(block + 257, "ustar", 5) == 0 && block[345] != '\0') {
+    name = field(block + 345, 155) + "/" + name;
+  }
+
+  string link = field(block + 157, 100);
+
+  if (longName.isSome()) {
+    name = longName.get();
+    longName = None();
+  }
+
+  if (longLink.isSome()) {
+    link = longLink.get();
+    longLink = None();
+  }
+
+  Try<string> resolved = resolve(name);
+  if (resolved.isError()) {
+    return Error(resolved.error());
+  }
+
+  path = resolved.get();
+
+  // A directory may already exist, in which case it mustn't be a
+  // symbolic link either. Other entries replace whatever is there.
+  Try<string> parent = os::dirname(name);
+  if (parent.isError()) {
+    return Error(parent.error());
+  }
+
+  Try<Nothing> checked = nofollow(directory, type == '5' ? name : parent.get());
+  if (checked.isError()) {
+    return checked;
+  }
+
+  Try<Nothing> mkdir = os::mkdir(path::join(directory, parent.get()));
+  if (mkdir.isError()) {
+    return Error(mkdir.error());
+  }
+
+  switch (type) {
+    case '0': case '\0': case '7': {
+      // Replace rather than write through whatever is there.
+      ::unlink(path.c_str());
+
+      Try<int> open = os::open(
+          path,
+          O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+          mode);
+
+      if (open.isError()) {
+        return Error("Failed to create '" + path + "': " + open.error());
+      }
+
+      fd = open.get();
+
+      // Don't let the umask get in the way of the archived mode.
+      if (::fchmod(fd, mode) < 0) {
+        return ErrnoError("Failed to chmod '" + path + "'");
+      }
+      break;
+    }
+    case '1': {
+      Try<string> target = resolve(link);
+      if (target.isError()) {
+        return Error(target.error());
+      }
+
+      Try<Nothing> checked = nofollow(directory, link);
+      if (checked.isError()) {
+        return checked;
+      }
+
+      ::unlink(path.c_str());
+      if (::link(target.get().c_str(), path.c_str()) < 0) {
+        return ErrnoError("Failed to link '" + path + "'");
+      }
+      break;
+    }
+    case '2': {
+      if (escapes(name, link)) {
+        return Error("Refusing to extract symbolic link '" + name +
+                     "' to '" + link + "'");
+      }
+
+      ::unlink(path.c_str());
+      if (::symlink(link.c_str(), path.c_str()) < 0) {
+        return ErrnoError("Failed to symlink '" + path + "'");
+      }
+      break;
+    }
+    case '5': {
+      Try<Nothing> mkdir = os::mkdir(path);
+      if (mkdir.isError()) {
+        return Error(mkdir.error());
+      }
+
+      // Keep the directory writable so we can extract into it.
+      if (!os::chmod(path, mode | S_IRWXU)) {
+        return ErrnoError("Failed to chmod '" + path + "'");
+      }
+      break;
+    }
+    default:
+      // Devices, FIFOs, pax global headers etc. get skipped.
+      LOG(WARNING) << "Skipping '" << name << "' of unsupported type '"
+                   << type << "' in archive";
+      break;
+  }
+
+  return remaining == 0 ? finish() : Nothing();
+}
+
+
+Try<Nothing> Extractor::consume(const char* data, size_t length)
+{
+  if (type == 'L' || type == 'K' || type == 'x') {
+    extended.append(data, length);
+    return Nothing();
+  } else if (fd < 0) {
+    return Nothing(); // Skipped entry.
+  }
+
+  while (length > 0) {
+    ssize_t written = ::write(fd, data, length);
+    if (written < 0 && errno != EINTR) {
+      return ErrnoError("Failed to write '" + path + "'");
+    } else if (written > 0) {
+      data += written;
+      length -= written;
+    }
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> Extractor::finish()
+{
+  if (type == 'L') {
+    longName = extended.c_str(); // Up to the terminating NUL.
+  } else if (type == 'K') {
+    longLink = extended.c_str();
+  } else if (type == 'x') {
+    // Records are of the form "<length> <key>=<value>\n".
+    size_t offset = 0;
+    while (offset < extended.length()) {
+      size_t space = extended.find(' ', offset);
+      if (space == string::npos) {
+        return Error("Invalid pax header");
+      }
+
+      Try<uint64_t> length = numify<uint64_t>(
+          extended.substr(offset, space - offset));
+
+      if (length.isError() ||
+          length.get() <= space - offset ||
+          offset + length.get() > extended.length()) {
+        return Error("Invalid pax header");
+      }
+
+      const string record =
+        extended.substr(space + 1, offset + length.get() - space - 2);
+
+      if (strings::startsWith(record, "path=")) {
+        longName = record.substr(5);
+      } else if (strings::startsWith(record, "linkpath=")) {
+        longLink = record.substr(9);
+      }
+
+      offset += length.get();
+    }
+  } else if (fd >= 0) {
+    // Restore the modification time, like tar does.
+    struct timeval times[2];
+    times[0].tv_sec = times[1].tv_sec = mtime;
+    times[0].tv_usec = times[1].tv_usec = 0;
+    ::futimes(fd, times);
+
+    os::close(fd);
+    fd = -1;
+  }
+
+  return Nothing();
+}
+
+} // namespace internal {
+} // namespace mesos {
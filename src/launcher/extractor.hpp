@@ -0,0 +1,101 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LAUNCHER_EXTRACTOR_HPP__
+#define __LAUNCHER_EXTRACTOR_HPP__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <sys/types.h>
+
+#include <string>
+
+#include <stout/gzip.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+
+// Extracts a gzip compressed tar archive into a directory as the bytes
+// of the archive arrive, so that extracting a download overlaps with
+// downloading it and the archive never needs to be re-read from disk.
+// Handles ustar archives along with the GNU and pax extensions for long
+// names, i.e., what GNU tar and bsdtar produce.
+// NOTE: The fetcher runs as root, so nothing gets extracted outside of
+// the directory: entries with absolute paths or '..' components,
+// entries under a symbolic link and links pointing outside of the
+// directory are all refused.
+class Extractor
+{
+public:
+  explicit Extractor(const std::string& directory);
+  ~Extractor();
+
+  // Decompresses and extracts the next piece of the archive.
+  Try<Nothing> write(const char* data, size_t length);
+
+  // Checks that the whole archive was extracted.
+  Try<Nothing> close();
+
+private:
+  Try<Nothing> untar(const char* data, size_t length);
+
+  // Returns the path to extract an entry to, refusing any entry that
+  // would end up outside of the directory.
+  Try<std::string> resolve(const std::string& name);
+
+  Try<Nothing> header(const char* block);
+
+  // Consumes data of the current entry.
+  Try<Nothing> consume(const char* data, size_t length);
+
+  // Called once all data of the current entry was consumed.
+  Try<Nothing> finish();
+
+  gzip::Decompressor decompressor;
+
+  const std::string directory;
+
+  std::string block; // A partially received header block.
+
+  // The current entry.
+  uint64_t remaining; // Bytes of data left.
+  uint64_t padding; // Bytes of padding following the data.
+  char type;
+  mode_t mode;
+  time_t mtime;
+  std::string path;
+  int fd; // For regular files.
+
+  // Data of a GNU long name or pax header entry.
+  std::string extended;
+
+  // Name and link target for the next entry, from the extensions.
+  Option<std::string> longName;
+  Option<std::string> longLink;
+
+  int zeros; // Consecutive zero blocks.
+};
+
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __LAUNCHER_EXTRACTOR_HPP__
@@ -16,31 +16,105 @@
  * limitations under the License.
  */
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <curl/curl.h>
+
 #include <string>
+#include <vector>
 
 #include <mesos/mesos.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/net.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/strings.hpp>
 
+#include "common/lock.hpp"
+
 #include "hdfs/hdfs.hpp"
 
+#include "launcher/extractor.hpp"
+
 using namespace mesos;
 
+using mesos::internal::Extractor;
+using mesos::internal::Lock;
+
 using std::string;
+using std::vector;
+
+
+// Archives get extracted one at a time, even though the URIs get
+// fetched in parallel: the extractor checks that no entry ends up
+// under a symbolic link, which another archive being extracted into
+// the same directory could otherwise create right after the check.
+static pthread_mutex_t extractions = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Returns true if the file is an archive we can extract in-process.
+bool streamable(const string& filename)
+{
+  return strings::endsWith(filename, ".tgz") ||
+    strings::endsWith(filename, ".tar.gz");
+}
+
 
 // Try to extract filename into directory. If filename is recognized as an
 // archive it will be extracted and true returned; if not recognized then false
 // will be returned. An Error is returned if the extraction command fails.
 Try<bool> extract(const string& filename, const string& directory)
 {
+  if (streamable(filename)) {
+    Try<int> fd = os::open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd.isError()) {
+      return Error("Failed to open: " + fd.error());
+    }
+
+    Extractor extractor(directory);
+
+    char buffer[64 * 1024];
+    ssize_t length;
+    while ((length = ::read(fd.get(), buffer, sizeof(buffer))) != 0) {
+      if (length < 0 && errno == EINTR) {
+        continue;
+      } else if (length < 0) {
+        ErrnoError error("Failed to read");
+        os::close(fd.get());
+        return error;
+      }
+
+      Try<Nothing> extracted = extractor.write(buffer, length);
+      if (extracted.isError()) {
+        os::close(fd.get());
+        return Error("Failed to extract: " + extracted.error());
+      }
+    }
+
+    os::close(fd.get());
+
+    Try<Nothing> closed = extractor.close();
+    if (closed.isError()) {
+      return Error("Failed to extract: " + closed.error());
+    }
+
+    LOG(INFO) << "Extracted resource '" << filename
+              << "' into '" << directory << "'";
+
+    return true;
+  }
+
   string command;
-  // Extract any .tgz, tar.gz, tar.bz2 or zip files.
-  if (strings::endsWith(filename, ".tgz") ||
-      strings::endsWith(filename, ".tar.gz") ||
-      strings::endsWith(filename, ".tbz2") ||
+  // Extract any .tbz2, tar.bz2, .txz, .tar.xz or zip files.
+  if (strings::endsWith(filename, ".tbz2") ||
       strings::endsWith(filename, ".tar.bz2") ||
       strings::endsWith(filename, ".txz") ||
       strings::endsWith(filename, ".tar.xz")) {
@@ -65,23 +139,129 @@ Try<bool> extract(const string& filename, const string& directory)
 }
 
 
-// Fetch URI into directory.
-Try<string> fetch(
+struct Download
+{
+  CURL* curl;
+  FILE* file;
+  Extractor* extractor;
+  Option<string> error;
+};
+
+
+// libcurl callback that writes downloaded data to the file and, if
+// requested (and the download succeeds), into the extractor.
+static size_t downloaded(char* data, size_t size, size_t nmemb, void* userdata)
+{
+  Download* download = static_cast<Download*>(userdata);
+
+  size_t length = size * nmemb;
+
+  if (fwrite(data, 1, length, download->file) != length) {
+    download->error = "Failed to write: " + string(strerror(errno));
+    return 0; // Aborts the download.
+  }
+
+  if (download->extractor != NULL) {
+    long code;
+    curl_easy_getinfo(download->curl, CURLINFO_RESPONSE_CODE, &code);
+
+    // Don't try and extract error pages.
+    if (code == 200) {
+      Try<Nothing> extracted = download->extractor->write(data, length);
+      if (extracted.isError()) {
+        download->error = "Failed to extract: " + extracted.error();
+        return 0; // Aborts the download.
+      }
+    }
+  }
+
+  return length;
+}
+
+
+// Downloads the HTTP(S) or FTP(S) URI into directory, extracting it at
+// the same time if an extractor is given. Like 'net::download' but we
+// need to see the data as it arrives.
+Try<string> download(
     const string& uri,
-    const string& directory)
+    const string& directory,
+    Extractor* extractor)
 {
-  LOG(INFO) << "Fetching URI '" << uri << "'";
+  string path = uri.substr(uri.find("://") + 3);
+  if (path.find("/") == string::npos ||
+      path.size() <= path.find("/") + 1) {
+    LOG(ERROR) << "Malformed URL (missing path)";
+    return Error("Malformed URI");
+  }
 
-  // Some checks to make sure using the URI value in shell commands
-  // is safe. TODO(benh): These should be pushed into the scheduler
-  // driver and reported to the user.
-  if (uri.find_first_of('\\') != string::npos ||
-      uri.find_first_of('\'') != string::npos ||
-      uri.find_first_of('\0') != string::npos) {
-    LOG(ERROR) << "URI contains illegal characters, refusing to fetch";
-    return Error("Illegal characters in URI");
+  path =  path::join(directory, path.substr(path.find_last_of("/") + 1));
+  LOG(INFO) << "Downloading '" << uri << "' to '" << path << "'";
+
+  FILE* file = fopen(path.c_str(), "w");
+  if (file == NULL) {
+    return ErrnoError("Failed to open '" + path + "'");
+  }
+
+  CURL* curl = curl_easy_init();
+  if (curl == NULL) {
+    fclose(file);
+    return Error("Failed to initialize libcurl");
+  }
+
+  Download download;
+  download.curl = curl;
+  download.file = file;
+  download.extractor = extractor;
+
+  curl_easy_setopt(curl, CURLOPT_URL, uri.c_str());
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L); // We're multi-threaded.
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &downloaded);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download);
+
+  CURLcode curlErrorCode = curl_easy_perform(curl);
+
+  long code;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+  curl_easy_cleanup(curl);
+
+  if (fclose(file) != 0 && download.error.isNone()) {
+    download.error = "Failed to close '" + path + "': " + strerror(errno);
+  }
+
+  if (download.error.isSome()) {
+    LOG(ERROR) << "Error downloading resource: " << download.error.get();
+    return Error("Fetch of URI failed (" + download.error.get() + ")");
+  } else if (curlErrorCode != 0) {
+    LOG(ERROR) << "Error downloading resource: "
+               << curl_easy_strerror(curlErrorCode);
+    return Error("Fetch of URI failed (" +
+                 string(curl_easy_strerror(curlErrorCode)) + ")");
+  } else if (code != 200) {
+    LOG(ERROR) << "Error downloading resource, received HTTP/FTP return code "
+               << code;
+    return Error("HTTP/FTP error (" + stringify(code) + ")");
   }
 
+  if (extractor != NULL) {
+    Try<Nothing> closed = extractor->close();
+    if (closed.isError()) {
+      LOG(ERROR) << "Error extracting resource: " << closed.error();
+      return Error("Failed to extract (" + closed.error() + ")");
+    }
+
+    LOG(INFO) << "Extracted resource '" << path
+              << "' into '" << directory << "'";
+  }
+
+  return path;
+}
+
+
+// Fetch URI into directory.
+Try<string> fetch(
+    const string& uri,
+    const string& directory)
+{
   // Grab the resource from HDFS if its path begins with hdfs:// or
   // hftp:
   // TODO(matei): Enforce some size limits on files we get from HDFS
@@ -109,26 +289,7 @@ Try<string> fetch(
              strings::startsWith(uri, "https://") ||
              strings::startsWith(uri, "ftp://") ||
              strings::startsWith(uri, "ftps://")) {
-    string path = uri.substr(uri.find("://") + 3);
-    if (path.find("/") == string::npos ||
-        path.size() <= path.find("/") + 1) {
-      LOG(ERROR) << "Malformed URL (missing path)";
-      return Error("Malformed URI");
-    }
-
-    path =  path::join(directory, path.substr(path.find_last_of("/") + 1));
-    LOG(INFO) << "Downloading '" << uri << "' to '" << path << "'";
-    Try<int> code = net::download(uri, path);
-    if (code.isError()) {
-      LOG(ERROR) << "Error downloading resource: " << code.error().c_str();
-      return Error("Fetch of URI failed (" + code.error() + ")");
-    } else if (code.get() != 200) {
-      LOG(ERROR) << "Error downloading resource, received HTTP/FTP return code "
-                 << code.get();
-      return Error("HTTP/FTP error (" + stringify(code.get()) + ")");
-    }
-
-    return path;
+    return download(uri, directory, NULL);
   } else { // Copy the local resource.
     string local = uri;
     if (local.find_first_of("/") != 0) {
@@ -153,8 +314,9 @@ Try<string> fetch(
       return Error("Fetch of URI failed");
     }
 
-    // Copy the resource to the directory.
     string path = path::join(directory, base.get());
+
+    // Copy the resource to the directory.
     std::ostringstream command;
     command << "cp '" << local << "' '" << path << "'";
     LOG(INFO) << "Copying resource from '" << local
@@ -172,6 +334,105 @@ Try<string> fetch(
 }
 
 
+// Fetch URI into directory, then chmod it if it's executable, else
+// extract it if it's an archive.
+Try<Nothing> fetch(const CommandInfo::URI& uri, const string& directory)
+{
+  const string& value = uri.value();
+
+  LOG(INFO) << "Fetching URI '" << value << "'";
+
+  // Some checks to make sure using the URI value in shell commands
+  // is safe. TODO(benh): These should be pushed into the scheduler
+  // driver and reported to the user.
+  if (value.find_first_of('\\') != string::npos ||
+      value.find_first_of('\'') != string::npos ||
+      value.find_first_of('\0') != string::npos) {
+    LOG(ERROR) << "URI contains illegal characters, refusing to fetch";
+    return Error("Illegal characters in URI");
+  }
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // Extract gzipped tarballs while we download them.
+  if (!uri.executable() &&
+      streamable(value) &&
+      (strings::startsWith(value, "http://") ||
+       strings::startsWith(value, "https://"))) {
+    Lock lock(&extractions);
+
+    Extractor extractor(directory);
+    Try<string> downloaded = download(value, directory, &extractor);
+    if (downloaded.isError()) {
+      return Error(downloaded.error());
+    }
+
+    LOG(INFO) << "Fetched and extracted '" << value << "' in "
+              << stopwatch.elapsed();
+
+    return Nothing();
+  }
+
+  // Fetch the URI to a local file.
+  Try<string> fetched = fetch(value, directory);
+  if (fetched.isError()) {
+    return Error(fetched.error());
+  }
+
+  LOG(INFO) << "Fetched '" << value << "' in " << stopwatch.elapsed();
+
+  // Chmod the fetched URI if it's executable, else assume it's an archive
+  // that should be extracted.
+  if (uri.executable()) {
+    bool chmodded = os::chmod(
+        fetched.get(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+    if (!chmodded) {
+      return ErrnoError("Failed to chmod " + fetched.get());
+    }
+  } else {
+    Lock lock(&extractions);
+
+    Stopwatch extracting;
+    extracting.start();
+
+    //TODO(idownes): Consider removing the archive once extracted.
+    // Try to extract the file if it's recognized as an archive.
+    Try<bool> extracted = extract(fetched.get(), directory);
+    if (extracted.isError()) {
+      return Error("Failed to extract " +
+                   fetched.get() + ":" + extracted.error());
+    } else if (extracted.get()) {
+      LOG(INFO) << "Extracted '" << fetched.get() << "' in "
+                << extracting.elapsed();
+    }
+  }
+
+  return Nothing();
+}
+
+
+struct Fetch
+{
+  CommandInfo::URI uri;
+  string directory;
+  Option<string> error;
+};
+
+
+void* fetch(void* arg)
+{
+  Fetch* fetch_ = static_cast<Fetch*>(arg);
+
+  Try<Nothing> fetched = fetch(fetch_->uri, fetch_->directory);
+  if (fetched.isError()) {
+    fetch_->error = fetched.error();
+  }
+
+  return NULL;
+}
+
+
 int main(int argc, char* argv[])
 {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
@@ -203,38 +464,72 @@ int main(int argc, char* argv[])
     ? Option<std::string>(os::getenv("MESOS_USER")) // Explicit so it compiles.
     : None();
 
-  // Fetch each URI to a local file, chmod, then chown if a user is provided.
+  // Initialize libcurl before we start any threads, it's not safe to
+  // do so concurrently.
+  curl_global_init(CURL_GLOBAL_ALL);
+
+  vector<Fetch> fetches;
+
+  // URIs with the same basename get fetched to the same path, in which
+  // case we fetch them one after the other (the last one wins).
+  bool parallel = true;
+  hashset<string> basenames;
+
   foreach (const CommandInfo::URI& uri, commandInfo.uris()) {
-    // Fetch the URI to a local file.
-    Try<string> fetched = fetch(uri.value(), directory);
-    if (fetched.isError()) {
-      EXIT(1) << "Failed to fetch: " << uri.value();
-    }
-
-    // Chmod the fetched URI if it's executable, else assume it's an archive
-    // that should be extracted.
-    if (uri.executable()) {
-      bool chmodded = os::chmod(
-          fetched.get(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
-      if (!chmodded) {
-        EXIT(1) << "Failed to chmod: " << fetched.get();
-      }
+    Fetch fetch;
+    fetch.uri = uri;
+    fetch.directory = directory;
+    fetches.push_back(fetch);
+
+    Try<string> base = os::basename(uri.value());
+    if (base.isError() || basenames.contains(base.get())) {
+      parallel = false;
     } else {
-      //TODO(idownes): Consider removing the archive once extracted.
-      // Try to extract the file if it's recognized as an archive.
-      Try<bool> extracted = extract(fetched.get(), directory);
-      if (extracted.isError()) {
-        EXIT(1) << "Failed to extract "
-                << fetched.get() << ":" << extracted.error();
-      }
+      basenames.insert(base.get());
     }
+  }
 
-    // Recursively chown the directory if a user is provided.
-    if (user.isSome()) {
-      Try<Nothing> chowned = os::chown(user.get(), directory);
-      if (chowned.isError()) {
-        EXIT(1) << "Failed to chown " << directory << ": " << chowned.error();
-      }
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // Fetch the URIs concurrently so that one slow download doesn't hold
+  // up the rest. Fetching is I/O bound so a thread per URI is fine.
+  // NOTE: Archives still get extracted one at a time (see above).
+  vector<pthread_t> threads(fetches.size());
+  vector<bool> started(fetches.size(), false);
+
+  for (size_t i = 0; i < fetches.size(); i++) {
+    if (parallel) {
+      started[i] =
+        pthread_create(&threads[i], NULL, &fetch, &fetches[i]) == 0;
+    }
+
+    if (!started[i]) {
+      fetch(&fetches[i]);
+    }
+  }
+
+  for (size_t i = 0; i < fetches.size(); i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  foreach (const Fetch& fetch, fetches) {
+    if (fetch.error.isSome()) {
+      EXIT(1) << "Failed to fetch " << fetch.uri.value() << ": "
+              << fetch.error.get();
+    }
+  }
+
+  LOG(INFO) << "Fetched " << fetches.size() << " URI(s) in "
+            << stopwatch.elapsed();
+
+  // Recursively chown the directory if a user is provided.
+  if (user.isSome()) {
+    Try<Nothing> chowned = os::chown(user.get(), directory);
+    if (chowned.isError()) {
+      EXIT(1) << "Failed to chown " << directory << ": " << chowned.error();
     }
   }
 
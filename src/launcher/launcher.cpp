@@ -0,0 +1,157 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+
+#include <stout/exit.hpp>
+#include <stout/flags.hpp>
+#include <stout/option.hpp>
+#include <stout/os.hpp>
+
+using std::cerr;
+using std::endl;
+using std::string;
+
+
+// Executed by the launchers in place of the slave when it doesn't
+// fork (see --launcher_vfork): a child that shares the slave's memory
+// can't wait for the executor to be isolated nor set it up, since it
+// needs to exec right away, so it execs this instead. Like 'execute'
+// in the MesosContainerizer, this waits on the pipe until the parent
+// signals it to continue, sets up the executor's user, directory and
+// output and then executes the command. The executor's environment is
+// passed as the environment of this program.
+
+
+class Flags : public flags::FlagsBase
+{
+public:
+  Flags()
+  {
+    add(&command,
+        "command",
+        "The command to execute (via '/bin/sh -c')");
+
+    add(&directory,
+        "directory",
+        "The directory to execute the command in");
+
+    add(&user,
+        "user",
+        "The user to execute the command as");
+
+    add(&redirect_io,
+        "redirect_io",
+        "Whether to redirect the command's output to 'stdout' and\n"
+        "'stderr' in the directory",
+        false);
+
+    add(&pipe_read,
+        "pipe_read",
+        "The read end of the pipe to wait on before executing");
+
+    add(&pipe_write,
+        "pipe_write",
+        "The write end of the pipe, to be closed");
+  }
+
+  Option<string> command;
+  Option<string> directory;
+  Option<string> user;
+  bool redirect_io;
+  Option<int> pipe_read;
+  Option<int> pipe_write;
+};
+
+
+int main(int argc, char** argv)
+{
+  Flags flags;
+
+  Try<Nothing> load = flags.load(None(), argc, argv);
+
+  if (load.isError()) {
+    cerr << load.error() << endl << flags.usage();
+    return 1;
+  }
+
+  if (flags.command.isNone() || flags.directory.isNone()) {
+    cerr << "Missing --command or --directory" << endl << flags.usage();
+    return 1;
+  }
+
+  if (flags.pipe_write.isSome()) {
+    os::close(flags.pipe_write.get());
+  }
+
+  // Do a blocking read on the pipe until the parent signals us to
+  // continue.
+  if (flags.pipe_read.isSome()) {
+    int buf;
+    ssize_t len;
+    while ((len = read(flags.pipe_read.get(), &buf, sizeof(buf))) == -1 &&
+           errno == EINTR);
+
+    if (len != sizeof(buf)) {
+      EXIT(1) << "Failed to synchronize with parent";
+    }
+
+    os::close(flags.pipe_read.get());
+  }
+
+  // Chown the work directory if a user is provided.
+  if (flags.user.isSome()) {
+    Try<Nothing> chown = os::chown(flags.user.get(), flags.directory.get());
+    if (chown.isError()) {
+      EXIT(1) << "Failed to chown work directory: " << chown.error();
+    }
+  }
+
+  // Change user if provided.
+  if (flags.user.isSome() && !os::su(flags.user.get())) {
+    EXIT(1) << "Failed to change user to '" << flags.user.get() << "'";
+  }
+
+  // Enter working directory.
+  if (!os::chdir(flags.directory.get())) {
+    EXIT(1) << "Failed to chdir into work directory";
+  }
+
+  // Redirect output to files in working dir if required. We append
+  // because others (e.g., mesos-fetcher) may have already logged to
+  // the files.
+  if (flags.redirect_io) {
+    if (freopen("stdout", "a", stdout) == NULL) {
+      EXIT(1) << "Failed to redirect stdout";
+    }
+    if (freopen("stderr", "a", stderr) == NULL) {
+      EXIT(1) << "Failed to redirect stderr";
+    }
+  }
+
+  // Execute the command (via '/bin/sh -c command').
+  execl("/bin/sh", "sh", "-c", flags.command.get().c_str(), (char*) NULL);
+
+  EXIT(1) << "Failed to execute command";
+}
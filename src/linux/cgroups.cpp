@@ -18,9 +18,11 @@
 
 #include <errno.h>
 #include <fts.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <sys/syscall.h>
@@ -39,6 +41,7 @@
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/delay.hpp>
+#include <process/dispatch.hpp>
 #include <process/io.hpp>
 #include <process/process.hpp>
 
@@ -54,6 +57,9 @@
 #include <stout/proc.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
+#include <stout/uuid.hpp>
+
+#include "common/lock.hpp"
 
 #include "linux/cgroups.hpp"
 #include "linux/fs.hpp"
@@ -1336,6 +1342,80 @@ private:
   uint64_t data; // The data read from the eventfd.
 };
 
+
+// The process behind 'Listener', reading the eventfd of a registered
+// notifier once for every 'listen'. Reading the eventfd returns (and
+// resets) its counter, i.e., the number of events since the last read.
+class ListenerProcess : public Process<ListenerProcess>
+{
+public:
+  explicit ListenerProcess(int _eventfd)
+    : eventfd(_eventfd),
+      promise(NULL),
+      data(0) {}
+
+  virtual ~ListenerProcess() {}
+
+  Future<uint64_t> listen()
+  {
+    if (promise != NULL) {
+      return Failure("Already listening");
+    }
+
+    promise = new Promise<uint64_t>();
+    Future<uint64_t> future = promise->future();
+
+    reading = io::read(eventfd, &data, sizeof(data));
+    reading.onAny(defer(self(), &ListenerProcess::notified));
+
+    return future;
+  }
+
+protected:
+  virtual void finalize()
+  {
+    // Discard the nonblocking read.
+    reading.discard();
+
+    Try<Nothing> unregister = unregisterNotifier(eventfd);
+    if (unregister.isError()) {
+      LOG(ERROR) << "Failed to unregister eventfd: " << unregister.error();
+    }
+
+    if (promise != NULL) {
+      promise->discard();
+      delete promise;
+      promise = NULL;
+    }
+  }
+
+private:
+  void notified()
+  {
+    if (promise == NULL) {
+      return; // Already discarded in 'finalize'.
+    }
+
+    if (reading.isDiscarded()) {
+      promise->discard();
+    } else if (reading.isFailed()) {
+      promise->fail("Failed to read eventfd: " + reading.failure());
+    } else if (reading.get() == sizeof(data)) {
+      promise->set(data);
+    } else {
+      promise->fail("Read less than expected");
+    }
+
+    delete promise;
+    promise = NULL;
+  }
+
+  const int eventfd;
+  Promise<uint64_t>* promise; // Of the pending 'listen', if any.
+  Future<size_t> reading;
+  uint64_t data; // The data read from the eventfd.
+};
+
 } // namespace internal {
 
 
@@ -1358,6 +1438,50 @@ Future<uint64_t> listen(
 }
 
 
+Try<Listener*> Listener::create(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control,
+    const Option<string>& args)
+{
+  Option<Error> error = verify(hierarchy, cgroup, control);
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  Try<int> eventfd =
+    internal::registerNotifier(hierarchy, cgroup, control, args);
+
+  if (eventfd.isError()) {
+    return Error(
+        "Failed to register notification eventfd: " + eventfd.error());
+  }
+
+  return new Listener(eventfd.get());
+}
+
+
+Listener::Listener(int eventfd)
+{
+  process = new internal::ListenerProcess(eventfd);
+  spawn(process);
+}
+
+
+Listener::~Listener()
+{
+  terminate(process);
+  process::wait(process);
+  delete process;
+}
+
+
+Future<uint64_t> Listener::listen()
+{
+  return dispatch(process, &internal::ListenerProcess::listen);
+}
+
+
 namespace internal {
 
 
@@ -1695,7 +1819,44 @@ private:
 };
 
 
+#ifndef SYS_pidfd_send_signal
+#define SYS_pidfd_send_signal 424 // Same on all architectures.
+#endif
+
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434 // Same on all architectures.
+#endif
+
+
+// Returns a file descriptor that becomes readable once the process
+// terminates (a 'pidfd', Linux 5.3 and later), or -1 with errno set.
+static int pidfd(pid_t pid)
+{
+  return ::syscall(SYS_pidfd_open, pid, 0);
+}
+
+
+// Sends the signal to the process of the pidfd. Unlike kill(2) this
+// can't signal another process that reused the pid.
+static int pidfdSignal(int fd, int signal)
+{
+  return ::syscall(SYS_pidfd_send_signal, fd, signal, NULL, 0);
+}
+
+
+// Gives up waiting for the tasks to terminate. NOTE: The polls are
+// deliberately not discarded, see 'TasksKiller::killAll'.
+static Future<list<short> > timedout(const Future<list<short> >& polls)
+{
+  return Failure("Timed out");
+}
+
+
 // The process used to atomically kill all tasks in a cgroup.
+// Where pidfds are supported all tasks get killed in a single pass
+// and their termination is waited for through their pidfds, falling
+// back to the (polling) freeze/kill/thaw chain below otherwise, or if
+// the tasks don't terminate in time (e.g., they're frozen).
 class TasksKiller : public Process<TasksKiller>
 {
 public:
@@ -1720,7 +1881,7 @@ protected:
 
     CHECK(interval >= Seconds(0));
 
-    killTasks();
+    killAll();
   }
 
   virtual void finalize()
@@ -1736,6 +1897,111 @@ protected:
   }
 
 private:
+  // Sends SIGKILL to all tasks in one pass and waits for all of them
+  // to terminate. Tasks forked before their parent got killed are
+  // caught by checking the cgroup again once they've terminated.
+  void killAll(unsigned int attempt = 0)
+  {
+    Try<set<pid_t> > pids = processes(hierarchy, cgroup);
+    if (pids.isError()) {
+      promise.fail("Failed to get processes of cgroup: " + pids.error());
+      terminate(self());
+      return;
+    }
+
+    if (pids.get().empty()) {
+      promise.set(true);
+      terminate(self());
+      return;
+    }
+
+    if (attempt > EMPTY_WATCHER_RETRIES) {
+      killTasks();
+      return;
+    }
+
+    // Open the pidfds before killing any of the tasks, so that they
+    // can't refer to other processes (with reused pids) and so that we
+    // can still fall back if pidfds aren't supported.
+    list<int> fds;
+    foreach (pid_t pid, pids.get()) {
+      int fd = pidfd(pid);
+      if (fd < 0) {
+        if (errno == ESRCH) {
+          continue; // Already terminated.
+        }
+
+        VLOG(1) << "Falling back to polling to kill tasks in cgroup "
+                << path::join(hierarchy, cgroup) << ": pidfd_open failed: "
+                << strerror(errno);
+
+        foreach (int fd, fds) {
+          os::close(fd);
+        }
+
+        killTasks();
+        return;
+      }
+
+      fds.push_back(fd);
+    }
+
+    // Frozen tasks don't terminate until they're thawed (thawing
+    // takes effect immediately). Otherwise we time out and fall back.
+    internal::write(hierarchy, cgroup, "freezer.state", "THAWED");
+
+    list<Future<short> > futures;
+    while (!fds.empty()) {
+      int fd = fds.front();
+
+      // NOTE: A process that already terminated (ESRCH) still has its
+      // pidfd polled, which completes right away.
+      if (pidfdSignal(fd, SIGKILL) == -1 && errno != ESRCH) {
+        const string error = strerror(errno);
+
+        foreach (int fd, fds) {
+          os::close(fd);
+        }
+
+        promise.fail("Failed to send " + string(strsignal(SIGKILL)) +
+                     " to tasks of cgroup: " + error);
+        terminate(self());
+        return;
+      }
+
+      fds.pop_front();
+
+      // A pidfd is closed once its poll completes, i.e., once the
+      // task terminated, and never while it's still being polled.
+      // Hence the polls don't get discarded, even if we give up on
+      // them (or get terminated); they complete once the tasks get
+      // killed by the fallback.
+      Future<short> poll = io::poll(fd, io::READ);
+      poll.onAny(lambda::bind(&os::close, fd));
+      futures.push_back(poll);
+    }
+
+    // Give up on the tasks terminating in time (e.g., because they're
+    // frozen again) after a while.
+    polls = collect(futures)
+      .after(interval * EMPTY_WATCHER_RETRIES,
+             lambda::bind(&timedout, lambda::_1));
+
+    polls.onAny(defer(self(), &Self::killed, attempt));
+  }
+
+  void killed(unsigned int attempt)
+  {
+    if (polls.isReady()) {
+      killAll(attempt + 1);
+    } else {
+      LOG(WARNING) << "Falling back to polling to kill tasks in cgroup "
+                   << path::join(hierarchy, cgroup) << ": "
+                   << (polls.isFailed() ? polls.failure() : "discarded");
+      killTasks();
+    }
+  }
+
   // The sequence of operations to kill a cgroup is as follows:
   // SIGSTOP -> SIGKILL -> empty -> freeze -> SIGKILL -> thaw -> empty
   // This process is repeated until the cgroup becomes empty.
@@ -1805,6 +2071,9 @@ private:
   const Duration interval;
   Promise<bool> promise;
   Future<bool> chain; // Used to discard the "chain" of operations.
+
+  // The polls on the pidfds of the killed tasks.
+  Future<list<short> > polls;
 };
 
 
@@ -1996,20 +2265,16 @@ Future<bool> _cleanup(const string& hierarchy)
 }
 
 
-Try<hashmap<string, uint64_t> > stat(
-    const string& hierarchy,
-    const string& cgroup,
-    const string& file)
-{
-  Try<std::string> contents = cgroups::read(hierarchy, cgroup, file);
-
-  if (contents.isError()) {
-    return Error(contents.error());
-  }
+namespace internal {
 
+// Parses the contents of a stat file, see 'cgroups::stat'.
+static Try<hashmap<string, uint64_t> > stat(
+    const string& file,
+    const string& contents)
+{
   hashmap<string, uint64_t> result;
 
-  foreach (const string& line, strings::split(contents.get(), "\n")) {
+  foreach (const string& line, strings::split(contents, "\n")) {
     // Skip empty lines.
     if (strings::trim(line).empty()) {
       continue;
@@ -2033,6 +2298,374 @@ Try<hashmap<string, uint64_t> > stat(
 }
 
 
+// Parses the values of the given keys out of the contents of a stat
+// file (i.e., "<key> <value>" lines) in place. Keys that aren't in the
+// file are left None.
+static Try<Nothing> stat(
+    const string& file,
+    const char* data,
+    size_t size,
+    size_t count,
+    const char* const keys[],
+    Option<uint64_t>* const values[])
+{
+  for (size_t i = 0; i < count; i++) {
+    *values[i] = None();
+  }
+
+  const char* end = data + size;
+  const char* line = data;
+
+  while (line < end) {
+    const char* eol = (const char*) ::memchr(line, '\n', end - line);
+    if (eol == NULL) {
+      eol = end;
+    }
+
+    if (eol > line) {
+      const char* space = (const char*) ::memchr(line, ' ', eol - line);
+      if (space == NULL || space + 1 == eol) {
+        return Error("Unexpected line format in " + file + ": " +
+                     string(line, eol - line));
+      }
+
+      const size_t length = space - line;
+      for (size_t i = 0; i < count; i++) {
+        if (::strlen(keys[i]) != length ||
+            ::memcmp(keys[i], line, length) != 0) {
+          continue;
+        }
+
+        uint64_t value = 0;
+        for (const char* digit = space + 1; digit < eol; digit++) {
+          if (*digit < '0' || *digit > '9') {
+            return Error("Unexpected line format in " + file + ": " +
+                         string(line, eol - line));
+          }
+          value = value * 10 + (*digit - '0');
+        }
+
+        *values[i] = value;
+        break;
+      }
+    }
+
+    line = eol + 1;
+  }
+
+  return Nothing();
+}
+
+} // namespace internal {
+
+
+Try<hashmap<string, uint64_t> > stat(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& file)
+{
+  Try<std::string> contents = cgroups::read(hierarchy, cgroup, file);
+
+  if (contents.isError()) {
+    return Error(contents.error());
+  }
+
+  return internal::stat(file, contents.get());
+}
+
+
+Try<Reader*> Reader::create(
+    const string& hierarchy,
+    const string& cgroup,
+    const string& control)
+{
+  Option<Error> error = verify(hierarchy, cgroup, control);
+  if (error.isSome()) {
+    return error.get();
+  }
+
+  const string& path = path::join(hierarchy, cgroup, control);
+
+  Try<int> fd = os::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd.isError()) {
+    return Error("Failed to open " + path + ": " + fd.error());
+  }
+
+  return new Reader(path, control, fd.get());
+}
+
+
+Reader::Reader(const string& _path, const string& _control, int _fd)
+  : path(_path), control(_control), fd(_fd), buffer(4096) {}
+
+
+Reader::~Reader()
+{
+  os::close(fd);
+}
+
+
+Try<string> Reader::read()
+{
+  Try<size_t> size = _read();
+  if (size.isError()) {
+    return Error(size.error());
+  }
+
+  return string(&buffer[0], size.get());
+}
+
+
+Try<hashmap<string, uint64_t> > Reader::stat()
+{
+  Try<size_t> size = _read();
+  if (size.isError()) {
+    return Error(size.error());
+  }
+
+  return internal::stat(control, string(&buffer[0], size.get()));
+}
+
+
+Try<Nothing> Reader::stat(
+    size_t count,
+    const char* const keys[],
+    Option<uint64_t>* const values[])
+{
+  Try<size_t> size = _read();
+  if (size.isError()) {
+    return Error(size.error());
+  }
+
+  return internal::stat(control, &buffer[0], size.get(), count, keys, values);
+}
+
+
+Try<uint64_t> Reader::value()
+{
+  Try<size_t> size = _read();
+  if (size.isError()) {
+    return Error(size.error());
+  }
+
+  uint64_t value = 0;
+  size_t i = 0;
+  for (; i < size.get() && buffer[i] >= '0' && buffer[i] <= '9'; i++) {
+    value = value * 10 + (buffer[i] - '0');
+  }
+
+  // Expecting (only) a number and a newline.
+  if (i == 0 || (i < size.get() && buffer[i] != '\n')) {
+    return Error("Failed to parse " + path + ": " +
+                 string(&buffer[0], size.get()));
+  }
+
+  return value;
+}
+
+
+Try<size_t> Reader::_read()
+{
+  // NOTE: Control files are generated when read from the start (we
+  // can't 'lseek' them, see 'internal::read'), so we 'pread' from
+  // offset 0 until the whole file fits in the buffer.
+  while (true) {
+    size_t size = 0;
+    while (size < buffer.size()) {
+      ssize_t length =
+        ::pread(fd, &buffer[size], buffer.size() - size, size);
+
+      if (length < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return ErrnoError("Failed to read " + path);
+      } else if (length == 0) {
+        return size;
+      }
+
+      size += length;
+    }
+
+    buffer.resize(buffer.size() * 2);
+  }
+}
+
+
+namespace internal {
+
+// The process used to fill a cgroup pool. The pooled cgroups are
+// guarded by a mutex so that they can be taken without waiting for
+// the process, e.g., while it's creating a cgroup.
+class PoolProcess : public Process<PoolProcess>
+{
+public:
+  PoolProcess(const string& _hierarchy,
+              const string& _root,
+              size_t _capacity)
+    : hierarchy(_hierarchy),
+      root(_root),
+      capacity(_capacity)
+  {
+    pthread_mutex_init(&mutex, NULL);
+  }
+
+  virtual ~PoolProcess()
+  {
+    pthread_mutex_destroy(&mutex);
+  }
+
+  // Creates cgroups until the pool is full.
+  void fill()
+  {
+    while (true) {
+      const string& cgroup =
+        path::join(root, "pool_" + UUID::random().toString());
+
+      mesos::internal::Lock lock(&mutex);
+
+      if (cgroups.size() >= capacity) {
+        return;
+      }
+
+      // Reserve the cgroup before it gets created, see 'contains'.
+      cgroups.insert(cgroup);
+
+      lock.unlock();
+
+      Try<Nothing> create = internal::create(hierarchy, cgroup);
+
+      lock.lock();
+
+      if (create.isError()) {
+        LOG(WARNING) << "Failed to create pooled cgroup '"
+                     << path::join(hierarchy, cgroup) << "': "
+                     << create.error();
+        cgroups.erase(cgroup);
+        return;
+      }
+
+      pooled.push_back(cgroup);
+    }
+  }
+
+  // Returns a pooled cgroup (if any), which is still reserved until
+  // it gets released.
+  Option<string> take()
+  {
+    mesos::internal::Lock lock(&mutex);
+
+    if (pooled.empty()) {
+      return None();
+    }
+
+    const string cgroup = pooled.front();
+    pooled.pop_front();
+    return cgroup;
+  }
+
+  void release(const string& cgroup)
+  {
+    mesos::internal::Lock lock(&mutex);
+    cgroups.erase(cgroup);
+  }
+
+  bool contains(const string& cgroup)
+  {
+    mesos::internal::Lock lock(&mutex);
+    return cgroups.contains(cgroup);
+  }
+
+protected:
+  virtual void finalize()
+  {
+    mesos::internal::Lock lock(&mutex);
+
+    foreach (const string& cgroup, pooled) {
+      Try<Nothing> remove = internal::remove(hierarchy, cgroup);
+      if (remove.isError()) {
+        LOG(WARNING) << "Failed to remove pooled cgroup '"
+                     << path::join(hierarchy, cgroup) << "': "
+                     << remove.error();
+      }
+    }
+
+    pooled.clear();
+  }
+
+private:
+  const string hierarchy;
+  const string root;
+  const size_t capacity;
+
+  pthread_mutex_t mutex;
+
+  // The cgroups of the pool, including the ones being created (or
+  // renamed), and the ones that can be taken.
+  hashset<string> cgroups;
+  std::list<string> pooled;
+};
+
+} // namespace internal {
+
+
+Pool::Pool(const string& _hierarchy, const string& _root, size_t capacity)
+  : hierarchy(_hierarchy),
+    root(_root)
+{
+  process = new internal::PoolProcess(hierarchy, root, capacity);
+  spawn(process);
+  dispatch(process, &internal::PoolProcess::fill);
+}
+
+
+Pool::~Pool()
+{
+  terminate(process);
+  process::wait(process);
+  delete process;
+}
+
+
+Try<Nothing> Pool::create(const string& cgroup)
+{
+  Try<string> basename = os::basename(cgroup);
+  if (basename.isError() || path::join(root, basename.get()) != cgroup) {
+    return cgroups::create(hierarchy, cgroup);
+  }
+
+  Option<string> pooled = process->take();
+  if (pooled.isNone()) {
+    return cgroups::create(hierarchy, cgroup);
+  }
+
+  const string& from = path::join(hierarchy, pooled.get());
+  const string& to = path::join(hierarchy, cgroup);
+
+  if (::rename(from.c_str(), to.c_str()) < 0) {
+    // Don't leave the pooled cgroup behind (if it's still there).
+    LOG(WARNING) << "Failed to rename pooled cgroup '" << from << "' to '"
+                 << to << "': " << strerror(errno);
+    internal::remove(hierarchy, pooled.get());
+    process->release(pooled.get());
+    dispatch(process, &internal::PoolProcess::fill);
+    return cgroups::create(hierarchy, cgroup);
+  }
+
+  // Replace the cgroup now that it's no longer part of the pool.
+  process->release(pooled.get());
+  dispatch(process, &internal::PoolProcess::fill);
+
+  return Nothing();
+}
+
+
+bool Pool::contains(const string& cgroup)
+{
+  return process->contains(cgroup);
+}
+
+
 namespace cpu {
 
 Try<Nothing> shares(
@@ -2087,9 +2720,47 @@ Try<Nothing> cfs_quota_us(
       stringify(static_cast<int64_t>(duration.us())));
 }
 
+
+Try<Stat> stat(Reader* reader)
+{
+  static const char* const keys[] =
+    { "nr_periods", "nr_throttled", "throttled_time" };
+
+  Stat stat;
+  Option<uint64_t>* const values[] =
+    { &stat.nr_periods, &stat.nr_throttled, &stat.throttled_time };
+
+  Try<Nothing> read = reader->stat(3, keys, values);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  return stat;
+}
+
 } // namespace cpu {
 
 
+namespace cpuacct {
+
+Try<Stat> stat(Reader* reader)
+{
+  static const char* const keys[] = { "user", "system" };
+
+  Stat stat;
+  Option<uint64_t>* const values[] = { &stat.user, &stat.system };
+
+  Try<Nothing> read = reader->stat(2, keys, values);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  return stat;
+}
+
+} // namespace cpuacct {
+
+
 namespace memory {
 
 Try<Bytes> limit_in_bytes(const string& hierarchy, const string& cgroup)
@@ -2166,6 +2837,24 @@ Try<Bytes> max_usage_in_bytes(const string& hierarchy, const string& cgroup)
   return Bytes::parse(strings::trim(read.get()) + "B");
 }
 
+
+Try<Stat> stat(Reader* reader)
+{
+  static const char* const keys[] =
+    { "total_cache", "total_rss", "total_mapped_file" };
+
+  Stat stat;
+  Option<uint64_t>* const values[] =
+    { &stat.total_cache, &stat.total_rss, &stat.total_mapped_file };
+
+  Try<Nothing> read = reader->stat(3, keys, values);
+  if (read.isError()) {
+    return Error(read.error());
+  }
+
+  return stat;
+}
+
 } // namespace memory {
 
 } // namespace cgroups {
@@ -337,6 +337,41 @@ process::Future<uint64_t> listen(
     const Option<std::string>& args = Option<std::string>::none());
 
 
+// Forward declaration.
+namespace internal {
+class ListenerProcess;
+} // namespace internal {
+
+
+// Listens on an event notifier like 'listen' above, but keeps the
+// notifier registered between events: the events that happen while
+// nobody is listening are counted towards the next 'listen' rather
+// than lost.
+class Listener
+{
+public:
+  // Registers the notifier, see 'listen' above for the parameters.
+  static Try<Listener*> create(
+      const std::string& hierarchy,
+      const std::string& cgroup,
+      const std::string& control,
+      const Option<std::string>& args = Option<std::string>::none());
+
+  // Unregisters the notifier, discarding a pending 'listen'.
+  ~Listener();
+
+  // Returns a future which becomes ready with the number of events
+  // since the previous one became ready (or since the notifier was
+  // registered). Only one 'listen' may be pending at a time.
+  process::Future<uint64_t> listen();
+
+private:
+  explicit Listener(int eventfd);
+
+  internal::ListenerProcess* process;
+};
+
+
 // Freeze all the processes in a given cgroup. We try to use the freezer
 // subsystem implemented in cgroups. More detail can be found in
 // <kernel-source>/Documentation/cgroups/freezer-subsystem.txt. This function
@@ -388,6 +423,11 @@ process::Future<bool> thaw(
 // of the cgroups.
 // NOTE: If cgroup is "/" (default), all cgroups under the
 // hierarchy are destroyed.
+// NOTE: Where pidfds are supported (Linux 5.3 and later) the tasks
+// get killed in a single pass and their termination gets noticed
+// without polling. The freezer is only polled as a fallback, e.g.,
+// if the tasks haven't terminated after 'interval' times
+// EMPTY_WATCHER_RETRIES.
 // TODO(vinod): Add support for killing tasks when freezer subsystem
 // is not present.
 // @param   hierarchy Path to the hierarchy root.
@@ -424,6 +464,95 @@ Try<hashmap<std::string, uint64_t> > stat(
     const std::string& file);
 
 
+// Reads a control file of a cgroup repeatedly, e.g., to sample the
+// statistics of the cgroup periodically. Unlike 'read' and 'stat'
+// the control file is only verified and opened once, and the buffer
+// it gets read into is reused.
+class Reader
+{
+public:
+  // Returns a reader of the control file, which is kept open until
+  // the reader gets deleted.
+  static Try<Reader*> create(
+      const std::string& hierarchy,
+      const std::string& cgroup,
+      const std::string& control);
+
+  ~Reader();
+
+  // Returns the current contents of the control file.
+  Try<std::string> read();
+
+  // Returns the current stat information of the control file, see
+  // 'stat' above.
+  Try<hashmap<std::string, uint64_t> > stat();
+
+  // Reads the current values of the given keys of the (stat) control
+  // file into 'values', without building a hashmap. The values of keys
+  // that aren't in the control file are set to None.
+  Try<Nothing> stat(
+      size_t count,
+      const char* const keys[],
+      Option<uint64_t>* const values[]);
+
+  // Returns the current value of a control file holding a single
+  // number (e.g., memory.usage_in_bytes), without allocating.
+  Try<uint64_t> value();
+
+private:
+  Reader(const std::string& path, const std::string& control, int fd);
+
+  // Reads the control file into 'buffer', returns its size.
+  Try<size_t> _read();
+
+  const std::string path;
+  const std::string control;
+  const int fd;
+  std::vector<char> buffer;
+};
+
+
+// Forward declaration.
+namespace internal {
+class PoolProcess;
+} // namespace internal {
+
+
+// A pool of empty cgroups, created in the background as children of
+// 'root', so that creating a cgroup under 'root' (e.g., for a
+// container) only takes renaming a pooled cgroup rather than having
+// the kernel create one. The pool gets refilled in the background
+// whenever a cgroup is taken from it.
+// NOTE: Cgroups can only be renamed within their parent, hence the
+// pooled cgroups are siblings of the cgroups they become. Pooled
+// cgroups left behind by a previous pool aren't reused, they're
+// orphans like any other cgroup.
+class Pool
+{
+public:
+  // A pool with no capacity just creates the cgroups.
+  Pool(const std::string& hierarchy,
+       const std::string& root,
+       size_t capacity);
+
+  // Removes the (remaining) pooled cgroups.
+  ~Pool();
+
+  // Creates 'cgroup' by renaming a pooled cgroup if it's a child of
+  // 'root' and the pool isn't empty, or from scratch otherwise.
+  Try<Nothing> create(const std::string& cgroup);
+
+  // Returns true if 'cgroup' is a pooled cgroup (or is being created
+  // for the pool), e.g., so it doesn't get destroyed as an orphan.
+  bool contains(const std::string& cgroup);
+
+private:
+  const std::string hierarchy;
+  const std::string root;
+  internal::PoolProcess* process;
+};
+
+
 // Cpu controls.
 namespace cpu {
 
@@ -453,9 +582,39 @@ Try<Nothing> cfs_quota_us(
     const std::string& cgroup,
     const Duration& duration);
 
+
+// The statistics in cpu.stat, None if missing (e.g., on older kernels).
+struct Stat
+{
+  Option<uint64_t> nr_periods;
+  Option<uint64_t> nr_throttled;
+  Option<uint64_t> throttled_time; // In nanoseconds.
+};
+
+
+// Returns the statistics in cpu.stat, using a reader of it.
+Try<Stat> stat(Reader* reader);
+
 } // namespace cpu {
 
 
+// Cpu accounting controls.
+namespace cpuacct {
+
+// The statistics in cpuacct.stat, None if missing.
+struct Stat
+{
+  Option<uint64_t> user; // In clock ticks (i.e., USER_HZ).
+  Option<uint64_t> system; // In clock ticks (i.e., USER_HZ).
+};
+
+
+// Returns the statistics in cpuacct.stat, using a reader of it.
+Try<Stat> stat(Reader* reader);
+
+} // namespace cpuacct {
+
+
 // Memory controls.
 namespace memory {
 
@@ -496,6 +655,20 @@ Try<Bytes> max_usage_in_bytes(
     const std::string& hierarchy,
     const std::string& cgroup);
 
+
+// The statistics in memory.stat (of the cgroup and its descendants),
+// None if missing.
+struct Stat
+{
+  Option<uint64_t> total_cache;
+  Option<uint64_t> total_rss;
+  Option<uint64_t> total_mapped_file;
+};
+
+
+// Returns the statistics in memory.stat, using a reader of it.
+Try<Stat> stat(Reader* reader);
+
 } // namespace memory {
 
 } // namespace cgroups {
@@ -18,13 +18,17 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <list>
+#include <set>
 
 #include <process/collect.hpp>
 #include <process/id.hpp>
 #include <process/process.hpp>
 #include <process/timer.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/stringify.hpp>
 
@@ -36,6 +40,7 @@
 using namespace process;
 
 using std::list;
+using std::set;
 
 namespace mesos {
 namespace internal {
@@ -167,10 +172,16 @@ static Future<uint64_t> catchup(
 }
 
 
-// TODO(jieyu): Our current implementation catches-up each position in
-// the set sequentially. In the future, we may want to parallelize it
-// to improve the performance. Also, we may want to implement rate
-// control here so that we don't saturate the network or disk.
+// Catches-up an interval of log positions in the local replica. The
+// interval is processed in chunks of 'batch' positions (or as a whole
+// if 'batch' is 0). For each chunk, we first try to fetch all of its
+// learned actions from a single peer in one round trip, which is much
+// cheaper than running Paxos for each position when the local replica
+// is lagging far behind. The positions that are still missing after
+// that (e.g., the peer has not learned them either) are caught-up
+// through Paxos, with up to 'concurrency' positions in flight.
+// TODO(jieyu): We may want to implement rate control here so that we
+// don't saturate the network or disk.
 class BulkCatchUpProcess : public Process<BulkCatchUpProcess>
 {
 public:
@@ -180,13 +191,17 @@ public:
       const Shared<Network>& _network,
       uint64_t _proposal,
       const Interval<uint64_t>& _positions,
-      const Duration& _timeout)
+      const Duration& _timeout,
+      size_t _concurrency,
+      size_t _batch)
     : ProcessBase(ID::generate("log-bulk-catch-up")),
       quorum(_quorum),
       replica(_replica),
       network(_network),
       positions(_positions),
       timeout(_timeout),
+      concurrency(std::max(_concurrency, (size_t) 1)),
+      batch(_batch),
       proposal(_proposal) {}
 
   virtual ~BulkCatchUpProcess() {}
@@ -200,30 +215,37 @@ protected:
     promise.future().onDiscard(lambda::bind(
         static_cast<void(*)(const UPID&, bool)>(terminate), self(), true));
 
-    // Catch-up sequentially.
-    current = positions.lower();
+    lower = positions.lower();
 
-    catchup();
+    next();
   }
 
   virtual void finalize()
   {
-    catching.discard();
+    fetching.discard();
+    learning.discard();
+    checking.discard();
+
+    foreachvalue (Future<uint64_t> future, catching) {
+      future.discard();
+    }
 
-    // TODO(benh): Discard our promise only after 'catching' has
-    // completed (ready, failed, or discarded).
+    // TODO(benh): Discard our promise only after all the futures
+    // above have completed (ready, failed, or discarded).
     promise.discard();
   }
 
 private:
-  static void timedout(Future<uint64_t> catching)
+  template <typename T>
+  static void timedout(Future<T> future)
   {
-    catching.discard();
+    future.discard();
   }
 
-  void catchup()
+  // Moves on to the next chunk of positions [lower, upper).
+  void next()
   {
-    if (current >= positions.upper()) {
+    if (lower >= positions.upper()) {
       // Stop the process if there is nothing left to catch-up. This
       // also handles the case where the input interval is empty.
       promise.set(Nothing());
@@ -231,46 +253,160 @@ private:
       return;
     }
 
-    // Store the future so that we can discard it if the user wants to
-    // cancel the catch-up operation.
-    catching = log::catchup(quorum, replica, network, proposal, current)
-      .onDiscarded(defer(self(), &Self::discarded))
-      .onFailed(defer(self(), &Self::failed))
-      .onReady(defer(self(), &Self::succeeded));
+    upper = positions.upper();
+    if (batch > 0 && upper - lower > batch) {
+      upper = lower + batch;
+    }
+
+    if (batch > 0) {
+      fetch();
+    } else {
+      check();
+    }
+  }
+
+  void fetch()
+  {
+    CatchUpRequest request;
+    request.set_from(lower);
+    request.set_to(upper - 1);
+
+    // Do not ask the local replica.
+    set<UPID> filter;
+    filter.insert(replica->pid());
+
+    fetching = network->unicast(protocol::catchup, request, filter);
+    fetching.onAny(defer(self(), &Self::fetched));
+
+    Timer::create(
+        timeout,
+        lambda::bind(&Self::timedout<CatchUpResponse>, fetching));
+  }
+
+  void fetched()
+  {
+    if (!fetching.isReady()) {
+      // This is not fatal, we simply fall back to Paxos for the
+      // positions in this chunk.
+      LOG(INFO) << "Unable to fetch learned positions "
+                << lower << " -> " << upper - 1 << ": "
+                << (fetching.isFailed() ? fetching.failure() : "discarded");
+
+      check();
+      return;
+    }
+
+    list<Action> actions;
+    foreach (const Action& action, fetching.get().actions()) {
+      // Be defensive about what the peer sends back.
+      if (action.has_learned() && action.learned() &&
+          action.position() >= lower && action.position() < upper) {
+        actions.push_back(action);
+      }
+    }
+
+    VLOG(2) << "Fetched " << actions.size() << " learned positions in "
+            << lower << " -> " << upper - 1;
+
+    learning = replica->learn(actions);
+    learning.onAny(defer(self(), &Self::learned));
+  }
+
+  void learned()
+  {
+    // The future 'learning' can only be discarded in 'finalize'.
+    CHECK(!learning.isDiscarded());
+
+    if (learning.isFailed()) {
+      promise.fail("Failed to learn fetched positions: " + learning.failure());
+      terminate(self());
+    } else if (!learning.get()) {
+      promise.fail("Failed to learn fetched positions");
+      terminate(self());
+    } else {
+      check();
+    }
+  }
 
-    Timer::create(timeout, lambda::bind(&Self::timedout, catching));
+  void check()
+  {
+    checking = replica->missing(lower, upper - 1);
+    checking.onAny(defer(self(), &Self::checked));
   }
 
+  void checked()
+  {
+    // The future 'checking' can only be discarded in 'finalize'.
+    CHECK(!checking.isDiscarded());
 
-  void discarded()
+    if (checking.isFailed()) {
+      promise.fail("Failed to get missing positions: " + checking.failure());
+      terminate(self());
+    } else {
+      missing = checking.get();
+      catchup();
+    }
+  }
+
+  // Starts catching-up missing positions through Paxos until there
+  // are 'concurrency' positions in flight. Moves on to the next chunk
+  // once all the missing positions in this chunk are caught-up.
+  void catchup()
   {
-    LOG(INFO) << "Unable to catch-up position " << current
-              << " in " << timeout << ", retrying";
+    while (catching.size() < concurrency && !missing.empty()) {
+      const uint64_t position = missing.begin()->lower();
+      missing -= position;
+      catchup(position);
+    }
 
-    catchup();
+    if (catching.empty()) {
+      lower = upper;
+      next();
+    }
   }
 
-  void failed()
+  void catchup(uint64_t position)
   {
-    promise.fail(
-        "Failed to catch-up position " + stringify(current) +
-        ": " + catching.failure());
+    // Store the future so that we can discard it if the user wants to
+    // cancel the catch-up operation.
+    Future<uint64_t> future =
+      log::catchup(quorum, replica, network, proposal, position);
+
+    catching[position] = future;
 
-    terminate(self());
+    future.onAny(defer(self(), &Self::caught, position));
+
+    Timer::create(timeout, lambda::bind(&Self::timedout<uint64_t>, future));
   }
 
-  void succeeded()
+  void caught(uint64_t position)
   {
-    ++current;
+    CHECK(catching.contains(position));
+
+    const Future<uint64_t> future = catching[position];
+    catching.erase(position);
 
-    // The single position catch-up function: 'log::catchup' will
-    // return the highest proposal number seen so far. We use this
-    // proposal number for the next 'catchup' as it is highly likely
-    // that this number is high enough, saving potentially unnecessary
-    // proposal number bumps.
-    proposal = catching.get();
+    if (future.isDiscarded()) {
+      LOG(INFO) << "Unable to catch-up position " << position
+                << " in " << timeout << ", retrying";
 
-    catchup();
+      catchup(position);
+    } else if (future.isFailed()) {
+      promise.fail(
+          "Failed to catch-up position " + stringify(position) +
+          ": " + future.failure());
+
+      terminate(self());
+    } else {
+      // The single position catch-up function: 'log::catchup' will
+      // return the highest proposal number seen so far. We use this
+      // proposal number for the subsequent 'catchup's as it is highly
+      // likely that this number is high enough, saving potentially
+      // unnecessary proposal number bumps.
+      proposal = std::max(proposal, future.get());
+
+      catchup();
+    }
   }
 
   const size_t quorum;
@@ -278,12 +414,24 @@ private:
   const Shared<Network> network;
   const Interval<uint64_t> positions;
   const Duration timeout;
+  const size_t concurrency;
+  const size_t batch;
 
   uint64_t proposal;
-  uint64_t current;
+
+  // The chunk of positions [lower, upper) being caught-up.
+  uint64_t lower;
+  uint64_t upper;
+
+  // Positions in the current chunk that still need to go through
+  // Paxos but haven't been started yet.
+  IntervalSet<uint64_t> missing;
 
   process::Promise<Nothing> promise;
-  Future<uint64_t> catching;
+  Future<CatchUpResponse> fetching;
+  Future<bool> learning;
+  Future<IntervalSet<uint64_t> > checking;
+  hashmap<uint64_t, Future<uint64_t> > catching;
 };
 
 
@@ -293,7 +441,9 @@ static Future<Nothing> catchup(
     const Shared<Network>& network,
     const Option<uint64_t>& proposal,
     const Interval<uint64_t>& positions,
-    const Duration& timeout)
+    const Duration& timeout,
+    size_t concurrency,
+    size_t batch)
 {
   BulkCatchUpProcess* process =
     new BulkCatchUpProcess(
@@ -302,7 +452,9 @@ static Future<Nothing> catchup(
         network,
         proposal.get(0),
         positions,
-        timeout);
+        timeout,
+        concurrency,
+        batch);
 
   Future<Nothing> future = process->future();
   spawn(process, true);
@@ -321,7 +473,9 @@ Future<Nothing> catchup(
     const Shared<Network>& network,
     const Option<uint64_t>& proposal,
     const IntervalSet<uint64_t>& positions,
-    const Duration& timeout)
+    const Duration& timeout,
+    size_t concurrency,
+    size_t batch)
 {
   // Necessary to disambiguate overloaded functions.
   Future<Nothing> (*f)(
@@ -330,7 +484,9 @@ Future<Nothing> catchup(
       const Shared<Network>& network,
       const Option<uint64_t>& proposal,
       const Interval<uint64_t>& positions,
-      const Duration& timeout) = &catchup;
+      const Duration& timeout,
+      size_t concurrency,
+      size_t batch) = &catchup;
 
   Future<Nothing> future = Nothing();
 
@@ -343,7 +499,9 @@ Future<Nothing> catchup(
             network,
             proposal,
             interval,
-            timeout));
+            timeout,
+            concurrency,
+            batch));
   }
 
   return future;
@@ -36,6 +36,14 @@ namespace mesos {
 namespace internal {
 namespace log {
 
+// The number of positions that are caught-up in parallel through
+// Paxos, and the number of learned positions fetched from a peer in a
+// single request, when a replica is recovering or filling the missing
+// positions after an election.
+const size_t CATCHUP_CONCURRENCY = 32;
+const size_t CATCHUP_BATCH_SIZE = 1024;
+
+
 // Catches-up a set of log positions in the local replica. The user of
 // this function can provide a hint on the proposal number that will
 // be used for Paxos. This could potentially save us a few Paxos
@@ -43,14 +51,20 @@ namespace log {
 // use, he can just use none. We also allow the user to specify a
 // timeout for the catch-up operation on each position and retry the
 // operation if timeout happens. This can help us tolerate network
-// blips.
+// blips. By default, positions are caught-up one at a time. A replica
+// that is lagging far behind can instead catch-up up to 'concurrency'
+// positions in parallel and, if 'batch' is positive, fetch the learned
+// actions of up to 'batch' positions per request from a single peer,
+// falling back to Paxos only for the positions that peer is missing.
 extern process::Future<Nothing> catchup(
     size_t quorum,
     const process::Shared<Replica>& replica,
     const process::Shared<Network>& network,
     const Option<uint64_t>& proposal,
     const IntervalSet<uint64_t>& positions,
-    const Duration& timeout = Seconds(10));
+    const Duration& timeout = Seconds(10),
+    size_t concurrency = 1,
+    size_t batch = 0);
 
 } // namespace log {
 } // namespace internal {
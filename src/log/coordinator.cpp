@@ -65,6 +65,7 @@ public:
   Future<uint64_t> demote();
   Future<Option<uint64_t> > append(const string& bytes);
   Future<Option<uint64_t> > truncate(uint64_t to);
+  Future<Option<uint64_t> > snapshot(const string& bytes);
 
 protected:
   virtual void finalize()
@@ -228,7 +229,15 @@ Future<Nothing> CoordinatorProcess::catchupMissingPositions(
 {
   LOG(INFO) << "Coordinator attemping to fill missing position";
 
-  return log::catchup(quorum, replica, network, proposal, positions);
+  return log::catchup(
+      quorum,
+      replica,
+      network,
+      proposal,
+      positions,
+      Seconds(10),
+      CATCHUP_CONCURRENCY,
+      CATCHUP_BATCH_SIZE);
 }
 
 
@@ -326,6 +335,29 @@ Future<Option<uint64_t> > CoordinatorProcess::truncate(uint64_t to)
 }
 
 
+Future<Option<uint64_t> > CoordinatorProcess::snapshot(const string& bytes)
+{
+  if (state == INITIAL || state == ELECTING) {
+    return None();
+  } else if (state == WRITING) {
+    return Failure("Coordinator is currently writing");
+  }
+
+  // A snapshot is a truncate action that truncates all positions
+  // before itself and carries the snapshot bytes with it.
+  Action action;
+  action.set_position(index);
+  action.set_promised(proposal);
+  action.set_performed(proposal);
+  action.set_type(Action::TRUNCATE);
+  Action::Truncate* truncate = action.mutable_truncate();
+  truncate->set_to(index);
+  truncate->set_snapshot(bytes);
+
+  return write(action);
+}
+
+
 Future<Option<uint64_t> > CoordinatorProcess::write(const Action& action)
 {
   LOG(INFO) << "Coordinator attempting to write " << action.type()
@@ -467,6 +499,12 @@ Future<Option<uint64_t> > Coordinator::truncate(uint64_t to)
   return dispatch(process, &CoordinatorProcess::truncate, to);
 }
 
+
+Future<Option<uint64_t> > Coordinator::snapshot(const string& bytes)
+{
+  return dispatch(process, &CoordinatorProcess::snapshot, bytes);
+}
+
 } // namespace log {
 } // namespace internal {
 } // namespace mesos {
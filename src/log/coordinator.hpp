@@ -71,6 +71,12 @@ public:
   // coordinator was demoted.
   process::Future<Option<uint64_t> > truncate(uint64_t to);
 
+  // Writes the specified snapshot at the end of the log and removes
+  // all log entries preceding it. Returns the position of the
+  // snapshot if the operation succeeds or none if the coordinator was
+  // demoted.
+  process::Future<Option<uint64_t> > snapshot(const std::string& bytes);
+
 private:
   CoordinatorProcess* process;
 };
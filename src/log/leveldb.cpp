@@ -25,6 +25,9 @@
 
 #include <stdint.h>
 
+#include <process/dispatch.hpp>
+#include <process/process.hpp>
+
 #include <stout/check.hpp>
 #include <stout/error.hpp>
 #include <stout/numify.hpp>
@@ -33,6 +36,8 @@
 
 #include "log/leveldb.hpp"
 
+using namespace process;
+
 using std::string;
 
 namespace mesos {
@@ -126,8 +131,36 @@ static string encode(uint64_t position, bool adjust = true)
 // }
 
 
+// Compacts ranges of the db on its own process, so a (large)
+// compaction after a truncation doesn't stall the replica's writes.
+// NOTE: leveldb allows a db to be used from multiple threads.
+class LevelDBCompactorProcess : public Process<LevelDBCompactorProcess>
+{
+public:
+  explicit LevelDBCompactorProcess(leveldb::DB* _db) : db(_db) {}
+
+  virtual ~LevelDBCompactorProcess() {}
+
+  void compact(const string& begin, const string& end)
+  {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    leveldb::Slice beginKey(begin);
+    leveldb::Slice endKey(end);
+
+    db->CompactRange(&beginKey, &endKey);
+
+    LOG(INFO) << "Compacting leveldb took " << stopwatch.elapsed();
+  }
+
+private:
+  leveldb::DB* db;
+};
+
+
 LevelDBStorage::LevelDBStorage()
-  : db(NULL), first(None())
+  : db(NULL), compactor(NULL), first(None())
 {
   // Nothing to see here.
 }
@@ -135,6 +168,13 @@ LevelDBStorage::LevelDBStorage()
 
 LevelDBStorage::~LevelDBStorage()
 {
+  // Wait for any compaction in progress before closing the db.
+  if (compactor != NULL) {
+    terminate(compactor);
+    wait(compactor);
+    delete compactor;
+  }
+
   delete db; // Might be null if open failed in LevelDBStorage::restore.
 }
 
@@ -180,6 +220,9 @@ Try<Storage::State> LevelDBStorage::restore(const string& path)
 
   LOG(INFO) << "Compacted db in " << stopwatch.elapsed();
 
+  compactor = new LevelDBCompactorProcess(db);
+  spawn(compactor);
+
   State state;
   state.begin = 0;
   state.end = 0;
@@ -394,10 +437,19 @@ Try<Nothing> LevelDBStorage::persist(const Action& action)
       } else {
         // Save the new first position!
         CHECK_LT(first.get(), action.truncate().to());
+        const uint64_t from = first.get();
         first = action.truncate().to();
 
         LOG(INFO) << "Deleting ~" << index
                   << " keys from leveldb took " << stopwatch.elapsed();
+
+        // Deleting keys in leveldb only writes tombstones, so compact
+        // the deleted range in order to actually reclaim the disk
+        // space (and avoid skipping over the tombstones on reads).
+        dispatch(compactor,
+                 &LevelDBCompactorProcess::compact,
+                 encode(from),
+                 encode(first.get()));
       }
     }
   }
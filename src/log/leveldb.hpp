@@ -31,6 +31,9 @@ namespace mesos {
 namespace internal {
 namespace log {
 
+// Forward declaration.
+class LevelDBCompactorProcess;
+
 // Concrete implementation of the storage interface using leveldb.
 class LevelDBStorage : public Storage
 {
@@ -46,6 +49,9 @@ public:
 private:
   leveldb::DB* db;
 
+  // Compacts truncated ranges in the background.
+  LevelDBCompactorProcess* compactor;
+
   // First position still in leveldb, used during truncation.
   Option<uint64_t> first;
 };
@@ -156,6 +156,7 @@ public:
   Future<Option<Log::Position> > start();
   Future<Option<Log::Position> > append(const string& bytes);
   Future<Option<Log::Position> > truncate(const Log::Position& to);
+  Future<Option<Log::Position> > snapshot(const string& bytes);
 
 protected:
   virtual void initialize();
@@ -523,10 +524,14 @@ Future<list<Log::Entry> > LogReaderProcess::__read(
       return Failure("Bad read range (includes missing entries)");
     }
 
-    // And only return appends.
+    // And only return appends and snapshots.
     CHECK(action.has_type());
     if (action.type() == Action::APPEND) {
       entries.push_back(Log::Entry(action.position(), action.append().bytes()));
+    } else if (action.type() == Action::TRUNCATE &&
+               action.truncate().has_snapshot()) {
+      entries.push_back(
+          Log::Entry(action.position(), action.truncate().snapshot(), true));
     }
   }
 
@@ -695,6 +700,24 @@ Future<Option<Log::Position> > LogWriterProcess::truncate(
 }
 
 
+Future<Option<Log::Position> > LogWriterProcess::snapshot(const string& bytes)
+{
+  LOG(INFO) << "Attempting to snapshot " << bytes.size() << " bytes to the log";
+
+  if (coordinator == NULL) {
+    return Failure("No election has been performed");
+  }
+
+  if (error.isSome()) {
+    return Failure(error.get());
+  }
+
+  return coordinator->snapshot(bytes)
+    .then(lambda::bind(&Self::position, lambda::_1))
+    .onFailed(defer(self(), &Self::failed, "Failed to snapshot", lambda::_1));
+}
+
+
 Option<Log::Position> LogWriterProcess::position(
     const Option<uint64_t>& position)
 {
@@ -828,6 +851,12 @@ Future<Option<Log::Position> > Log::Writer::truncate(const Log::Position& to)
   return dispatch(process, &LogWriterProcess::truncate, to);
 }
 
+
+Future<Option<Log::Position> > Log::Writer::snapshot(const string& data)
+{
+  return dispatch(process, &LogWriterProcess::snapshot, data);
+}
+
 } // namespace log {
 } // namespace internal {
 } // namespace mesos {
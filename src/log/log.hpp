@@ -116,11 +116,17 @@ public:
     Position position;
     std::string data;
 
+    // Whether 'data' is a snapshot written via Writer::snapshot, in
+    // which case it supersedes all the entries before it.
+    bool snapshot;
+
   private:
     friend class LogReaderProcess;
 
-    Entry(const Position& _position, const std::string& _data)
-      : position(_position), data(_data) {}
+    Entry(const Position& _position,
+          const std::string& _data,
+          bool _snapshot = false)
+      : position(_position), data(_data), snapshot(_snapshot) {}
   };
 
   class Reader
@@ -131,6 +137,9 @@ public:
 
     // Returns all entries between the specified positions, unless
     // those positions are invalid, in which case returns an error.
+    // If the log has been snapshotted, the entry at the beginning
+    // position is the latest snapshot, so a client can recover its
+    // state by reading from the beginning to the ending position.
     process::Future<std::list<Entry> > read(
         const Position& from,
         const Position& to);
@@ -180,6 +189,16 @@ public:
     // write (which can be reacquired by invoking Writer::start).
     process::Future<Option<Position> > truncate(const Position& to);
 
+    // Attempts to append a snapshot of the client's state to the log
+    // and truncate all the entries before it. The snapshot must
+    // reflect every entry appended so far. Replicas store it durably
+    // and reclaim the disk space of the truncated entries. Returns the
+    // position of the snapshot (the new beginning and ending position
+    // of the log) or 'none' if this writer has lost it's promise to
+    // exclusively write (which can be reacquired by invoking
+    // Writer::start).
+    process::Future<Option<Position> > snapshot(const std::string& data);
+
   private:
     LogWriterProcess* process;
   };
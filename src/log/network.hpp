@@ -22,9 +22,12 @@
 // TODO(benh): Eventually move and associate this code with the
 // libprocess protobuf code rather than keep it here.
 
+#include <stdlib.h> // For random.
+
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <process/collect.hpp>
 #include <process/executor.hpp>
@@ -90,6 +93,16 @@ public:
       const Req& req,
       const std::set<process::UPID>& filter = std::set<process::UPID>()) const;
 
+  // Sends a request to a single member of the network, chosen at
+  // random among those not in 'filter', and returns a future that
+  // represents its response. The future fails if there is no such
+  // member.
+  template <typename Req, typename Res>
+  process::Future<Res> unicast(
+      const Protocol<Req, Res>& protocol,
+      const Req& req,
+      const std::set<process::UPID>& filter = std::set<process::UPID>()) const;
+
   // Sends a message to each member of the network. The returned
   // future is set when the message is broadcasted.
   template <typename M>
@@ -213,6 +226,26 @@ public:
     return futures;
   }
 
+  template <typename Req, typename Res>
+  process::Future<Res> unicast(
+      const Protocol<Req, Res>& protocol,
+      const Req& req,
+      const std::set<process::UPID>& filter)
+  {
+    std::vector<process::UPID> candidates;
+    foreach (const process::UPID& pid, pids) {
+      if (filter.count(pid) == 0) {
+        candidates.push_back(pid);
+      }
+    }
+
+    if (candidates.empty()) {
+      return process::Failure("No member available in the network");
+    }
+
+    return protocol(candidates[::random() % candidates.size()], req);
+  }
+
   template <typename M>
   Nothing broadcast(
       const M& m,
@@ -356,6 +389,17 @@ process::Future<std::set<process::Future<Res> > > Network::broadcast(
 }
 
 
+template <typename Req, typename Res>
+process::Future<Res> Network::unicast(
+    const Protocol<Req, Res>& protocol,
+    const Req& req,
+    const std::set<process::UPID>& filter) const
+{
+  return process::dispatch(process, &NetworkProcess::unicast<Req, Res>,
+                           protocol, req, filter);
+}
+
+
 template <typename M>
 process::Future<Nothing> Network::broadcast(
     const M& m,
@@ -381,7 +381,15 @@ private:
     // Since we do not know what proposal number to use (the log is
     // empty), we use none and leave log::catchup to automatically
     // bump the proposal number.
-    return log::catchup(quorum, shared, network, None(), positions)
+    return log::catchup(
+        quorum,
+        shared,
+        network,
+        None(),
+        positions,
+        Seconds(10),
+        CATCHUP_CONCURRENCY,
+        CATCHUP_BATCH_SIZE)
       .then(defer(self(), &Self::getReplicaOwnership, shared))
       .then(defer(self(), &Self::updateReplicaStatus, Metadata::VOTING));
   }
@@ -53,6 +53,7 @@ namespace protocol {
 Protocol<PromiseRequest, PromiseResponse> promise;
 Protocol<WriteRequest, WriteResponse> write;
 Protocol<RecoverRequest, RecoverResponse> recover;
+Protocol<CatchUpRequest, CatchUpResponse> catchup;
 
 } // namespace protocol {
 
@@ -102,6 +103,10 @@ public:
   // the disk. Returns true on success and false otherwise.
   bool update(const Metadata::Status& status);
 
+  // Persists the specified learned actions. Returns true on success
+  // and false otherwise.
+  bool learn(const list<Action>& actions);
+
 private:
   // Handles a request from a proposer to promise not to accept writes
   // from any other proposer with lower proposal number.
@@ -113,6 +118,9 @@ private:
   // Handles a request from a recover process.
   void recover(const RecoverRequest& request);
 
+  // Handles a request from a lagging replica for learned actions.
+  void catchup(const CatchUpRequest& request);
+
   // Handles a message notifying of a learned action.
   void learned(const Action& action);
 
@@ -169,6 +177,9 @@ ReplicaProcess::ReplicaProcess(const string& path)
   install<RecoverRequest>(
       &ReplicaProcess::recover);
 
+  install<CatchUpRequest>(
+      &ReplicaProcess::catchup);
+
   install<LearnedMessage>(
       &ReplicaProcess::learned,
       &LearnedMessage::action);
@@ -326,6 +337,26 @@ bool ReplicaProcess::update(const Metadata::Status& status)
 }
 
 
+bool ReplicaProcess::learn(const list<Action>& actions)
+{
+  foreach (const Action& action, actions) {
+    CHECK(action.learned());
+
+    // Skip positions that we have already learned (or truncated) so
+    // that we don't rewrite them needlessly.
+    if (!missing(action.position())) {
+      continue;
+    }
+
+    if (!persist(action)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
 bool ReplicaProcess::update(uint64_t promised)
 {
   Metadata metadata_;
@@ -638,6 +669,38 @@ void ReplicaProcess::recover(const RecoverRequest& request)
 }
 
 
+void ReplicaProcess::catchup(const CatchUpRequest& request)
+{
+  LOG(INFO) << "Replica in " << status()
+            << " status received a catch-up request for positions "
+            << request.from() << " -> " << request.to();
+
+  CatchUpResponse response;
+
+  // Only consider the positions that we actually have.
+  const uint64_t from = std::max(request.from(), begin);
+  const uint64_t to = std::min(request.to(), end);
+
+  for (uint64_t position = from; position <= to; position++) {
+    if (missing(position)) {
+      continue;
+    }
+
+    Result<Action> action = read(position);
+
+    if (action.isError()) {
+      LOG(ERROR) << "Error reading position " << position
+                 << " for catch-up: " << action.error();
+      break;
+    } else if (action.isSome() && action.get().learned()) {
+      response.add_actions()->CopyFrom(action.get());
+    }
+  }
+
+  reply(response);
+}
+
+
 void ReplicaProcess::learned(const Action& action)
 {
   LOG(INFO) << "Replica received learned notice for position "
@@ -801,6 +864,12 @@ Future<bool> Replica::update(const Metadata::Status& status)
 }
 
 
+Future<bool> Replica::learn(const list<Action>& actions) const
+{
+  return dispatch(process, &ReplicaProcess::learn, actions);
+}
+
+
 PID<ReplicaProcess> Replica::pid() const
 {
   return process->self();
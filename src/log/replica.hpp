@@ -42,6 +42,7 @@ namespace protocol {
 extern Protocol<PromiseRequest, PromiseResponse> promise;
 extern Protocol<WriteRequest, WriteResponse> write;
 extern Protocol<RecoverRequest, RecoverResponse> recover;
+extern Protocol<CatchUpRequest, CatchUpResponse> catchup;
 
 } // namespace protocol {
 
@@ -94,6 +95,11 @@ public:
   // Updates the status of this replica.
   process::Future<bool> update(const Metadata::Status& status);
 
+  // Persists actions that are known to be learned (e.g., fetched from
+  // another replica during catch-up). Returns true if all the actions
+  // were written successfully and false otherwise.
+  process::Future<bool> learn(const std::list<Action>& actions) const;
+
   // Returns the PID associated with this replica.
   process::PID<ReplicaProcess> pid() const;
 
@@ -402,12 +402,14 @@ void Master::initialize()
 
   install<RegisterFrameworkMessage>(
       &Master::registerFramework,
-      &RegisterFrameworkMessage::framework);
+      &RegisterFrameworkMessage::framework,
+      &RegisterFrameworkMessage::version);
 
   install<ReregisterFrameworkMessage>(
       &Master::reregisterFramework,
       &ReregisterFrameworkMessage::framework,
-      &ReregisterFrameworkMessage::failover);
+      &ReregisterFrameworkMessage::failover,
+      &ReregisterFrameworkMessage::version);
 
   install<UnregisterFrameworkMessage>(
       &Master::unregisterFramework,
@@ -467,6 +469,11 @@ void Master::initialize()
       &StatusUpdateMessage::update,
       &StatusUpdateMessage::pid);
 
+  install<StatusUpdatesMessage>(
+      &Master::statusUpdates,
+      &StatusUpdatesMessage::updates,
+      &StatusUpdatesMessage::pid);
+
   install<ReconcileTasksMessage>(
       &Master::reconcileTasks,
       &ReconcileTasksMessage::framework_id,
@@ -919,14 +926,19 @@ void Master::detected(const Future<Option<MasterInfo> >& _leader)
 
 void Master::registerFramework(
     const UPID& from,
-    const FrameworkInfo& frameworkInfo)
+    const FrameworkInfo& frameworkInfo,
+    const string& version)
 {
   if (authenticating.contains(from)) {
     LOG(INFO) << "Queuing up registration request from " << from
               << " because authentication is still in progress";
 
     authenticating[from]
-      .onReady(defer(self(), &Self::registerFramework, from, frameworkInfo));
+      .onReady(defer(self(),
+                     &Self::registerFramework,
+                     from,
+                     frameworkInfo,
+                     version));
     return;
   }
 
@@ -967,6 +979,7 @@ void Master::registerFramework(
 
   Framework* framework =
     new Framework(frameworkInfo, newFrameworkId(), from, Clock::now());
+  framework->version = version;
 
   LOG(INFO) << "Registering framework " << framework->id << " at " << from;
 
@@ -989,7 +1002,8 @@ void Master::registerFramework(
 void Master::reregisterFramework(
     const UPID& from,
     const FrameworkInfo& frameworkInfo,
-    bool failover)
+    bool failover,
+    const string& version)
 {
   if (authenticating.contains(from)) {
     LOG(INFO) << "Queuing up re-registration request from " << from
@@ -1000,7 +1014,8 @@ void Master::reregisterFramework(
                      &Self::reregisterFramework,
                      from,
                      frameworkInfo,
-                     failover));
+                     failover,
+                     version));
     return;
   }
 
@@ -1059,6 +1074,7 @@ void Master::reregisterFramework(
       // TODO: Should we check whether the new scheduler has given
       // us a different framework name, user name or executor info?
       LOG(INFO) << "Framework " << frameworkInfo.id() << " failed over";
+      framework->version = version;
       failoverFramework(framework, from);
     } else if (from != framework->pid) {
       LOG(ERROR)
@@ -1073,6 +1089,8 @@ void Master::reregisterFramework(
       LOG(INFO) << "Allowing the Framework " << frameworkInfo.id()
                 << " to re-register with an already used id";
 
+      framework->version = version;
+
       // Make sure we can get offers again.
       // The framework might have been deactivated if it was doing
       // authentication.
@@ -1107,6 +1125,7 @@ void Master::reregisterFramework(
     Framework* framework =
       new Framework(frameworkInfo, frameworkInfo.id(), from, Clock::now());
     framework->reregisteredTime = Clock::now();
+    framework->version = version;
 
     // TODO(benh): Check for root submissions like above!
 
@@ -2005,6 +2024,7 @@ void Master::registerSlave(const UPID& from, const SlaveInfo& slaveInfo)
                   << ") already registered, resending acknowledgement";
         SlaveRegisteredMessage message;
         message.mutable_slave_id()->MergeFrom(slave->id);
+        message.set_version(MESOS_VERSION);
         reply(message);
         return;
       }
@@ -2112,6 +2132,7 @@ void Master::reregisterSlave(
 
     SlaveReregisteredMessage message;
     message.mutable_slave_id()->MergeFrom(slave->id);
+    message.set_version(MESOS_VERSION);
     reply(message);
 
     // Update the slave pid and relink to it.
@@ -2249,66 +2270,92 @@ void Master::unregisterSlave(const SlaveID& slaveId)
 // the slave.
 void Master::statusUpdate(const StatusUpdate& update, const UPID& pid)
 {
-  if (slaves.deactivated.get(update.slave_id()).isSome()) {
-    // If the slave is deactivated, we have already informed
-    // frameworks that its tasks were LOST, so the slave should
-    // shut down.
-    LOG(WARNING) << "Ignoring status update " << update
-                 << " from deactivated slave " << pid
-                 << " with id " << update.slave_id() << " ; asking slave "
-                 << " to shutdown";
-    send(pid, ShutdownMessage());
-    stats.invalidStatusUpdates++;
-    return;
-  }
+  statusUpdates(vector<StatusUpdate>(1, update), pid);
+}
 
-  if (!slaves.activated.contains(update.slave_id())) {
-    LOG(WARNING) << "Ignoring status update " << update
-                 << " from unknown slave " << pid
-                 << " with id " << update.slave_id();
-    stats.invalidStatusUpdates++;
-    return;
-  }
 
-  Slave* slave = CHECK_NOTNULL(slaves.activated[update.slave_id()]);
+void Master::statusUpdates(
+    const vector<StatusUpdate>& updates,
+    const UPID& pid)
+{
+  // The updates to forward to each framework. We forward them after
+  // handling all of them so that each framework gets a single message
+  // (if its driver supports it).
+  hashmap<FrameworkID, vector<StatusUpdate> > forwards;
 
-  // Forward the update to the framework.
-  Try<Nothing> _forward = forward(update, pid);
-  if (_forward.isError()) {
-    LOG(WARNING) << "Ignoring status update " << update << " from " << pid
-                 << " (" << slave->info.hostname() << "): " << _forward.error();
-    stats.invalidStatusUpdates++;
-    return;
-  }
+  bool shutdown = false; // Whether the slave has been asked to shut down.
 
-  // Lookup the task and see if we need to update anything locally.
-  const TaskStatus& status = update.status();
-  Task* task = slave->getTask(update.framework_id(), status.task_id());
-  if (task == NULL) {
-    LOG(WARNING) << "Status update " << update
-                 << " from " << pid << " ("
-                 << slave->info.hostname() << "): error, couldn't lookup task";
-    stats.invalidStatusUpdates++;
-    return;
-  }
+  foreach (const StatusUpdate& update, updates) {
+    if (slaves.deactivated.get(update.slave_id()).isSome()) {
+      // If the slave is deactivated, we have already informed
+      // frameworks that its tasks were LOST, so the slave should
+      // shut down.
+      LOG(WARNING) << "Ignoring status update " << update
+                   << " from deactivated slave " << pid
+                   << " with id " << update.slave_id() << " ; asking slave "
+                   << " to shutdown";
+      if (!shutdown) {
+        send(pid, ShutdownMessage());
+        shutdown = true;
+      }
+      stats.invalidStatusUpdates++;
+      continue;
+    }
 
-  LOG(INFO) << "Status update " << update << " from " << pid;
+    if (!slaves.activated.contains(update.slave_id())) {
+      LOG(WARNING) << "Ignoring status update " << update
+                   << " from unknown slave " << pid
+                   << " with id " << update.slave_id();
+      stats.invalidStatusUpdates++;
+      continue;
+    }
 
-  // TODO(brenden) Consider wiping the `data` and `message` fields?
-  if (task->statuses_size() > 0 &&
-      task->statuses(task->statuses_size() - 1).state() == status.state()) {
-    task->mutable_statuses()->RemoveLast();
-  }
-  task->add_statuses()->CopyFrom(status);
-  task->set_state(status.state());
+    Slave* slave = CHECK_NOTNULL(slaves.activated[update.slave_id()]);
 
-  // Handle the task appropriately if it's terminated.
-  if (protobuf::isTerminalState(status.state())) {
-    removeTask(task);
+    // Forward the update to the framework (see below).
+    if (getFramework(update.framework_id()) == NULL) {
+      LOG(WARNING) << "Ignoring status update " << update << " from " << pid
+                   << " (" << slave->info.hostname() << "): Unknown framework "
+                   << update.framework_id();
+      stats.invalidStatusUpdates++;
+      continue;
+    }
+
+    forwards[update.framework_id()].push_back(update);
+
+    // Lookup the task and see if we need to update anything locally.
+    const TaskStatus& status = update.status();
+    Task* task = slave->getTask(update.framework_id(), status.task_id());
+    if (task == NULL) {
+      LOG(WARNING) << "Status update " << update
+                   << " from " << pid << " ("
+                   << slave->info.hostname() << "): error, couldn't lookup task";
+      stats.invalidStatusUpdates++;
+      continue;
+    }
+
+    LOG(INFO) << "Status update " << update << " from " << pid;
+
+    if (task->statuses_size() > 0 &&
+        task->statuses(task->statuses_size() - 1).state() == status.state()) {
+      task->mutable_statuses()->RemoveLast();
+    }
+    task->add_statuses()->CopyFrom(protobuf::compact(status));
+    task->set_state(status.state());
+
+    // Handle the task appropriately if it's terminated.
+    if (protobuf::isTerminalState(status.state())) {
+      removeTask(task);
+    }
+
+    stats.tasks[status.state()]++;
+    stats.validStatusUpdates++;
   }
 
-  stats.tasks[status.state()]++;
-  stats.validStatusUpdates++;
+  foreachvalue (const vector<StatusUpdate>& updates_, forwards) {
+    Try<Nothing> _forward = forward(updates_, pid);
+    CHECK_SOME(_forward); // We checked the framework above.
+  }
 }
 
 
@@ -2328,6 +2375,41 @@ Try<Nothing> Master::forward(const StatusUpdate& update, const UPID& pid)
 }
 
 
+Try<Nothing> Master::forward(
+    const vector<StatusUpdate>& updates,
+    const UPID& pid)
+{
+  CHECK(!updates.empty());
+
+  Framework* framework = getFramework(updates.front().framework_id());
+  if (framework == NULL) {
+    return Error(
+        "Unknown framework " + stringify(updates.front().framework_id()));
+  }
+
+  // NOTE: A single update always gets sent in a StatusUpdateMessage
+  // so that it doesn't matter whether it came from a slave (i.e.,
+  // 'pid') that can handle a StatusUpdateAcknowledgementsMessage.
+  // Multiple updates come from a StatusUpdatesMessage, i.e., from a
+  // slave that can.
+  if (updates.size() == 1 || framework->version.empty()) {
+    foreach (const StatusUpdate& update, updates) {
+      forward(update, pid);
+    }
+    return Nothing();
+  }
+
+  StatusUpdatesMessage message;
+  foreach (const StatusUpdate& update, updates) {
+    CHECK(framework->id == update.framework_id());
+    message.add_updates()->MergeFrom(update);
+  }
+  message.set_pid(pid);
+  send(framework->pid, message);
+  return Nothing();
+}
+
+
 void Master::exitedExecutor(
     const UPID& from,
     const SlaveID& slaveId,
@@ -2531,13 +2613,16 @@ void Master::offer(const FrameworkID& frameworkId,
       continue;
     }
 
+    // NOTE: We don't keep the slave's attributes in our copy of the
+    // offer since they're already in 'slave->info' and would otherwise
+    // be duplicated for every outstanding offer. They only get filled
+    // in for the offer we send to the framework.
     Offer* offer = new Offer();
     offer->mutable_id()->MergeFrom(newOfferId());
     offer->mutable_framework_id()->MergeFrom(framework->id);
     offer->mutable_slave_id()->MergeFrom(slave->id);
     offer->set_hostname(slave->info.hostname());
     offer->mutable_resources()->MergeFrom(offered);
-    offer->mutable_attributes()->MergeFrom(slave->info.attributes());
 
     // Add all framework's executors running on this slave.
     if (slave->executors.contains(framework->id)) {
@@ -2554,7 +2639,9 @@ void Master::offer(const FrameworkID& frameworkId,
     slave->addOffer(offer);
 
     // Add the offer *AND* the corresponding slave's PID.
-    message.add_offers()->MergeFrom(*offer);
+    Offer* offer_ = message.add_offers();
+    offer_->MergeFrom(*offer);
+    offer_->mutable_attributes()->MergeFrom(slave->info.attributes());
     message.add_pids(slave->pid);
   }
 
@@ -3102,10 +3189,12 @@ void Master::addSlave(Slave* slave, bool reregister)
   if (!reregister) {
     SlaveRegisteredMessage message;
     message.mutable_slave_id()->MergeFrom(slave->id);
+    message.set_version(MESOS_VERSION);
     send(slave->pid, message);
   } else {
     SlaveReregisteredMessage message;
     message.mutable_slave_id()->MergeFrom(slave->id);
+    message.set_version(MESOS_VERSION);
     send(slave->pid, message);
   }
 
@@ -3165,7 +3254,7 @@ void Master::readdSlave(
       continue;
     }
 
-    Task* t = new Task(task);
+    Task* t = new Task(protobuf::compact(task));
 
     // Add the task to the slave.
     slave->addTask(t);
@@ -3206,7 +3295,7 @@ void Master::readdSlave(
                 << " of framework " << task.framework_id()
                 << " that ran on slave " << slave->id << " ("
                 << slave->info.hostname() << ")";
-        framework->addCompletedTask(task);
+        framework->addCompletedTask(protobuf::compact(task));
       } else {
         // We could be here if the framework hasn't registered yet.
         // TODO(vinod): Revisit these semantics when we store frameworks'
@@ -3249,7 +3338,7 @@ void Master::removeSlave(Slave* slave)
           (task->has_executor_id() ?
               Option<ExecutorID>(task->executor_id()) : None()));
 
-      task->add_statuses()->CopyFrom(update.status());
+      task->add_statuses()->CopyFrom(protobuf::compact(update.status()));
       task->set_state(update.status().state());
       removeTask(task);
 
@@ -102,11 +102,13 @@ public:
       const std::string& name);
   void registerFramework(
       const process::UPID& from,
-      const FrameworkInfo& frameworkInfo);
+      const FrameworkInfo& frameworkInfo,
+      const std::string& version);
   void reregisterFramework(
       const process::UPID& from,
       const FrameworkInfo& frameworkInfo,
-      bool failover);
+      bool failover,
+      const std::string& version);
   void unregisterFramework(
       const process::UPID& from,
       const FrameworkID& frameworkId);
@@ -153,6 +155,9 @@ public:
   void statusUpdate(
       const StatusUpdate& update,
       const process::UPID& pid);
+  void statusUpdates(
+      const std::vector<StatusUpdate>& updates,
+      const process::UPID& pid);
   void exitedExecutor(
       const process::UPID& from,
       const SlaveID& slaveId,
@@ -294,6 +299,12 @@ protected:
   // Forwards the update to the framework.
   Try<Nothing> forward(const StatusUpdate& update, const process::UPID& pid);
 
+  // Forwards the updates (of a single framework) to the framework, in
+  // a single message if the framework's driver supports it.
+  Try<Nothing> forward(
+      const std::vector<StatusUpdate>& updates,
+      const process::UPID& pid);
+
   // Remove an offer and optionally rescind the offer as well.
   void removeOffer(Offer* offer, bool rescind = false);
 
@@ -646,7 +657,7 @@ struct Framework
       << "Unknown task " << task->task_id()
       << " of framework " << task->framework_id();
 
-    completedTasks.push_back(memory::shared_ptr<Task>(new Task(*task)));
+    addCompletedTask(*task);
     tasks.erase(task->task_id());
     resources -= task->resources();
   }
@@ -713,6 +724,10 @@ struct Framework
 
   process::UPID pid;
 
+  // Version of the scheduler driver, empty for drivers older than
+  // 0.19.0 (see RegisterFrameworkMessage).
+  std::string version;
+
   bool active; // Turns false when framework is being removed.
   process::Time registeredTime;
   process::Time reregisteredTime;
@@ -155,6 +155,11 @@ protected:
         &StatusUpdateMessage::update,
         &StatusUpdateMessage::pid);
 
+    install<StatusUpdatesMessage>(
+        &SchedulerProcess::statusUpdates,
+        &StatusUpdatesMessage::updates,
+        &StatusUpdatesMessage::pid);
+
     install<LostSlaveMessage>(
         &SchedulerProcess::lostSlave,
         &LostSlaveMessage::slave_id);
@@ -464,12 +469,14 @@ protected:
       // Touched for the very first time.
       RegisterFrameworkMessage message;
       message.mutable_framework()->MergeFrom(framework);
+      message.set_version(MESOS_VERSION);
       send(master.get(), message);
     } else {
       // Not the first time, or failing over.
       ReregisterFrameworkMessage message;
       message.mutable_framework()->MergeFrom(framework);
       message.set_failover(failover);
+      message.set_version(MESOS_VERSION);
       send(master.get(), message);
     }
 
@@ -647,6 +654,85 @@ protected:
     send(pid, message);
   }
 
+  void statusUpdates(
+      const UPID& from,
+      const vector<StatusUpdate>& updates,
+      const UPID& pid)
+  {
+    if (aborted) {
+      VLOG(1) << "Ignoring task status updates message because "
+              << "the driver is aborted!";
+      return;
+    }
+
+    if (!connected) {
+      VLOG(1) << "Ignoring status updates message because the driver is "
+              << "disconnected!";
+      return;
+    }
+
+    CHECK_SOME(master);
+
+    if (from != master.get()) {
+      VLOG(1) << "Ignoring status updates message because it was sent "
+              << "from '" << from << "' instead of the leading master '"
+              << master.get() << "'";
+      return;
+    }
+
+    foreach (const StatusUpdate& update, updates) {
+      // The scheduler might have aborted the driver while handling a
+      // previous update.
+      if (aborted) {
+        VLOG(1) << "Ignoring the remaining status updates because "
+                << "the driver is aborted!";
+        return;
+      }
+
+      VLOG(2) << "Received status update " << update << " from " << pid;
+
+      CHECK(framework.id() == update.framework_id());
+
+      Stopwatch stopwatch;
+      if (FLAGS_v >= 1) {
+        stopwatch.start();
+      }
+
+      scheduler->statusUpdate(driver, update.status());
+
+      VLOG(1) << "Scheduler::statusUpdate took " << stopwatch.elapsed();
+    }
+
+    // Acknowledge all the status updates at once (see 'statusUpdate'
+    // for why we dispatch).
+    dispatch(self(), &Self::statusUpdateAcknowledgements, updates, pid);
+  }
+
+  void statusUpdateAcknowledgements(
+      const vector<StatusUpdate>& updates,
+      const UPID& pid)
+  {
+    if (aborted) {
+      VLOG(1) << "Not sending status update acknowledgments message because "
+              << "the driver is aborted!";
+      return;
+    }
+
+    VLOG(2) << "Sending ACKs for " << updates.size() << " status updates to "
+            << pid;
+
+    StatusUpdateAcknowledgementsMessage message;
+    foreach (const StatusUpdate& update, updates) {
+      StatusUpdateAcknowledgementMessage* acknowledgement =
+        message.add_acknowledgements();
+      acknowledgement->mutable_framework_id()->MergeFrom(framework.id());
+      acknowledgement->mutable_slave_id()->MergeFrom(update.slave_id());
+      acknowledgement->mutable_task_id()->MergeFrom(update.status().task_id());
+      acknowledgement->set_uuid(update.uuid());
+    }
+    send(pid, message);
+  }
+
   void lostSlave(const UPID& from, const SlaveID& slaveId)
   {
     if (aborted) {
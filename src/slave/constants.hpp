@@ -45,9 +45,19 @@ extern const Duration GC_DELAY;
 extern const Duration DISK_WATCH_INTERVAL;
 extern const Duration RESOURCE_MONITORING_INTERVAL;
 
+// Default period of the CFS bandwidth control (i.e., Linux's).
+extern const Duration CPU_CFS_PERIOD;
+
 // Minimum free disk capacity enforced by the garbage collector.
 extern const double GC_DISK_HEADROOM;
 
+// Maximum number of paths the garbage collector removes concurrently.
+extern const uint32_t GC_THREADS;
+
+// Maximum number of sandbox entries whose disk usage gets checked per
+// --sandbox_usage_interval.
+extern const uint32_t SANDBOX_USAGE_ENTRIES;
+
 // Maximum number of completed frameworks to store in memory.
 extern const uint32_t MAX_COMPLETED_FRAMEWORKS;
 
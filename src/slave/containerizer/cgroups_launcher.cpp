@@ -16,6 +16,10 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include <vector>
 
 #include <stout/abort.hpp>
@@ -143,6 +147,10 @@ Try<pid_t> CgroupsLauncher::fork(
     }
   }
 
+  if (flags.launcher_vfork) {
+    return vfork(containerId, inChild);
+  }
+
   // Additional processes forked will be put into the same process group and
   // session.
   Option<pid_t> pgid = pids.get(containerId);
@@ -237,6 +245,80 @@ Try<pid_t> CgroupsLauncher::fork(
 }
 
 
+// Same as in launcher.cpp.
+static void childExit(const char* message)
+{
+  while (::write(STDERR_FILENO, message, ::strlen(message)) == -1 &&
+         errno == EINTR);
+  _exit(1);
+}
+
+
+// Executed in the child of 'cloneVM', see CgroupsLauncher::fork.
+static int cgroupsChild(
+    const lambda::function<int()>& inChild,
+    const Option<pid_t>& pgid,
+    const string& procs)
+{
+  if (pgid.isSome()) {
+    if (setpgid(0, pgid.get()) == -1) {
+      childExit("Failed to put child into process group\n");
+    }
+  } else if (setsid() == -1) {
+    childExit("Failed to put child in a new session\n");
+  }
+
+  // Move ourselves into the freezer cgroup ('0' being the writer)
+  // before we exec, rather than waiting for the parent to move us.
+  int fd = ::open(procs.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd == -1) {
+    childExit("Failed to open the freezer cgroup\n");
+  }
+
+  ssize_t len;
+  while ((len = ::write(fd, "0", 1)) == -1 && errno == EINTR);
+
+  if (len != 1) {
+    childExit("Failed to move child into the freezer cgroup\n");
+  }
+
+  ::close(fd);
+
+  // This function should exec() and therefore not return.
+  inChild();
+
+  childExit("Child failed to exec\n");
+  return 1;
+}
+
+
+Try<pid_t> CgroupsLauncher::vfork(
+    const ContainerID& containerId,
+    const lambda::function<int()>& inChild)
+{
+  // Prepared here since the child can't allocate memory.
+  const string procs =
+    path::join(hierarchy, cgroup(containerId), "cgroup.procs");
+
+  // Additional processes forked will be put into the same process
+  // group and session.
+  Try<pid_t> pid = cloneVM(
+      lambda::bind(&cgroupsChild, inChild, pids.get(containerId), procs));
+
+  if (pid.isError()) {
+    return Error("Failed to fork: " + pid.error());
+  }
+
+  // Store the pid (session id and process group id) if this is the
+  // first process forked for this container.
+  if (!pids.contains(containerId)) {
+    pids.put(containerId, pid.get());
+  }
+
+  return pid.get();
+}
+
+
 Future<Nothing> _destroy(
     const ContainerID& containerId,
     process::Future<bool> destroyed)
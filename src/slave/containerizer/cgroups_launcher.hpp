@@ -51,6 +51,12 @@ private:
 
   std::string cgroup(const ContainerID& containerId);
 
+  // Forks using 'cloneVM' rather than fork (see --launcher_vfork),
+  // the child moving itself into the freezer cgroup before it execs.
+  Try<pid_t> vfork(
+      const ContainerID& containerId,
+      const lambda::function<int()>& inChild);
+
   // The 'pid' is the process id of the first process and also the process
   // group id and session id.
   hashmap<ContainerID, pid_t> pids;
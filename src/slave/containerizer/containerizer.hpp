@@ -29,6 +29,7 @@
 #include <process/process.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/json.hpp>
 #include <stout/option.hpp>
 #include <stout/try.hpp>
 
@@ -118,6 +119,13 @@ public:
   // NOTE: Containerizers will automatically destroy containers on executor
   // termination and manual destruction is not necessary. See wait().
   virtual void destroy(const ContainerID& containerId) = 0;
+
+  // Get statistics about the containerizer itself (e.g., its fetcher
+  // cache), these are included in the slave's stats.json.
+  virtual process::Future<JSON::Object> statistics()
+  {
+    return JSON::Object();
+  }
 };
 
 
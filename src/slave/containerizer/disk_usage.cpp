@@ -0,0 +1,385 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <process/delay.hpp>
+#include <process/dispatch.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "common/type_utils.hpp"
+
+#include "logging/logging.hpp"
+
+#include "slave/constants.hpp"
+
+#include "slave/containerizer/disk_usage.hpp"
+
+using std::deque;
+using std::string;
+using std::vector;
+
+using namespace process;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+class DiskUsageCollectorProcess : public Process<DiskUsageCollectorProcess>
+{
+public:
+  explicit DiskUsageCollectorProcess(const Duration& _interval)
+    : interval(_interval) {}
+
+  virtual ~DiskUsageCollectorProcess() {}
+
+  virtual void initialize();
+
+  void watch(const ContainerID& containerId, const string& directory);
+  void unwatch(const ContainerID& containerId);
+  Option<Bytes> usage(const ContainerID& containerId);
+
+private:
+  struct Directory
+  {
+    Option<time_t> listed; // When the directory was last listed.
+    vector<string> files; // Names of the (non directory) entries.
+    vector<string> directories; // Names of the subdirectories.
+    Bytes bytes; // Disk space taken by the directory and its files.
+  };
+
+  struct Sandbox
+  {
+    explicit Sandbox(const string& _directory)
+      : directory(_directory), scanned(false) {}
+
+    const string directory;
+
+    // The directories in the sandbox, keyed by their path relative
+    // to the sandbox (the sandbox itself being "").
+    hashmap<string, Directory> directories;
+
+    // Directories left to scan in the current pass over the sandbox.
+    deque<string> pending;
+
+    Bytes bytes; // Total of 'directories'.
+    bool scanned; // Whether the sandbox has been scanned in full.
+  };
+
+  // Scans a slice of the sandboxes, then schedules the next slice.
+  void collect();
+
+  // Scans a directory of the sandbox, queuing its subdirectories to
+  // be scanned next. Returns the number of entries checked.
+  size_t scan(Sandbox* sandbox, const string& relative);
+
+  // (Re)lists the directory 'fd', forgetting removed subdirectories.
+  void relist(
+      Sandbox* sandbox,
+      const string& relative,
+      Directory* directory,
+      int fd);
+
+  // Forgets a directory, and everything under it, e.g., once removed.
+  void forget(Sandbox* sandbox, const string& relative);
+
+  const Duration interval;
+
+  hashmap<ContainerID, Owned<Sandbox> > sandboxes;
+
+  // The order in which the sandboxes get scanned, which rotates so
+  // that every sandbox eventually gets scanned first.
+  std::list<ContainerID> order;
+};
+
+
+void DiskUsageCollectorProcess::initialize()
+{
+  delay(interval, self(), &Self::collect);
+}
+
+
+void DiskUsageCollectorProcess::watch(
+    const ContainerID& containerId,
+    const string& directory)
+{
+  if (!sandboxes.contains(containerId)) {
+    order.push_back(containerId);
+  }
+
+  sandboxes[containerId] = Owned<Sandbox>(new Sandbox(directory));
+}
+
+
+void DiskUsageCollectorProcess::unwatch(const ContainerID& containerId)
+{
+  sandboxes.erase(containerId);
+  order.remove(containerId);
+}
+
+
+Option<Bytes> DiskUsageCollectorProcess::usage(const ContainerID& containerId)
+{
+  if (!sandboxes.contains(containerId) || !sandboxes[containerId]->scanned) {
+    return None();
+  }
+
+  return sandboxes[containerId]->bytes;
+}
+
+
+void DiskUsageCollectorProcess::collect()
+{
+  size_t budget = SANDBOX_USAGE_ENTRIES;
+
+  // Scan a directory of each sandbox in turn, so a huge sandbox
+  // doesn't hold up the others. A sandbox gets scanned (at most) once
+  // in full per interval.
+  std::list<ContainerID> containers = order;
+  while (budget > 0 && !containers.empty()) {
+    const ContainerID containerId = containers.front();
+    containers.pop_front();
+
+    Sandbox* sandbox = sandboxes[containerId].get();
+
+    if (sandbox->pending.empty()) {
+      sandbox->pending.push_back(""); // Start a new pass.
+    }
+
+    const string relative = sandbox->pending.front();
+    sandbox->pending.pop_front();
+
+    budget -= std::min(budget, scan(sandbox, relative));
+
+    if (sandbox->pending.empty()) {
+      sandbox->scanned = true;
+    } else {
+      containers.push_back(containerId);
+    }
+  }
+
+  if (!order.empty()) {
+    order.push_back(order.front());
+    order.pop_front();
+  }
+
+  delay(interval, self(), &Self::collect);
+}
+
+
+size_t DiskUsageCollectorProcess::scan(
+    Sandbox* sandbox,
+    const string& relative)
+{
+  const string& path = relative.empty()
+    ? sandbox->directory
+    : path::join(sandbox->directory, relative);
+
+  int fd = ::open(
+      path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+  struct stat s;
+  if (fd < 0 || ::fstat(fd, &s) < 0) {
+    // The directory was removed (or replaced) since it was listed.
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    forget(sandbox, relative);
+    return 1;
+  }
+
+  Directory* directory = &sandbox->directories[relative];
+
+  // NOTE: Modification times only have a granularity of seconds, so
+  // a directory modified in the same second it was listed might have
+  // changed after it was listed.
+  if (directory->listed.isNone() || s.st_mtime >= directory->listed.get()) {
+    relist(sandbox, relative, directory, fd);
+  }
+
+  size_t entries = 1;
+
+  // Files can grow without their directory changing, so these always
+  // get checked.
+  Bytes bytes(s.st_blocks * 512);
+  foreach (const string& file, directory->files) {
+    struct stat s;
+    if (::fstatat(fd, file.c_str(), &s, AT_SYMLINK_NOFOLLOW) == 0) {
+      bytes += Bytes(s.st_blocks * 512);
+    }
+    entries++;
+  }
+
+  ::close(fd);
+
+  sandbox->bytes += bytes;
+  sandbox->bytes -= directory->bytes;
+  directory->bytes = bytes;
+
+  foreach (const string& name, directory->directories) {
+    sandbox->pending.push_back(
+        relative.empty() ? name : path::join(relative, name));
+  }
+
+  return entries;
+}
+
+
+void DiskUsageCollectorProcess::relist(
+    Sandbox* sandbox,
+    const string& relative,
+    Directory* directory,
+    int fd)
+{
+  // Changes from here on make the directory get listed again.
+  directory->listed = ::time(NULL);
+
+  // NOTE: 'closedir' closes the duplicate, 'fd' is closed by the
+  // caller.
+  int fd_ = ::dup(fd);
+  DIR* dir = fd_ < 0 ? NULL : ::fdopendir(fd_);
+  if (dir == NULL) {
+    PLOG(WARNING) << "Failed to list '"
+                  << path::join(sandbox->directory, relative) << "'";
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    directory->listed = None();
+    return;
+  }
+
+  // NOTE: The duplicate shares the offset with 'fd', which might have
+  // been read before.
+  ::rewinddir(dir);
+
+  vector<string> files;
+  vector<string> directories;
+
+  struct dirent* entry;
+  while ((entry = ::readdir(dir)) != NULL) {
+    const string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+
+    bool isdir = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_UNKNOWN) {
+      struct stat s;
+      isdir = ::fstatat(fd, name.c_str(), &s, AT_SYMLINK_NOFOLLOW) == 0 &&
+        S_ISDIR(s.st_mode);
+    }
+
+    if (isdir) {
+      directories.push_back(name);
+    } else {
+      files.push_back(name);
+    }
+  }
+
+  ::closedir(dir);
+
+  // Forget the subdirectories that are gone.
+  foreach (const string& name, directory->directories) {
+    if (std::find(directories.begin(), directories.end(), name) ==
+        directories.end()) {
+      forget(sandbox, relative.empty() ? name : path::join(relative, name));
+    }
+  }
+
+  directory->files = files;
+  directory->directories = directories;
+}
+
+
+void DiskUsageCollectorProcess::forget(
+    Sandbox* sandbox,
+    const string& relative)
+{
+  // Collect first, erasing invalidates the iteration.
+  std::list<string> forgotten;
+  foreachkey (const string& path, sandbox->directories) {
+    if (relative.empty() ||
+        path == relative ||
+        strings::startsWith(path, relative + "/")) {
+      forgotten.push_back(path);
+    }
+  }
+
+  foreach (const string& path, forgotten) {
+    sandbox->bytes -= sandbox->directories[path].bytes;
+    sandbox->directories.erase(path);
+  }
+}
+
+
+DiskUsageCollector::DiskUsageCollector(const Duration& interval)
+{
+  process = new DiskUsageCollectorProcess(interval);
+  spawn(process);
+}
+
+
+DiskUsageCollector::~DiskUsageCollector()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+void DiskUsageCollector::watch(
+    const ContainerID& containerId,
+    const string& directory)
+{
+  dispatch(process, &DiskUsageCollectorProcess::watch, containerId, directory);
+}
+
+
+void DiskUsageCollector::unwatch(const ContainerID& containerId)
+{
+  dispatch(process, &DiskUsageCollectorProcess::unwatch, containerId);
+}
+
+
+Future<Option<Bytes> > DiskUsageCollector::usage(
+    const ContainerID& containerId)
+{
+  return dispatch(process, &DiskUsageCollectorProcess::usage, containerId);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
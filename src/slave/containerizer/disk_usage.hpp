@@ -0,0 +1,70 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __DISK_USAGE_HPP__
+#define __DISK_USAGE_HPP__
+
+#include <string>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/option.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class DiskUsageCollectorProcess;
+
+// Keeps track of the disk space used by sandboxes without walking
+// each of them in full whenever asked. Every interval a bounded
+// number of entries, across all the sandboxes, gets checked and the
+// totals of each directory are cached, so a sandbox's usage is kept
+// up to date a slice at a time. Directories that haven't changed
+// since they were last listed aren't listed again, only the files
+// in them get checked for growth.
+class DiskUsageCollector
+{
+public:
+  explicit DiskUsageCollector(const Duration& interval);
+  ~DiskUsageCollector();
+
+  // Starts tracking the disk usage of the sandbox of the container.
+  void watch(const ContainerID& containerId, const std::string& directory);
+
+  // Stops tracking the disk usage of the sandbox of the container.
+  void unwatch(const ContainerID& containerId);
+
+  // Returns the disk usage of the sandbox of the container, once it
+  // has been scanned in full at least once.
+  process::Future<Option<Bytes> > usage(const ContainerID& containerId);
+
+private:
+  DiskUsageCollectorProcess* process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __DISK_USAGE_HPP__
@@ -0,0 +1,370 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#include <list>
+#include <string>
+
+#include <process/defer.hpp>
+#include <process/dispatch.hpp>
+#include <process/owned.hpp>
+#include <process/process.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/lambda.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
+#include <stout/strings.hpp>
+
+#include "logging/logging.hpp"
+
+#include "slave/containerizer/fetcher_cache.hpp"
+#include "slave/containerizer/mesos_containerizer.hpp"
+
+using std::list;
+using std::string;
+
+using namespace process;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+class FetcherCacheProcess : public Process<FetcherCacheProcess>
+{
+public:
+  explicit FetcherCacheProcess(const Flags& _flags)
+    : flags(_flags),
+      directory(path::join(
+          flags.fetcher_cache_dir.get(flags.work_dir), "fetch")),
+      capacity(flags.fetcher_cache_size),
+      next(0),
+      hits(0),
+      misses(0),
+      evictions(0) {}
+
+  virtual ~FetcherCacheProcess() {}
+
+  virtual void initialize();
+
+  Future<string> get(const CommandInfo::URI& uri);
+  void release(const CommandInfo::URI& uri);
+  JSON::Object statistics();
+
+private:
+  struct Entry
+  {
+    Entry(const string& _key, const string& _directory)
+      : key(_key), directory(_directory), references(0) {}
+
+    const string key;
+    const string directory; // Where the URI gets fetched to.
+    Promise<string> promise; // Path of the fetched URI.
+    Bytes size;
+    size_t references;
+    list<string>::iterator lru; // Position in 'lru', once fetched.
+  };
+
+  void fetched(
+      const string& key,
+      const Future<Option<int> >& status);
+
+  void remove(const Owned<Entry>& entry);
+
+  // Evicts unused entries until we're within our capacity.
+  void evict();
+
+  const Flags flags;
+  const string directory;
+  const Bytes capacity;
+
+  hashmap<string, Owned<Entry> > entries;
+
+  // Keys of fetched entries, least recently used first.
+  list<string> lru;
+
+  Bytes size; // Total size of the fetched entries.
+
+  uint64_t next; // For naming entry directories.
+
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+};
+
+
+void FetcherCacheProcess::initialize()
+{
+  // We don't recover the cache across slave restarts, any leftovers
+  // are from a previous run.
+  // NOTE: We only ever remove the 'fetch' directory we create, never
+  // the directory given by --fetcher_cache_dir.
+  if (os::exists(directory)) {
+    Try<Nothing> rmdir = os::rmdir(directory);
+    if (rmdir.isError()) {
+      LOG(ERROR) << "Failed to remove fetcher cache directory '"
+                 << directory << "': " << rmdir.error();
+    }
+  }
+
+  Try<Nothing> mkdir = os::mkdir(directory);
+  if (mkdir.isError()) {
+    LOG(ERROR) << "Failed to create fetcher cache directory '"
+               << directory << "': " << mkdir.error();
+  }
+}
+
+
+Future<string> FetcherCacheProcess::get(const CommandInfo::URI& uri)
+{
+  const string& key_ = uri.value();
+
+  if (entries.contains(key_)) {
+    Owned<Entry> entry = entries[key_];
+    entry->references++;
+
+    // Move the entry to the back of the LRU list (if it has been
+    // fetched already, otherwise it will get added once fetched).
+    if (entry->promise.future().isReady()) {
+      lru.splice(lru.end(), lru, entry->lru);
+    }
+
+    hits++;
+    return entry->promise.future();
+  }
+
+  misses++;
+
+  Owned<Entry> entry(
+      new Entry(key_, path::join(directory, stringify(next++))));
+
+  entry->references++;
+  entries[key_] = entry;
+
+  Try<Nothing> mkdir = os::mkdir(entry->directory);
+  if (mkdir.isError()) {
+    entries.erase(key_);
+    return Failure("Failed to create fetcher cache entry '" +
+                   entry->directory + "': " + mkdir.error());
+  }
+
+  Result<string> realpath = os::realpath(
+      path::join(flags.launcher_dir, "mesos-fetcher"));
+
+  if (!realpath.isSome()) {
+    remove(entry);
+    return Failure("Could not fetch URI: failed to find mesos-fetcher");
+  }
+
+  // Fetch the URI as an executable so that mesos-fetcher doesn't try
+  // and extract it, that's done when it gets copied into a sandbox.
+  CommandInfo commandInfo;
+  commandInfo.add_uris()->set_value(uri.value());
+  commandInfo.mutable_uris(0)->set_executable(true);
+
+  string command =
+    buildCommand(commandInfo, entry->directory, None(), flags) +
+    " " + realpath.get() + " > " + entry->directory + ".log 2>&1";
+
+  LOG(INFO) << "Fetching '" << uri.value() << "' into the fetcher cache"
+            << " using command '" << command << "'";
+
+  Try<Subprocess> fetcher = subprocess(command);
+  if (fetcher.isError()) {
+    remove(entry);
+    return Failure("Failed to execute mesos-fetcher: " + fetcher.error());
+  }
+
+  fetcher.get().status()
+    .onAny(defer(self(), &Self::fetched, key_, lambda::_1));
+
+  return entry->promise.future();
+}
+
+
+void FetcherCacheProcess::fetched(
+    const string& key,
+    const Future<Option<int> >& status)
+{
+  CHECK(entries.contains(key));
+
+  Owned<Entry> entry = entries[key];
+
+  if (!status.isReady() || status.get().isNone() || status.get().get() != 0) {
+    entry->promise.fail(
+        "Failed to fetch '" + key + "' into the fetcher cache, see '" +
+        entry->directory + ".log'");
+    remove(entry);
+    return;
+  }
+
+  // We don't know up front what mesos-fetcher will name the file, but
+  // it's the only file in the entry's directory.
+  Try<list<string> > files = os::ls(entry->directory);
+  if (files.isError() || files.get().size() != 1) {
+    entry->promise.fail(
+        "Failed to find '" + key + "' in the fetcher cache: " +
+        (files.isError() ? files.error() : "Unexpected number of files"));
+    remove(entry);
+    return;
+  }
+
+  const string& path = path::join(entry->directory, files.get().front());
+
+  struct stat s;
+  if (::stat(path.c_str(), &s) < 0) {
+    entry->promise.fail(
+        "Failed to stat '" + path + "': " + string(strerror(errno)));
+    remove(entry);
+    return;
+  }
+
+  entry->size = Bytes(s.st_size);
+  entry->lru = lru.insert(lru.end(), key);
+  size += entry->size;
+
+  LOG(INFO) << "Cached '" << key << "' (" << entry->size << ") at '"
+            << path << "'";
+
+  entry->promise.set(path);
+
+  evict();
+}
+
+
+void FetcherCacheProcess::release(const CommandInfo::URI& uri)
+{
+  const string& key_ = uri.value();
+
+  if (!entries.contains(key_)) {
+    return; // The fetch must have failed.
+  }
+
+  Owned<Entry> entry = entries[key_];
+
+  CHECK(entry->references > 0);
+  entry->references--;
+
+  evict();
+}
+
+
+void FetcherCacheProcess::remove(const Owned<Entry>& entry)
+{
+  if (entry->promise.future().isReady()) {
+    lru.erase(entry->lru);
+    size -= entry->size;
+  }
+
+  entries.erase(entry->key);
+
+  // Copies in sandboxes are hard links or copies so it's safe to
+  // remove the cached copy even if it has been used.
+  Try<Nothing> rmdir = os::rmdir(entry->directory);
+  if (rmdir.isError()) {
+    LOG(ERROR) << "Failed to remove fetcher cache entry '"
+               << entry->directory << "': " << rmdir.error();
+  }
+
+  os::rm(entry->directory + ".log");
+}
+
+
+void FetcherCacheProcess::evict()
+{
+  list<string>::iterator iterator = lru.begin();
+
+  while (size > capacity && iterator != lru.end()) {
+    Owned<Entry> entry = entries[*iterator];
+    ++iterator; // Before 'remove' invalidates it.
+
+    if (entry->references == 0) {
+      VLOG(1) << "Evicting '" << entry->key << "' from the fetcher cache";
+      remove(entry);
+      evictions++;
+    }
+  }
+}
+
+
+JSON::Object FetcherCacheProcess::statistics()
+{
+  JSON::Object object;
+  object.values["fetcher_cache_hits"] = hits;
+  object.values["fetcher_cache_misses"] = misses;
+  object.values["fetcher_cache_evictions"] = evictions;
+  object.values["fetcher_cache_size_bytes"] = size.bytes();
+  return object;
+}
+
+
+FetcherCache::FetcherCache(const Flags& flags)
+{
+  process = new FetcherCacheProcess(flags);
+  spawn(process);
+}
+
+
+FetcherCache::~FetcherCache()
+{
+  terminate(process);
+  wait(process);
+  delete process;
+}
+
+
+bool FetcherCache::cacheable(const CommandInfo::URI& uri)
+{
+  return strings::startsWith(uri.value(), "hdfs://") ||
+    strings::startsWith(uri.value(), "hftp://") ||
+    strings::startsWith(uri.value(), "http://") ||
+    strings::startsWith(uri.value(), "https://") ||
+    strings::startsWith(uri.value(), "ftp://") ||
+    strings::startsWith(uri.value(), "ftps://");
+}
+
+
+Future<string> FetcherCache::get(const CommandInfo::URI& uri)
+{
+  return dispatch(process, &FetcherCacheProcess::get, uri);
+}
+
+
+void FetcherCache::release(const CommandInfo::URI& uri)
+{
+  dispatch(process, &FetcherCacheProcess::release, uri);
+}
+
+
+Future<JSON::Object> FetcherCache::statistics()
+{
+  return dispatch(process, &FetcherCacheProcess::statistics);
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,75 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __FETCHER_CACHE_HPP__
+#define __FETCHER_CACHE_HPP__
+
+#include <string>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+
+#include <stout/json.hpp>
+
+#include "slave/flags.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// Forward declaration.
+class FetcherCacheProcess;
+
+// A slave wide cache of executor URIs. A URI is identified by its
+// value and is fetched at most once, using mesos-fetcher, no matter
+// how many executors ask for it concurrently. Hence a URI whose
+// contents change needs a new value (e.g., a versioned path) to not
+// be served stale. The cached copies are kept in the cache directory
+// until the total size of the cache exceeds the configured capacity,
+// at which point the least recently used ones that are no longer
+// being used by any executor get evicted.
+class FetcherCache
+{
+public:
+  explicit FetcherCache(const Flags& flags);
+  ~FetcherCache();
+
+  // Returns true if the URI gets fetched remotely (i.e., from HDFS,
+  // HTTP(S) or FTP(S)) and hence is worth caching.
+  static bool cacheable(const CommandInfo::URI& uri);
+
+  // Returns the path of the cached copy of the URI, fetching it first
+  // if necessary. The copy is not evicted until 'release' is called.
+  process::Future<std::string> get(const CommandInfo::URI& uri);
+
+  // Releases a copy previously returned by 'get'.
+  void release(const CommandInfo::URI& uri);
+
+  // Returns the cache counters (hits, misses, evictions and size).
+  process::Future<JSON::Object> statistics();
+
+private:
+  FetcherCacheProcess* process;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __FETCHER_CACHE_HPP__
@@ -58,14 +58,26 @@ namespace slave {
 // CPU subsystem constants.
 const uint64_t CPU_SHARES_PER_CPU = 1024;
 const uint64_t MIN_CPU_SHARES = 10;
-const Duration CPU_CFS_PERIOD = Milliseconds(100); // Linux default.
+const Duration MIN_CPU_CFS_PERIOD = Milliseconds(1); // Linux minimum.
+const Duration MAX_CPU_CFS_PERIOD = Seconds(1); // Linux maximum.
 const Duration MIN_CPU_CFS_QUOTA = Milliseconds(1);
 
 
 CgroupsCpushareIsolatorProcess::CgroupsCpushareIsolatorProcess(
     const Flags& _flags,
     const hashmap<string, string>& _hierarchies)
-  : flags(_flags), hierarchies(_hierarchies) {}
+  : flags(_flags), hierarchies(_hierarchies)
+{
+  // NOTE: The subsystems might be co-mounted (e.g., 'cpu,cpuacct'),
+  // in which case they share a hierarchy and hence a pool, otherwise
+  // each pool would take the other's cgroups for orphans.
+  foreachvalue (const string& hierarchy, hierarchies) {
+    if (!pools.contains(hierarchy)) {
+      pools[hierarchy] = Owned<cgroups::Pool>(new cgroups::Pool(
+          hierarchy, flags.cgroups_root, flags.cgroups_pool_size));
+    }
+  }
+}
 
 
 CgroupsCpushareIsolatorProcess::~CgroupsCpushareIsolatorProcess() {}
@@ -99,6 +111,14 @@ Try<Isolator*> CgroupsCpushareIsolatorProcess::create(
       return Error("Failed to find 'cpu.cfs_quota_us'. Your kernel "
                    "might be too old to use the CFS cgroups feature.");
     }
+
+    if (flags.cgroups_cfs_period < MIN_CPU_CFS_PERIOD ||
+        flags.cgroups_cfs_period > MAX_CPU_CFS_PERIOD) {
+      return Error("Invalid CFS period " +
+                   stringify(flags.cgroups_cfs_period) + ", it has to be"
+                   " between " + stringify(MIN_CPU_CFS_PERIOD) + " and " +
+                   stringify(MAX_CPU_CFS_PERIOD));
+    }
   }
 
   process::Owned<IsolatorProcess> process(
@@ -164,7 +184,8 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::recover(
   }
 
   foreach (const string& orphan, orphans.get()) {
-    if (!cgroups.contains(orphan)) {
+    if (!cgroups.contains(orphan) &&
+        !pools[hierarchies["cpu"]]->contains(orphan)) {
       LOG(INFO) << "Removing orphaned cgroup"
                 << " '" << path::join("cpu", orphan) << "'";
       cgroups::destroy(hierarchies["cpu"], orphan);
@@ -182,7 +203,8 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::recover(
   }
 
   foreach (const string& orphan, orphans.get()) {
-    if (!cgroups.contains(orphan)) {
+    if (!cgroups.contains(orphan) &&
+        !pools[hierarchies["cpuacct"]]->contains(orphan)) {
       LOG(INFO) << "Removing orphaned cgroup"
                 << " '" << path::join("cpuacct", orphan) << "'";
       cgroups::destroy(hierarchies["cpuacct"], orphan);
@@ -218,7 +240,7 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::prepare(
   }
 
   if (!exists.get()) {
-    Try<Nothing> create = cgroups::create(hierarchies["cpu"], info->cgroup);
+    Try<Nothing> create = pools[hierarchies["cpu"]]->create(info->cgroup);
     if (create.isError()) {
       return Failure("Failed to prepare isolator: " + create.error());
     }
@@ -236,7 +258,7 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::prepare(
   }
 
   if (!exists.get()) {
-    Try<Nothing> create = cgroups::create(hierarchies["cpuacct"], info->cgroup);
+    Try<Nothing> create = pools[hierarchies["cpuacct"]]->create(info->cgroup);
     if (create.isError()) {
       return Failure("Failed to prepare isolator: " + create.error());
     }
@@ -333,14 +355,15 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::update(
 
   // Set cfs quota if enabled.
   if (flags.cgroups_enable_cfs) {
-    write = cgroups::cpu::cfs_period_us(
-        hierarchy.get(), info->cgroup, CPU_CFS_PERIOD);
+    const Duration& period = flags.cgroups_cfs_period;
+
+    write = cgroups::cpu::cfs_period_us(hierarchy.get(), info->cgroup, period);
 
     if (write.isError()) {
       return Failure("Failed to update 'cpu.cfs_period_us': " + write.error());
     }
 
-    Duration quota = std::max(CPU_CFS_PERIOD * cpus, MIN_CPU_CFS_QUOTA);
+    Duration quota = std::max(period * cpus, MIN_CPU_CFS_QUOTA);
 
     write = cgroups::cpu::cfs_quota_us(hierarchy.get(), info->cgroup, quota);
 
@@ -348,7 +371,7 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::update(
       return Failure("Failed to update 'cpu.cfs_quota_us': " + write.error());
     }
 
-    LOG(INFO) << "Updated 'cpu.cfs_period_us' to " << CPU_CFS_PERIOD
+    LOG(INFO) << "Updated 'cpu.cfs_period_us' to " << period
               << " and 'cpu.cfs_quota_us' to " << quota
               << " (cpus " << cpus << ")"
               << " for container " << containerId;
@@ -375,44 +398,45 @@ Future<ResourceStatistics> CgroupsCpushareIsolatorProcess::usage(
   PCHECK(ticks > 0) << "Failed to get sysconf(_SC_CLK_TCK)";
 
   // Add the cpuacct.stat information.
-  Try<hashmap<string, uint64_t> > stat =
-    cgroups::stat(hierarchies["cpuacct"], info->cgroup, "cpuacct.stat");
-
-  if (stat.isError()) {
-    return Failure("Failed to read cpuacct.stat: " + stat.error());
+  Try<cgroups::Reader*> reader = this->reader(info, "cpuacct", "cpuacct.stat");
+  if (reader.isError()) {
+    return Failure("Failed to read cpuacct.stat: " + reader.error());
   }
 
-  // TODO(bmahler): Add namespacing to cgroups to enforce the expected
-  // structure, e.g., cgroups::cpuacct::stat.
-  Option<uint64_t> user = stat.get().get("user");
-  Option<uint64_t> system = stat.get().get("system");
+  Try<cgroups::cpuacct::Stat> cpuacct = cgroups::cpuacct::stat(reader.get());
+  if (cpuacct.isError()) {
+    return Failure("Failed to read cpuacct.stat: " + cpuacct.error());
+  }
 
-  if (user.isSome() && system.isSome()) {
-    result.set_cpus_user_time_secs((double) user.get() / (double) ticks);
-    result.set_cpus_system_time_secs((double) system.get() / (double) ticks);
+  if (cpuacct.get().user.isSome() && cpuacct.get().system.isSome()) {
+    result.set_cpus_user_time_secs(
+        (double) cpuacct.get().user.get() / (double) ticks);
+    result.set_cpus_system_time_secs(
+        (double) cpuacct.get().system.get() / (double) ticks);
   }
 
   // Add the cpu.stat information.
-  stat = cgroups::stat(hierarchies["cpu"], info->cgroup, "cpu.stat");
+  reader = this->reader(info, "cpu", "cpu.stat");
+  if (reader.isError()) {
+    return Failure("Failed to read cpu.stat: " + reader.error());
+  }
 
-  if (stat.isError()) {
-    return Failure("Failed to read cpu.stat: " + stat.error());
+  Try<cgroups::cpu::Stat> cpu = cgroups::cpu::stat(reader.get());
+  if (cpu.isError()) {
+    return Failure("Failed to read cpu.stat: " + cpu.error());
   }
 
-  Option<uint64_t> nr_periods = stat.get().get("nr_periods");
-  if (nr_periods.isSome()) {
-    result.set_cpus_nr_periods(nr_periods.get());
+  if (cpu.get().nr_periods.isSome()) {
+    result.set_cpus_nr_periods(cpu.get().nr_periods.get());
   }
 
-  Option<uint64_t> nr_throttled = stat.get().get("nr_throttled");
-  if (nr_throttled.isSome()) {
-    result.set_cpus_nr_throttled(nr_throttled.get());
+  if (cpu.get().nr_throttled.isSome()) {
+    result.set_cpus_nr_throttled(cpu.get().nr_throttled.get());
   }
 
-  Option<uint64_t> throttled_time = stat.get().get("throttled_time");
-  if (throttled_time.isSome()) {
+  if (cpu.get().throttled_time.isSome()) {
     result.set_cpus_throttled_time_secs(
-        Nanoseconds(throttled_time.get()).secs());
+        Nanoseconds(cpu.get().throttled_time.get()).secs());
   }
 
   return result;
@@ -428,6 +452,8 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::cleanup(
 
   Info* info = CHECK_NOTNULL(infos[containerId]);
 
+  info->readers.clear();
+
   list<Future<bool> > futures;
   futures.push_back(cgroups::destroy(hierarchies["cpu"], info->cgroup));
   futures.push_back(cgroups::destroy(hierarchies["cpuacct"], info->cgroup));
@@ -439,6 +465,26 @@ Future<Nothing> CgroupsCpushareIsolatorProcess::cleanup(
 }
 
 
+Try<cgroups::Reader*> CgroupsCpushareIsolatorProcess::reader(
+    Info* info,
+    const string& subsystem,
+    const string& control)
+{
+  if (!info->readers.contains(control)) {
+    Try<cgroups::Reader*> reader =
+      cgroups::Reader::create(hierarchies[subsystem], info->cgroup, control);
+
+    if (reader.isError()) {
+      return Error(reader.error());
+    }
+
+    info->readers[control] = Owned<cgroups::Reader>(reader.get());
+  }
+
+  return info->readers[control].get();
+}
+
+
 Future<Nothing> CgroupsCpushareIsolatorProcess::_cleanup(
     const ContainerID& containerId)
 {
@@ -22,10 +22,13 @@
 #include <mesos/resources.hpp>
 
 #include <process/future.hpp>
+#include <process/owned.hpp>
 
 #include <stout/hashmap.hpp>
 #include <stout/try.hpp>
 
+#include "linux/cgroups.hpp"
+
 #include "slave/containerizer/isolator.hpp"
 
 #include "slave/flags.hpp"
@@ -87,13 +90,27 @@ private:
     Option<pid_t> pid;
 
     process::Promise<Limitation> limitation;
+
+    // Readers of the statistics control files, keyed by control
+    // file, which are kept open between calls to 'usage'.
+    hashmap<std::string, process::Owned<cgroups::Reader> > readers;
   };
 
+  // Returns the reader of the control file of the container's cgroup
+  // in the hierarchy of the subsystem.
+  Try<cgroups::Reader*> reader(
+      Info* info,
+      const std::string& subsystem,
+      const std::string& control);
+
   const Flags flags;
 
   // Map from subsystem to hierarchy.
   hashmap<std::string, std::string> hierarchies;
 
+  // Map from hierarchy to the pool its cgroups get created from.
+  hashmap<std::string, process::Owned<cgroups::Pool> > pools;
+
   hashmap<ContainerID, Info*> infos;
 };
 
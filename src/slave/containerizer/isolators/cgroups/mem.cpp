@@ -25,6 +25,7 @@
 
 #include <process/collect.hpp>
 #include <process/defer.hpp>
+#include <process/delay.hpp>
 #include <process/pid.hpp>
 
 #include <stout/bytes.hpp>
@@ -35,7 +36,9 @@
 #include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/nothing.hpp>
+#include <stout/os.hpp>
 #include <stout/stringify.hpp>
+#include <stout/strings.hpp>
 #include <stout/try.hpp>
 
 #include "common/type_utils.hpp"
@@ -58,11 +61,19 @@ namespace slave {
 // Memory subsystem constants.
 const Bytes MIN_MEMORY = Megabytes(32);
 
+// The levels of memory pressure events, see memory.pressure_level.
+static const char* PRESSURE_LEVELS[] = { "low", "medium", "critical" };
+
 
 CgroupsMemIsolatorProcess::CgroupsMemIsolatorProcess(
     const Flags& _flags,
-    const string& _hierarchy)
-  : flags(_flags), hierarchy(_hierarchy) {}
+    const string& _hierarchy,
+    bool _pressure)
+  : flags(_flags),
+    hierarchy(_hierarchy),
+    pressure(_pressure),
+    pool(new cgroups::Pool(
+        hierarchy, flags.cgroups_root, flags.cgroups_pool_size)) {}
 
 
 CgroupsMemIsolatorProcess::~CgroupsMemIsolatorProcess() {}
@@ -94,13 +105,37 @@ Try<Isolator*> CgroupsMemIsolatorProcess::create(const Flags& flags)
     return Error("Failed to update memory.oom_control");
   }
 
+  // Memory pressure notifications are only supported since 3.10.
+  exists = cgroups::exists(
+      hierarchy.get(), flags.cgroups_root, "memory.pressure_level");
+  if (exists.isError()) {
+    return Error(
+        "Failed to determine if 'memory.pressure_level' control exists: " +
+        exists.error());
+  }
+
+  if (!exists.get()) {
+    LOG(WARNING) << "Not counting memory pressure events: "
+                 << "'memory.pressure_level' is not supported by the kernel";
+  }
+
   process::Owned<IsolatorProcess> process(
-      new CgroupsMemIsolatorProcess(flags, hierarchy.get()));
+      new CgroupsMemIsolatorProcess(flags, hierarchy.get(), exists.get()));
 
   return new Isolator(process);
 }
 
 
+void CgroupsMemIsolatorProcess::initialize()
+{
+  if (flags.cgroups_share_memory_slack) {
+    delay(flags.resource_monitoring_interval,
+          PID<CgroupsMemIsolatorProcess>(this),
+          &CgroupsMemIsolatorProcess::share);
+  }
+}
+
+
 Future<Nothing> CgroupsMemIsolatorProcess::recover(
     const list<state::RunState>& states)
 {
@@ -145,6 +180,12 @@ Future<Nothing> CgroupsMemIsolatorProcess::recover(
     cgroups.insert(info->cgroup);
 
     oomListen(containerId);
+
+    if (pressure) {
+      foreach (const char* level, PRESSURE_LEVELS) {
+        pressureListen(containerId, level);
+      }
+    }
   }
 
   Try<vector<string> > orphans = cgroups::get(
@@ -158,7 +199,7 @@ Future<Nothing> CgroupsMemIsolatorProcess::recover(
   }
 
   foreach (const string& orphan, orphans.get()) {
-    if (!cgroups.contains(orphan)) {
+    if (!cgroups.contains(orphan) && !pool->contains(orphan)) {
       LOG(INFO) << "Removing orphaned cgroup '" << orphan << "'";
       cgroups::destroy(hierarchy, orphan);
     }
@@ -193,7 +234,7 @@ Future<Nothing> CgroupsMemIsolatorProcess::prepare(
   }
 
   if (!exists.get()) {
-    Try<Nothing> create = cgroups::create(hierarchy, info->cgroup);
+    Try<Nothing> create = pool->create(info->cgroup);
     if (create.isError()) {
       return Failure("Failed to prepare isolator: " + create.error());
     }
@@ -201,6 +242,12 @@ Future<Nothing> CgroupsMemIsolatorProcess::prepare(
 
   oomListen(containerId);
 
+  if (pressure) {
+    foreach (const char* level, PRESSURE_LEVELS) {
+      pressureListen(containerId, level);
+    }
+  }
+
   return update(containerId, executorInfo.resources());
 }
 
@@ -261,6 +308,8 @@ Future<Nothing> CgroupsMemIsolatorProcess::update(
   Bytes mem = resources.mem().get();
   Bytes limit = std::max(mem, MIN_MEMORY);
 
+  info->allocation = limit;
+
   // Always set the soft limit.
   Try<Nothing> write =
     cgroups::memory::soft_limit_in_bytes(hierarchy, info->cgroup, limit);
@@ -322,35 +371,45 @@ Future<ResourceStatistics> CgroupsMemIsolatorProcess::usage(
   // The rss from memory.stat is wrong in two dimensions:
   //   1. It does not include child cgroups.
   //   2. It does not include any file backed pages.
-  Try<Bytes> usage = cgroups::memory::usage_in_bytes(hierarchy, info->cgroup);
+  Try<cgroups::Reader*> reader = this->reader(info, "memory.usage_in_bytes");
+  if (reader.isError()) {
+    return Failure("Failed to read memory.usage_in_bytes: " + reader.error());
+  }
+
+  Try<uint64_t> usage = reader.get()->value();
   if (usage.isError()) {
     return Failure("Failed to parse memory.usage_in_bytes: " + usage.error());
   }
 
-  // TODO(bmahler): Add namespacing to cgroups to enforce the expected
-  // structure, e.g, cgroups::memory::stat.
-  result.set_mem_rss_bytes(usage.get().bytes());
+  result.set_mem_rss_bytes(usage.get());
 
-  Try<hashmap<string, uint64_t> > stat =
-    cgroups::stat(hierarchy, info->cgroup, "memory.stat");
+  reader = this->reader(info, "memory.stat");
+  if (reader.isError()) {
+    return Failure("Failed to read memory.stat: " + reader.error());
+  }
 
+  Try<cgroups::memory::Stat> stat = cgroups::memory::stat(reader.get());
   if (stat.isError()) {
     return Failure("Failed to read memory.stat: " + stat.error());
   }
 
-  Option<uint64_t> total_cache = stat.get().get("total_cache");
-  if (total_cache.isSome()) {
-    result.set_mem_file_bytes(total_cache.get());
+  if (stat.get().total_cache.isSome()) {
+    result.set_mem_file_bytes(stat.get().total_cache.get());
   }
 
-  Option<uint64_t> total_rss = stat.get().get("total_rss");
-  if (total_rss.isSome()) {
-    result.set_mem_anon_bytes(total_rss.get());
+  if (stat.get().total_rss.isSome()) {
+    result.set_mem_anon_bytes(stat.get().total_rss.get());
   }
 
-  Option<uint64_t> total_mapped_file = stat.get().get("total_mapped_file");
-  if (total_mapped_file.isSome()) {
-    result.set_mem_mapped_file_bytes(total_mapped_file.get());
+  if (stat.get().total_mapped_file.isSome()) {
+    result.set_mem_mapped_file_bytes(stat.get().total_mapped_file.get());
+  }
+
+  if (pressure) {
+    result.set_mem_low_pressure_counter(info->pressureCounters["low"]);
+    result.set_mem_medium_pressure_counter(info->pressureCounters["medium"]);
+    result.set_mem_critical_pressure_counter(
+        info->pressureCounters["critical"]);
   }
 
   return result;
@@ -370,6 +429,11 @@ Future<Nothing> CgroupsMemIsolatorProcess::cleanup(
     info->oomNotifier.discard();
   }
 
+  // Unregisters the listeners, discarding their pending listens.
+  info->pressureListeners.clear();
+
+  info->readers.clear();
+
   return cgroups::destroy(hierarchy, info->cgroup)
     .then(defer(PID<CgroupsMemIsolatorProcess>(this),
                 &CgroupsMemIsolatorProcess::_cleanup,
@@ -377,6 +441,25 @@ Future<Nothing> CgroupsMemIsolatorProcess::cleanup(
 }
 
 
+Try<cgroups::Reader*> CgroupsMemIsolatorProcess::reader(
+    Info* info,
+    const string& control)
+{
+  if (!info->readers.contains(control)) {
+    Try<cgroups::Reader*> reader =
+      cgroups::Reader::create(hierarchy, info->cgroup, control);
+
+    if (reader.isError()) {
+      return Error(reader.error());
+    }
+
+    info->readers[control] = Owned<cgroups::Reader>(reader.get());
+  }
+
+  return info->readers[control].get();
+}
+
+
 Future<Nothing> CgroupsMemIsolatorProcess::_cleanup(
     const ContainerID& containerId)
 {
@@ -498,6 +581,125 @@ void CgroupsMemIsolatorProcess::oom(const ContainerID& containerId)
   info->limitation.set(Limitation(mem, message.str()));
 }
 
+
+void CgroupsMemIsolatorProcess::pressureListen(
+    const ContainerID& containerId,
+    const string& level)
+{
+  CHECK(infos.contains(containerId));
+  Info* info = CHECK_NOTNULL(infos[containerId]);
+
+  // NOTE: Each listener counts the events of its level and above.
+  if (!info->pressureListeners.contains(level)) {
+    Try<cgroups::Listener*> listener = cgroups::Listener::create(
+        hierarchy, info->cgroup, "memory.pressure_level", level);
+
+    if (listener.isError()) {
+      LOG(ERROR) << "Failed to listen on " << level << " memory pressure"
+                 << " events for container " << containerId << ": "
+                 << listener.error();
+      return;
+    }
+
+    info->pressureListeners[level] =
+      Owned<cgroups::Listener>(listener.get());
+  }
+
+  info->pressureListeners[level]->listen().onAny(defer(
+      PID<CgroupsMemIsolatorProcess>(this),
+      &CgroupsMemIsolatorProcess::pressured,
+      containerId,
+      level,
+      lambda::_1));
+}
+
+
+void CgroupsMemIsolatorProcess::pressured(
+    const ContainerID& containerId,
+    const string& level,
+    const Future<uint64_t>& future)
+{
+  if (future.isDiscarded() || !infos.contains(containerId)) {
+    return; // The container is being (or has been) cleaned up.
+  }
+
+  if (future.isFailed()) {
+    LOG(ERROR) << "Listening on " << level << " memory pressure events"
+               << " failed for container " << containerId << ": "
+               << future.failure();
+    return;
+  }
+
+  Info* info = CHECK_NOTNULL(infos[containerId]);
+
+  // The counter of the eventfd holds the number of events since it
+  // was last read, so none get lost between listens.
+  info->pressureCounters[level] += future.get();
+
+  VLOG(1) << "Observed " << future.get() << " " << level
+          << " memory pressure events for container " << containerId;
+
+  pressureListen(containerId, level);
+}
+
+
+void CgroupsMemIsolatorProcess::share()
+{
+  Try<os::Memory> memory = os::memory();
+  if (memory.isError()) {
+    LOG(WARNING) << "Failed to get the free memory of the host: "
+                 << memory.error();
+  } else if (!infos.empty()) {
+    // Keep half of the free memory in reserve, e.g., for containers
+    // that are about to be launched.
+    const Bytes slack(memory.get().free.bytes() / 2 / infos.size());
+
+    foreachvalue (Info* info, infos) {
+      if (info->pid.isNone()) {
+        continue; // Still being launched.
+      }
+
+      Try<Bytes> usage =
+        cgroups::memory::usage_in_bytes(hierarchy, info->cgroup);
+
+      Try<Bytes> current =
+        cgroups::memory::limit_in_bytes(hierarchy, info->cgroup);
+
+      if (usage.isError() || current.isError()) {
+        VLOG(1) << "Failed to read the memory usage and limit of container "
+                << info->containerId << ": "
+                << (usage.isError() ? usage.error() : current.error());
+        continue;
+      }
+
+      // Never lower the hard limit below what the container is using,
+      // which would have the kernel reclaim from (or OOM kill) the
+      // container right away, and don't rewrite an unchanged limit.
+      // The soft limit stays at the allocation so that the kernel
+      // reclaims memory from the containers using more than their
+      // allocation first when memory gets short.
+      const Bytes limit = std::max(info->allocation + slack, usage.get());
+
+      if (limit == current.get()) {
+        continue;
+      }
+
+      Try<Nothing> write =
+        cgroups::memory::limit_in_bytes(hierarchy, info->cgroup, limit);
+
+      if (write.isError()) {
+        VLOG(1) << "Failed to set 'memory.limit_in_bytes' to " << limit
+                << " for container " << info->containerId << ": "
+                << write.error();
+      }
+    }
+  }
+
+  delay(flags.resource_monitoring_interval,
+        PID<CgroupsMemIsolatorProcess>(this),
+        &CgroupsMemIsolatorProcess::share);
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
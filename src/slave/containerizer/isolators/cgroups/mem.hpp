@@ -24,12 +24,17 @@
 #include <mesos/resources.hpp>
 
 #include <process/future.hpp>
+#include <process/owned.hpp>
 
+#include <stout/bytes.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/try.hpp>
 
 #include "mesos/resources.hpp"
 
+#include "linux/cgroups.hpp"
+
 #include "slave/containerizer/isolator.hpp"
 
 #include "slave/flags.hpp"
@@ -70,8 +75,14 @@ public:
   virtual process::Future<Nothing> cleanup(
       const ContainerID& containerId);
 
+protected:
+  virtual void initialize();
+
 private:
-  CgroupsMemIsolatorProcess(const Flags& flags, const std::string& hierarchy);
+  CgroupsMemIsolatorProcess(
+      const Flags& flags,
+      const std::string& hierarchy,
+      bool pressure);
 
   virtual process::Future<Nothing> _cleanup(const ContainerID& containerId);
 
@@ -86,10 +97,27 @@ private:
 
     process::Promise<Limitation> limitation;
 
+    // The memory allocated to the container, i.e., its soft limit.
+    Bytes allocation;
+
     // Used to cancel the OOM listening.
     process::Future<uint64_t> oomNotifier;
+
+    // Listeners on the memory pressure events, keyed by the pressure
+    // level, which stay registered for as long as the container.
+    hashmap<std::string, process::Owned<cgroups::Listener> > pressureListeners;
+
+    // Number of memory pressure events, keyed by the pressure level.
+    hashmap<std::string, uint64_t> pressureCounters;
+
+    // Readers of the statistics control files, keyed by control
+    // file, which are kept open between calls to 'usage'.
+    hashmap<std::string, process::Owned<cgroups::Reader> > readers;
   };
 
+  // Returns the reader of the control file of the container's cgroup.
+  Try<cgroups::Reader*> reader(Info* info, const std::string& control);
+
   // Start listening on OOM events. This function will create an
   // eventfd and start polling on it.
   void oomListen(const ContainerID& containerId);
@@ -103,11 +131,32 @@ private:
   // This function is invoked when the OOM event happens.
   void oom(const ContainerID& containerId);
 
+  // Start listening on memory pressure events of the given level
+  // (i.e., "low", "medium" or "critical").
+  void pressureListen(const ContainerID& containerId, const std::string& level);
+
+  // Counts the memory pressure events and listens for the next ones.
+  void pressured(
+      const ContainerID& containerId,
+      const std::string& level,
+      const process::Future<uint64_t>& future);
+
+  // Shares the free memory of the host between the containers by
+  // raising (or lowering) their hard limits above their allocation,
+  // then schedules the next time to do so.
+  void share();
+
   const Flags flags;
 
   // The path to the cgroups subsystem hierarchy root.
   const std::string hierarchy;
 
+  // Whether the kernel supports memory pressure notifications.
+  const bool pressure;
+
+  // The pool the cgroups get created from.
+  const process::Owned<cgroups::Pool> pool;
+
   hashmap<ContainerID, Info*> infos;
 };
 
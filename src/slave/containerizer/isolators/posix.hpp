@@ -19,12 +19,17 @@
 #ifndef __POSIX_ISOLATOR_HPP__
 #define __POSIX_ISOLATOR_HPP__
 
+#include <list>
+
 #include <stout/hashmap.hpp>
-#include <stout/os/pstree.hpp>
 
 #include <process/future.hpp>
+#include <process/shared.hpp>
+
+#include "slave/flags.hpp"
 
 #include "slave/containerizer/isolator.hpp"
+#include "slave/containerizer/process_table.hpp"
 
 namespace mesos {
 namespace internal {
@@ -131,6 +136,29 @@ public:
   }
 
 protected:
+  // Samples of the process table are shared (across containers and
+  // isolators) for half the monitoring interval, i.e., the usage of
+  // all the containers sampled together comes from a single scan.
+  explicit PosixIsolatorProcess(const Flags& flags)
+    : maxAge(flags.resource_monitoring_interval / 2) {}
+
+  // Returns the processes of the container, from a (shared) snapshot
+  // of the process table.
+  Try<std::list<ProcessTable::Process> > processes(
+      const ContainerID& containerId)
+  {
+    Try<process::Shared<ProcessTable> > table =
+      ProcessTable::snapshot(maxAge);
+
+    if (table.isError()) {
+      return Error(table.error());
+    }
+
+    return table.get()->tree(pids.get(containerId).get());
+  }
+
+  const Duration maxAge;
+
   hashmap<ContainerID, pid_t> pids;
   hashmap<ContainerID,
           process::Owned<process::Promise<Limitation> > > promises;
@@ -142,7 +170,8 @@ class PosixCpuIsolatorProcess : public PosixIsolatorProcess
 public:
   static Try<Isolator*> create(const Flags& flags)
   {
-    process::Owned<IsolatorProcess> process(new PosixCpuIsolatorProcess());
+    process::Owned<IsolatorProcess> process(
+        new PosixCpuIsolatorProcess(flags));
 
     return new Isolator(process);
   }
@@ -156,32 +185,23 @@ public:
       return ResourceStatistics();
     }
 
-    Try<os::ProcessTree> tree = os::pstree(pids.get(containerId).get());
+    Try<std::list<ProcessTable::Process> > processes =
+      this->processes(containerId);
 
-    if (!tree.isSome()) {
+    if (processes.isError()) {
       return ResourceStatistics();
     }
 
     ResourceStatistics result;
 
-    std::deque<os::ProcessTree> trees;
-    trees.push_back(tree.get());
-
-    while (!trees.empty()) {
-      os::ProcessTree root = trees.front();
-
+    foreach (const ProcessTable::Process& process, processes.get()) {
       // We only show utime and stime when both are available, otherwise
       // we're exposing a partial view of the CPU times.
-      if (root.process.utime.isSome() && root.process.stime.isSome()) {
+      if (process.utime.isSome() && process.stime.isSome()) {
         result.set_cpus_user_time_secs(
-            result.cpus_user_time_secs() + root.process.utime.get().secs());
+            result.cpus_user_time_secs() + process.utime.get().secs());
         result.set_cpus_system_time_secs(
-            result.cpus_system_time_secs() + root.process.stime.get().secs());
-      }
-
-      trees.pop_front();
-      foreach (const os::ProcessTree& child, root.children) {
-        trees.push_back(child);
+            result.cpus_system_time_secs() + process.stime.get().secs());
       }
     }
 
@@ -189,7 +209,8 @@ public:
   }
 
 private:
-  PosixCpuIsolatorProcess() {}
+  explicit PosixCpuIsolatorProcess(const Flags& flags)
+    : PosixIsolatorProcess(flags) {}
 };
 
 
@@ -198,7 +219,8 @@ class PosixMemIsolatorProcess : public PosixIsolatorProcess
 public:
   static Try<Isolator*> create(const Flags& flags)
   {
-    process::Owned<IsolatorProcess> process(new PosixMemIsolatorProcess());
+    process::Owned<IsolatorProcess> process(
+        new PosixMemIsolatorProcess(flags));
 
     return new Isolator(process);
   }
@@ -212,28 +234,19 @@ public:
       return ResourceStatistics();
     }
 
-    Try<os::ProcessTree> tree = os::pstree(pids.get(containerId).get());
+    Try<std::list<ProcessTable::Process> > processes =
+      this->processes(containerId);
 
-    if (!tree.isSome()) {
+    if (processes.isError()) {
       return ResourceStatistics();
     }
 
     ResourceStatistics result;
 
-    std::deque<os::ProcessTree> trees;
-    trees.push_back(tree.get());
-
-    while (!trees.empty()) {
-      os::ProcessTree root = trees.front();
-
-      if (root.process.rss.isSome()) {
+    foreach (const ProcessTable::Process& process, processes.get()) {
+      if (process.rss.isSome()) {
         result.set_mem_rss_bytes(
-            result.mem_rss_bytes() + root.process.rss.get().bytes());
-      }
-
-      trees.pop_front();
-      foreach (const os::ProcessTree& child, root.children) {
-        trees.push_back(child);
+            result.mem_rss_bytes() + process.rss.get().bytes());
       }
     }
 
@@ -241,7 +254,8 @@ public:
   }
 
 private:
-  PosixMemIsolatorProcess() {}
+  explicit PosixMemIsolatorProcess(const Flags& flags)
+    : PosixIsolatorProcess(flags) {}
 };
 
 
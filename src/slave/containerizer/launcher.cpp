@@ -16,8 +16,14 @@
  * limitations under the License.
  */
 
+#include <signal.h>
+#include <string.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sched.h>
+#endif // __linux__
+
 #include <process/collect.hpp>
 #include <process/delay.hpp>
 #include <process/process.hpp>
@@ -41,9 +47,118 @@ namespace slave {
 using state::RunState;
 
 
+#ifdef __linux__
+// Stack of a child cloned by 'cloneVM', which is only used until the
+// child execs.
+static const size_t CLONE_STACK_SIZE = 64 * 1024;
+
+
+struct Clone
+{
+  const lambda::function<int()>* func;
+  const sigset_t* mask; // The signal mask to restore in the child.
+};
+
+
+static int cloned(void* arg)
+{
+  Clone* clone = (Clone*) arg;
+
+  // Reset the signal handlers, which belong to the parent, while all
+  // signals are blocked. This only affects the child's copy of them.
+  for (int signal = 1; signal < NSIG; signal++) {
+    struct sigaction action;
+    if (::sigaction(signal, NULL, &action) == 0 &&
+        action.sa_handler != SIG_DFL &&
+        action.sa_handler != SIG_IGN) {
+      action.sa_handler = SIG_DFL;
+      action.sa_flags = 0;
+      ::sigaction(signal, &action, NULL);
+    }
+  }
+
+  ::sigprocmask(SIG_SETMASK, clone->mask, NULL);
+
+  return (*clone->func)();
+}
+#endif // __linux__
+
+
+Try<pid_t> cloneVM(const lambda::function<int()>& func)
+{
+#ifdef __linux__
+  // Block all signals so none gets handled in the child by a handler
+  // of the parent, which might modify the parent's memory.
+  sigset_t all;
+  sigset_t mask;
+  ::sigfillset(&all);
+  ::pthread_sigmask(SIG_SETMASK, &all, &mask);
+
+  Clone clone;
+  clone.func = &func;
+  clone.mask = &mask;
+
+  // NOTE: We're suspended until the child execs (or exits), at which
+  // point it's done with its stack.
+  char* stack = new char[CLONE_STACK_SIZE];
+
+  pid_t pid = ::clone(
+      cloned,
+      stack + CLONE_STACK_SIZE, // The stack grows down.
+      CLONE_VM | CLONE_VFORK | SIGCHLD,
+      &clone);
+
+  if (pid == -1) {
+    ErrnoError error("Failed to clone");
+    delete[] stack;
+    ::pthread_sigmask(SIG_SETMASK, &mask, NULL);
+    return error;
+  }
+
+  delete[] stack;
+  ::pthread_sigmask(SIG_SETMASK, &mask, NULL);
+
+  return pid;
+#else
+  return Error("Cloning is only supported on Linux");
+#endif // __linux__
+}
+
+
+// Exits the child of 'cloneVM' with a message, which doesn't allocate
+// memory (unlike, e.g., perror).
+static void childExit(const char* message)
+{
+  while (::write(STDERR_FILENO, message, ::strlen(message)) == -1 &&
+         errno == EINTR);
+  _exit(1);
+}
+
+
+// Executed in the child of 'cloneVM'.
+static int posixChild(const lambda::function<int()>& inChild)
+{
+  if (setsid() == -1) {
+    childExit("Failed to put child in a new session\n");
+  }
+
+  // This function should exec() and therefore not return.
+  inChild();
+
+  childExit("Child failed to exec\n");
+  return 1;
+}
+
+
 Try<Launcher*> PosixLauncher::create(const Flags& flags)
 {
-  return new PosixLauncher();
+#ifndef __linux__
+  if (flags.launcher_vfork) {
+    return Error("--launcher_vfork is only supported on Linux");
+  }
+#endif // __linux__
+
+  return new PosixLauncher(flags.launcher_vfork);
 }
 
 
@@ -91,7 +206,13 @@ Try<pid_t> PosixLauncher::fork(
 
   pid_t pid;
 
-  if ((pid = ::fork()) == -1) {
+  if (vfork) {
+    Try<pid_t> cloned = cloneVM(lambda::bind(&posixChild, inChild));
+    if (cloned.isError()) {
+      return Error(cloned.error());
+    }
+    pid = cloned.get();
+  } else if ((pid = ::fork()) == -1) {
     return ErrnoError("Failed to fork");
   }
 
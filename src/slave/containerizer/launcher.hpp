@@ -54,6 +54,18 @@ public:
 };
 
 
+// Clones a child that shares the memory of the caller, like vfork, to
+// call the specified function, and returns the child's pid once the
+// child has exec'ed (or exited). No page tables get copied so this
+// takes the same time however big the caller is.
+// NOTE: The other threads of the caller keep running while the child
+// runs, so the function must not allocate memory, take locks or
+// modify any memory, i.e., it may only make system calls (using
+// memory prepared by the caller) before it execs. The child starts
+// with the signal mask of the caller and the default signal handlers.
+Try<pid_t> cloneVM(const lambda::function<int()>& func);
+
+
 // Launcher suitable for any POSIX compliant system. Uses process groups and
 // sessions to track processes in a container. POSIX states that process groups
 // cannot migrate between sessions so all processes for a container will be
@@ -74,7 +86,12 @@ public:
   virtual process::Future<Nothing> destroy(const ContainerID& containerId);
 
 private:
-  PosixLauncher() {}
+  explicit PosixLauncher(bool _vfork) : vfork(_vfork) {}
+
+  // Whether to use 'cloneVM' rather than fork, in which case the
+  // function passed to 'fork' has to be safe to call in a child that
+  // shares our memory.
+  const bool vfork;
 
   // The 'pid' is the process id of the first process and also the process
   // group id and session id.
@@ -16,11 +16,13 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <sstream>
 
 #include <process/collect.hpp>
 #include <process/defer.hpp>
 #include <process/io.hpp>
+#include <process/owned.hpp>
 #include <process/reap.hpp>
 #include <process/subprocess.hpp>
 
@@ -33,6 +35,7 @@
 
 #include "slave/containerizer/mesos_containerizer.hpp"
 
+using std::deque;
 using std::list;
 using std::map;
 using std::string;
@@ -49,6 +52,10 @@ using state::FrameworkState;
 using state::ExecutorState;
 using state::RunState;
 
+// Number of the most recent durations of each launch phase that the
+// latency percentiles are computed over.
+static const size_t LATENCY_SAMPLES = 1000;
+
 // Local function declaration/definitions.
 Future<Nothing> _nothing() { return Nothing(); }
 
@@ -155,6 +162,12 @@ Future<ResourceStatistics> MesosContainerizer::usage(
 }
 
 
+Future<JSON::Object> MesosContainerizer::statistics()
+{
+  return dispatch(process, &MesosContainerizerProcess::statistics);
+}
+
+
 Future<Containerizer::Termination> MesosContainerizer::wait(
     const ContainerID& containerId)
 {
@@ -218,6 +231,17 @@ Future<Nothing> MesosContainerizerProcess::recover(
                   << "' of framework " << framework.id;
 
         recoverable.push_back(run.get());
+
+        if (collector.get() != NULL) {
+          collector->watch(
+              containerId,
+              paths::getExecutorRunPath(
+                  flags.work_dir,
+                  state.get().id,
+                  framework.id,
+                  executor.id,
+                  containerId));
+        }
       }
     }
   }
@@ -355,9 +379,60 @@ int execute(
 }
 
 
+// The arguments of 'execve', prepared before cloning a child which
+// shares our memory and thus can't prepare them itself.
+struct Exec
+{
+  Exec(const string& _path,
+       const vector<string>& _args,
+       const map<string, string>& env)
+    : path(_path), args(_args)
+  {
+    foreachpair (const string& key, const string& value, env) {
+      environment.push_back(key + "=" + value);
+    }
+
+    foreach (const string& arg, args) {
+      argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(NULL);
+
+    foreach (const string& variable, environment) {
+      envp.push_back(const_cast<char*>(variable.c_str()));
+    }
+    envp.push_back(NULL);
+  }
+
+  const string path;
+  const vector<string> args;
+  vector<string> environment;
+  vector<char*> argv;
+  vector<char*> envp;
+};
+
+
+// This function is executed by a child cloned with 'cloneVM' (see
+// --launcher_vfork), it execs mesos-launcher which, like 'execute',
+// waits to be signalled and sets up and executes the executor.
+// NOTE: The child shares our memory so this may only make system
+// calls, without allocating memory.
+int executeLauncher(const Owned<Exec>& exec)
+{
+  execve(exec->path.c_str(), &exec->argv[0], &exec->envp[0]);
+
+  const char* message = "Failed to execute mesos-launcher\n";
+  while (write(STDERR_FILENO, message, strlen(message)) == -1 &&
+         errno == EINTR);
+  _exit(1);
+
+  // This should not be reached.
+  return -1;
+}
+
+
 // Launching an executor involves the following steps:
-// 1. Prepare the container. First call prepare on each isolator and then
-//    fetch the executor into the container sandbox.
+// 1. Prepare the container. Call prepare on each isolator while
+//    fetching the executor into the container sandbox.
 // 2. Fork the executor. The forked child is blocked from exec'ing until it has
 //    been isolated.
 // 3. Isolate the executor. Call isolate with the pid for each isolator.
@@ -385,10 +460,19 @@ Future<Nothing> MesosContainerizerProcess::launch(
   // Store the resources for usage().
   resources.put(containerId, executorInfo.resources());
 
+  if (collector.get() != NULL) {
+    collector->watch(containerId, directory);
+  }
+
   LOG(INFO) << "Starting container '" << containerId
             << "' for executor '" << executorInfo.executor_id()
             << "' of framework '" << executorInfo.framework_id() << "'";
 
+  phases[containerId] = hashmap<string, Duration>();
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
   // Prepare additional environment variables for the executor.
   const map<string, string>& env = executorEnvironment(
       executorInfo,
@@ -418,6 +502,45 @@ Future<Nothing> MesosContainerizerProcess::launch(
       pipes[0],
       pipes[1]);
 
+  if (flags.launcher_vfork) {
+    // The executor's environment is ours plus the additional ones.
+    map<string, string> environment;
+    for (char** entry = os::environ(); *entry != NULL; entry++) {
+      const string variable = *entry;
+      size_t equals = variable.find('=');
+      if (equals != string::npos) {
+        environment[variable.substr(0, equals)] = variable.substr(equals + 1);
+      }
+    }
+
+    foreachpair (const string& key, const string& value, env) {
+      environment[key] = value;
+    }
+
+    foreach (const Environment::Variable& variable,
+             executorInfo.command().environment().variables()) {
+      environment[variable.name()] = variable.value();
+    }
+
+    vector<string> args;
+    args.push_back("mesos-launcher");
+    args.push_back("--command=" + executorInfo.command().value());
+    args.push_back("--directory=" + directory);
+    if (user.isSome()) {
+      args.push_back("--user=" + user.get());
+    }
+    args.push_back("--redirect_io=" + stringify(!local));
+    args.push_back("--pipe_read=" + stringify(pipes[0]));
+    args.push_back("--pipe_write=" + stringify(pipes[1]));
+
+    Owned<Exec> exec(new Exec(
+        path::join(flags.launcher_dir, "mesos-launcher"),
+        args,
+        environment));
+
+    inChild = lambda::bind(&executeLauncher, exec);
+  }
+
   return prepare(containerId, executorInfo, directory, user)
     .then(defer(self(),
                 &Self::fork,
@@ -435,6 +558,7 @@ Future<Nothing> MesosContainerizerProcess::launch(
                 &Self::exec,
                 containerId,
                 pipes[1]))
+    .onReady(defer(self(), &Self::launched, containerId, stopwatch))
     .onAny(lambda::bind(&os::close, pipes[0]))
     .onAny(lambda::bind(&os::close, pipes[1]))
     .onFailed(defer(self(),
@@ -443,31 +567,64 @@ Future<Nothing> MesosContainerizerProcess::launch(
 }
 
 
+// Fails if any of the (completed) futures didn't succeed.
+static Future<Nothing> completed(const list<Future<Nothing> >& futures)
+{
+  foreach (const Future<Nothing>& future, futures) {
+    if (!future.isReady()) {
+      return Failure(future.isFailed() ? future.failure() : "discarded");
+    }
+  }
+
+  return Nothing();
+}
+
+
 Future<Nothing> MesosContainerizerProcess::prepare(
     const ContainerID& containerId,
     const ExecutorInfo& executorInfo,
     const string& directory,
     const Option<string>& user)
 {
+  Stopwatch stopwatch;
+  stopwatch.start();
+
   // Start preparing all isolators (in parallel).
   list<Future<Nothing> > futures;
   foreach (const Owned<Isolator>& isolator, isolators) {
     futures.push_back(isolator->prepare(containerId, executorInfo));
   }
 
-  // Wait for all isolators to complete preparations then fetch the executor.
-  return collect(futures)
-    .then(defer(
-          self(),
-          &Self::fetch,
-          containerId,
-          executorInfo.command(),
-          directory,
-          user));
+  // NOTE: We wait for all of them to complete (rather than failing
+  // as soon as one does) so that the container doesn't get destroyed
+  // while some are still being prepared.
+  Future<Nothing> prepared = await(futures)
+    .then(lambda::bind(&completed, lambda::_1));
+
+  prepared.onReady(
+      defer(self(), &Self::phased, containerId, string("prepare"), stopwatch));
+
+  // Fetch the executor while the isolators are being prepared. This
+  // is safe because the fetcher runs outside of the container and
+  // the isolators don't touch the sandbox when preparing.
+  Future<Nothing> fetched =
+    fetch(containerId, executorInfo.command(), directory, user);
+
+  fetched.onReady(
+      defer(self(), &Self::phased, containerId, string("fetch"), stopwatch));
+
+  list<Future<Nothing> > prepares;
+  prepares.push_back(prepared);
+  prepares.push_back(fetched);
+
+  // Likewise, don't fail until both the isolators are prepared and
+  // the fetcher is done writing to the sandbox.
+  return await(prepares)
+    .then(lambda::bind(&completed, lambda::_1));
 }
 
 
-Future<Nothing> _fetch(
+Future<Nothing> fetched(
     const ContainerID& containerId,
     const Option<int>& status)
 {
@@ -486,6 +643,89 @@ Future<Nothing> MesosContainerizerProcess::fetch(
     const CommandInfo& commandInfo,
     const string& directory,
     const Option<string>& user)
+{
+  if (cache.get() == NULL) {
+    return __fetch(containerId, commandInfo, directory, user);
+  }
+
+  // Get the cacheable URIs into the fetcher cache first.
+  list<Future<string> > cached;
+  foreach (const CommandInfo::URI& uri, commandInfo.uris()) {
+    if (FetcherCache::cacheable(uri)) {
+      cached.push_back(cache->get(uri));
+    }
+  }
+
+  return await(cached)
+    .then(defer(self(),
+                &Self::_fetch,
+                containerId,
+                commandInfo,
+                directory,
+                user,
+                lambda::_1));
+}
+
+
+Future<Nothing> MesosContainerizerProcess::_fetch(
+    const ContainerID& containerId,
+    const CommandInfo& commandInfo,
+    const string& directory,
+    const Option<string>& user,
+    const list<Future<string> >& cached)
+{
+  // Fetch the cached URIs from the cache (using their local path).
+  CommandInfo commandInfo_ = commandInfo;
+  list<Future<string> >::const_iterator iterator = cached.begin();
+
+  // Only the URIs that made it into the cache hold a reference to
+  // their copy, failed ones have already been removed from the cache.
+  list<CommandInfo::URI> reserved;
+
+  Option<string> error;
+  for (int i = 0; i < commandInfo_.uris_size(); i++) {
+    CommandInfo::URI* uri = commandInfo_.mutable_uris(i);
+    if (!FetcherCache::cacheable(*uri)) {
+      continue;
+    }
+
+    CHECK(iterator != cached.end());
+    const Future<string>& path = *iterator++;
+
+    if (path.isReady()) {
+      reserved.push_back(*uri);
+      uri->set_value(path.get());
+    } else {
+      error = path.isFailed() ? path.failure() : "discarded";
+    }
+  }
+
+  if (error.isSome()) {
+    release(reserved);
+    return Failure("Failed to fetch URIs for container '" +
+                   stringify(containerId) + "': " + error.get());
+  }
+
+  return __fetch(containerId, commandInfo_, directory, user)
+    .onAny(defer(self(), &Self::release, reserved));
+}
+
+
+void MesosContainerizerProcess::release(const list<CommandInfo::URI>& uris)
+{
+  CHECK_NOTNULL(cache.get());
+
+  foreach (const CommandInfo::URI& uri, uris) {
+    cache->release(uri);
+  }
+}
+
+
+Future<Nothing> MesosContainerizerProcess::__fetch(
+    const ContainerID& containerId,
+    const CommandInfo& commandInfo,
+    const string& directory,
+    const Option<string>& user)
 {
   // Determine path for mesos-fetcher.
   Result<string> realpath = os::realpath(
@@ -573,7 +813,7 @@ Future<Nothing> MesosContainerizerProcess::fetch(
     .onAny(lambda::bind(&os::close, err.get()));
 
   return fetcher.get().status()
-    .then(lambda::bind(&_fetch, containerId, lambda::_1));
+    .then(lambda::bind(&fetched, containerId, lambda::_1));
 }
 
 
@@ -585,6 +825,9 @@ Future<pid_t> MesosContainerizerProcess::fork(
     bool checkpoint,
     int pipeRead)
 {
+  Stopwatch stopwatch;
+  stopwatch.start();
+
   Try<pid_t> forked = launcher->fork(containerId, inChild);
 
   if (forked.isError()) {
@@ -621,6 +864,8 @@ Future<pid_t> MesosContainerizerProcess::fork(
   statuses.put(containerId, status);
   status.onAny(defer(self(), &Self::reaped, containerId));
 
+  phased(containerId, "fork", stopwatch);
+
   return pid;
 }
 
@@ -635,6 +880,9 @@ Future<Nothing> MesosContainerizerProcess::isolate(
       .onAny(defer(self(), &Self::limited, containerId, lambda::_1));
   }
 
+  Stopwatch stopwatch;
+  stopwatch.start();
+
   // Isolate the executor with each isolator and get optional additional
   // commands to be run in the containerized context.
   list<Future<Option<CommandInfo> > > futures;
@@ -644,6 +892,11 @@ Future<Nothing> MesosContainerizerProcess::isolate(
 
   // Wait for all isolators to complete then run additional commands.
   return collect(futures)
+    .onReady(defer(self(),
+                   &Self::phased,
+                   containerId,
+                   string("isolate"),
+                   stopwatch))
     .then(defer(self(), &Self::_isolate, containerId, lambda::_1));
 }
 
@@ -753,6 +1006,24 @@ Future<ResourceStatistics> _usage(
     if (cpus.isSome()) {
       result.set_cpus_limit(cpus.get());
     }
+
+    Option<Bytes> disk = resources.get().disk();
+    if (disk.isSome()) {
+      result.set_disk_limit_bytes(disk.get().bytes());
+    }
+  }
+
+  return result;
+}
+
+
+// Converts the disk usage of a sandbox into resource statistics.
+ResourceStatistics diskUsage(const Option<Bytes>& usage)
+{
+  ResourceStatistics result;
+
+  if (usage.isSome()) {
+    result.set_disk_used_bytes(usage.get().bytes());
   }
 
   return result;
@@ -771,6 +1042,11 @@ Future<ResourceStatistics> MesosContainerizerProcess::usage(
     futures.push_back(isolator->usage(containerId));
   }
 
+  if (collector.get() != NULL) {
+    futures.push_back(collector->usage(containerId)
+                        .then(lambda::bind(&diskUsage, lambda::_1)));
+  }
+
   // Use await() here so we can return partial usage statistics.
   // TODO(idownes): After recovery resources won't be known until after an
   // update() because they aren't part of the SlaveState.
@@ -780,6 +1056,46 @@ Future<ResourceStatistics> MesosContainerizerProcess::usage(
 }
 
 
+// Adds the statistics of the fetcher cache to the containerizer's.
+Future<JSON::Object> _statistics(
+    JSON::Object object,
+    const JSON::Object& cache)
+{
+  object.values.insert(cache.values.begin(), cache.values.end());
+  return object;
+}
+
+
+Future<JSON::Object> MesosContainerizerProcess::statistics()
+{
+  // The percentiles of the durations of the phases of launching (and
+  // cleaning up) the most recent containers, e.g.,
+  // 'containerizer_fetch_ms_p99'.
+  JSON::Object object;
+  foreachpair (const string& phase, const deque<Duration>& durations,
+               latencies) {
+    if (durations.empty()) {
+      continue;
+    }
+
+    vector<Duration> sorted(durations.begin(), durations.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    const string& prefix = "containerizer_" + phase + "_ms_";
+    object.values[prefix + "p50"] = sorted[(sorted.size() - 1) / 2].ms();
+    object.values[prefix + "p99"] =
+      sorted[(sorted.size() - 1) * 99 / 100].ms();
+  }
+
+  if (cache.get() == NULL) {
+    return object;
+  }
+
+  return cache->statistics()
+    .then(lambda::bind(&_statistics, object, lambda::_1));
+}
+
+
 void MesosContainerizerProcess::destroy(const ContainerID& containerId)
 {
   if (!promises.contains(containerId)) {
@@ -852,11 +1168,18 @@ void MesosContainerizerProcess::__destroy(
     message = "Executor terminated";
   }
 
-  // We can now clean up all isolators.
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  // We can now clean up all isolators (in parallel).
+  list<Future<Nothing> > cleanups;
   foreach (const Owned<Isolator>& isolator, isolators) {
-    isolator->cleanup(containerId);
+    cleanups.push_back(isolator->cleanup(containerId));
   }
 
+  collect(cleanups).onReady(
+      defer(self(), &Self::phased, containerId, string("cleanup"), stopwatch));
+
   promises[containerId]->set(Containerizer::Termination(
         status.isReady() ? status.get() : None(),
         killed,
@@ -867,6 +1190,11 @@ void MesosContainerizerProcess::__destroy(
   limitations.erase(containerId);
   resources.erase(containerId);
   destroying.erase(containerId);
+  phases.erase(containerId);
+
+  if (collector.get() != NULL) {
+    collector->unwatch(containerId);
+  }
 }
 
 
@@ -908,6 +1236,54 @@ void MesosContainerizerProcess::limited(
   destroy(containerId);
 }
 
+
+void MesosContainerizerProcess::phased(
+    const ContainerID& containerId,
+    const string& phase,
+    const Stopwatch& stopwatch)
+{
+  const Duration duration = stopwatch.elapsed();
+
+  deque<Duration>& durations = latencies[phase];
+  durations.push_back(duration);
+  if (durations.size() > LATENCY_SAMPLES) {
+    durations.pop_front();
+  }
+
+  if (phases.contains(containerId)) {
+    phases[containerId][phase] = duration;
+  }
+}
+
+
+void MesosContainerizerProcess::launched(
+    const ContainerID& containerId,
+    const Stopwatch& stopwatch)
+{
+  phased(containerId, "launch", stopwatch);
+
+  if (!phases.contains(containerId)) {
+    return;
+  }
+
+  std::ostringstream out;
+  out << "Launched container '" << containerId << "' in "
+      << phases[containerId]["launch"] << " (";
+
+  const char* names[] = { "prepare", "fetch", "fork", "isolate" };
+  for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    out << (i > 0 ? ", " : "") << names[i] << ": "
+        << phases[containerId][names[i]];
+  }
+
+  out << ")";
+
+  LOG(INFO) << out.str();
+
+  // The phases have all been recorded.
+  phases.erase(containerId);
+}
+
 } // namespace slave {
 } // namespace internal {
 } // namespace mesos {
@@ -19,14 +19,20 @@
 #ifndef __MESOS_CONTAINERIZER_HPP__
 #define __MESOS_CONTAINERIZER_HPP__
 
+#include <deque>
 #include <list>
+#include <string>
 #include <vector>
 
+#include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/lambda.hpp>
 #include <stout/multihashmap.hpp>
+#include <stout/stopwatch.hpp>
 
 #include "slave/containerizer/containerizer.hpp"
+#include "slave/containerizer/disk_usage.hpp"
+#include "slave/containerizer/fetcher_cache.hpp"
 #include "slave/containerizer/isolator.hpp"
 #include "slave/containerizer/launcher.hpp"
 
@@ -37,6 +43,13 @@ namespace slave {
 // Forward declaration.
 class MesosContainerizerProcess;
 
+// Helper method to build the command sent to the fetcher.
+std::string buildCommand(
+    const CommandInfo& commandInfo,
+    const std::string& directory,
+    const Option<std::string>& user,
+    const Flags& flags);
+
 class MesosContainerizer : public Containerizer
 {
 public:
@@ -72,6 +85,8 @@ public:
 
   virtual void destroy(const ContainerID& containerId);
 
+  virtual process::Future<JSON::Object> statistics();
+
 private:
   MesosContainerizerProcess* process;
 };
@@ -88,7 +103,13 @@ public:
     : flags(_flags),
       local(_local),
       launcher(_launcher),
-      isolators(_isolators) {}
+      isolators(_isolators),
+      cache(_flags.fetcher_cache_size > Bytes(0)
+            ? new FetcherCache(_flags)
+            : NULL),
+      collector(_flags.sandbox_usage_interval.isSome()
+                ? new DiskUsageCollector(_flags.sandbox_usage_interval.get())
+                : NULL) {}
 
   virtual ~MesosContainerizerProcess() {}
 
@@ -116,6 +137,8 @@ public:
 
   void destroy(const ContainerID& containerId);
 
+  process::Future<JSON::Object> statistics();
+
 private:
   process::Future<Nothing> _recover(
       const std::list<state::RunState>& recovered);
@@ -132,6 +155,26 @@ private:
       const std::string& directory,
       const Option<std::string>& user);
 
+  // Continues 'fetch()' once all cacheable URIs are in the fetcher
+  // cache, by fetching them from there instead.
+  process::Future<Nothing> _fetch(
+      const ContainerID& containerId,
+      const CommandInfo& commandInfo,
+      const std::string& directory,
+      const Option<std::string>& user,
+      const std::list<process::Future<std::string> >& cached);
+
+  // Runs the fetcher for the URIs.
+  process::Future<Nothing> __fetch(
+      const ContainerID& containerId,
+      const CommandInfo& commandInfo,
+      const std::string& directory,
+      const Option<std::string>& user);
+
+  // Releases the URIs reserved in the fetcher cache once they've been
+  // fetched.
+  void release(const std::list<CommandInfo::URI>& uris);
+
   process::Future<pid_t> fork(
       const ContainerID& containerId,
       const ExecutorInfo& executorInfo,
@@ -173,11 +216,29 @@ private:
   // destroy.
   void reaped(const ContainerID& containerId);
 
+  // Records how long a phase of launching (or cleaning up) the
+  // container took, timed by 'stopwatch'.
+  void phased(
+      const ContainerID& containerId,
+      const std::string& phase,
+      const Stopwatch& stopwatch);
+
+  // Records how long launching the container took and logs how long
+  // each of its phases took.
+  void launched(const ContainerID& containerId, const Stopwatch& stopwatch);
+
   const Flags flags;
   const bool local;
   const process::Owned<Launcher> launcher;
   const std::vector<process::Owned<Isolator> > isolators;
 
+  // Cache of executor URIs, if enabled (see --fetcher_cache_size).
+  const process::Owned<FetcherCache> cache;
+
+  // Disk usage of the sandboxes, if enabled (see
+  // --sandbox_usage_interval).
+  const process::Owned<DiskUsageCollector> collector;
+
   // TODO(idownes): Consider putting these per-container variables into a
   // struct.
   // Promises for futures returned from wait().
@@ -198,6 +259,14 @@ private:
 
   // Set of containers that are in process of being destroyed.
   hashset<ContainerID> destroying;
+
+  // How long each phase of launching a container took, until the
+  // container has been launched.
+  hashmap<ContainerID, hashmap<std::string, Duration> > phases;
+
+  // How long the phases of the most recent launches (and cleanups)
+  // took, for the latency percentiles in statistics().
+  hashmap<std::string, std::deque<Duration> > latencies;
 };
 
 
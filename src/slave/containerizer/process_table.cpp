@@ -0,0 +1,211 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <deque>
+#include <list>
+#include <string>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
+#include <stout/os.hpp>
+#ifdef __linux__
+#include <stout/proc.hpp>
+#endif // __linux__
+#include <stout/stopwatch.hpp>
+
+#include "common/lock.hpp"
+
+#include "slave/containerizer/process_table.hpp"
+
+using process::Shared;
+
+using std::deque;
+using std::list;
+using std::string;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+#ifdef __linux__
+// Reads the process from /proc/[pid]/stat, keeping only what the
+// isolators use. Returns None if the process has exited.
+static Result<ProcessTable::Process> stat(
+    pid_t pid,
+    long ticks,
+    long pageSize)
+{
+  Result<proc::ProcessStatus> status = proc::status(pid);
+  if (status.isError()) {
+    return Error(status.error());
+  } else if (status.isNone()) {
+    return None();
+  }
+
+  ProcessTable::Process process;
+  process.pid = pid;
+  process.parent = status.get().ppid;
+  process.rss = Bytes(status.get().rss * pageSize);
+
+  // NOTE: Like 'os::process', we drop invalid cpu times.
+  Try<Duration> utime = Duration::create(status.get().utime / (double) ticks);
+  if (utime.isSome()) {
+    process.utime = utime.get();
+  }
+
+  Try<Duration> stime = Duration::create(status.get().stime / (double) ticks);
+  if (stime.isSome()) {
+    process.stime = stime.get();
+  }
+
+  return process;
+}
+#endif // __linux__
+
+
+Try<ProcessTable*> ProcessTable::create()
+{
+  ProcessTable* table = new ProcessTable();
+
+#ifdef __linux__
+  static const long ticks = ::sysconf(_SC_CLK_TCK);
+  static const long pageSize = ::sysconf(_SC_PAGESIZE);
+
+  if (ticks <= 0 || pageSize <= 0) {
+    delete table;
+    return Error("Failed to get sysconf(_SC_CLK_TCK) or sysconf(_SC_PAGESIZE)");
+  }
+
+  DIR* dir = ::opendir("/proc");
+  if (dir == NULL) {
+    delete table;
+    return ErrnoError("Failed to open '/proc'");
+  }
+
+  struct dirent* entry;
+  while ((entry = ::readdir(dir)) != NULL) {
+    char* end;
+    pid_t pid = ::strtol(entry->d_name, &end, 10);
+    if (*end != '\0' || pid <= 0) {
+      continue; // Not a process.
+    }
+
+    Result<Process> process = stat(pid, ticks, pageSize);
+    if (process.isError()) {
+      ::closedir(dir);
+      delete table;
+      return Error(process.error());
+    } else if (process.isSome()) {
+      table->processes[pid] = process.get();
+      table->children.put(process.get().parent, pid);
+    }
+  }
+
+  ::closedir(dir);
+#else
+  Try<list<os::Process> > processes = os::processes();
+  if (processes.isError()) {
+    delete table;
+    return Error(processes.error());
+  }
+
+  foreach (const os::Process& process_, processes.get()) {
+    Process process;
+    process.pid = process_.pid;
+    process.parent = process_.parent;
+    process.utime = process_.utime;
+    process.stime = process_.stime;
+    process.rss = process_.rss;
+
+    table->processes[process.pid] = process;
+    table->children.put(process.parent, process.pid);
+  }
+#endif // __linux__
+
+  return table;
+}
+
+
+Try<Shared<ProcessTable> > ProcessTable::snapshot(const Duration& maxAge)
+{
+  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  static Shared<ProcessTable>* latest = new Shared<ProcessTable>();
+  static Stopwatch* age = new Stopwatch();
+
+  Lock lock(&mutex);
+
+  // NOTE: The snapshot is taken while holding the lock so that those
+  // asking at the same time wait for it rather than take their own.
+  if (latest->get() == NULL || age->elapsed() >= maxAge) {
+    Try<ProcessTable*> table = create();
+    if (table.isError()) {
+      return Error(table.error());
+    }
+
+    *latest = Shared<ProcessTable>(table.get());
+    age->start();
+  }
+
+  return *latest;
+}
+
+
+list<ProcessTable::Process> ProcessTable::tree(pid_t pid) const
+{
+  list<Process> result;
+
+  if (!processes.contains(pid)) {
+    return result;
+  }
+
+  // NOTE: Processes are read one at a time, so with pids getting
+  // reused the parents might (in theory) form a cycle.
+  hashset<pid_t> visited;
+
+  deque<pid_t> pids;
+  pids.push_back(pid);
+  visited.insert(pid);
+
+  while (!pids.empty()) {
+    pid_t pid = pids.front();
+    pids.pop_front();
+
+    result.push_back(processes.get(pid).get());
+
+    foreach (pid_t child, children.get(pid)) {
+      if (!visited.contains(child)) {
+        visited.insert(child);
+        pids.push_back(child);
+      }
+    }
+  }
+
+  return result;
+}
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
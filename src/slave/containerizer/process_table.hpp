@@ -0,0 +1,82 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PROCESS_TABLE_HPP__
+#define __PROCESS_TABLE_HPP__
+
+#include <sys/types.h>
+
+#include <list>
+
+#include <process/shared.hpp>
+
+#include <stout/bytes.hpp>
+#include <stout/duration.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/multihashmap.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+namespace mesos {
+namespace internal {
+namespace slave {
+
+// A snapshot of the processes on the host, indexed by parent pid so
+// that the process tree of any process can be walked without going
+// back to the host. A snapshot is shared by everyone asking for one
+// while it's fresh enough, so sampling the usage of many containers
+// takes a single scan of the host's processes.
+class ProcessTable
+{
+public:
+  struct Process
+  {
+    Process() : pid(0), parent(0) {}
+
+    pid_t pid;
+    pid_t parent;
+    Option<Duration> utime;
+    Option<Duration> stime;
+    Option<Bytes> rss;
+  };
+
+  // Returns the latest snapshot, taking a new one if it's older than
+  // 'maxAge'.
+  static Try<process::Shared<ProcessTable> > snapshot(const Duration& maxAge);
+
+  // Takes a new snapshot.
+  static Try<ProcessTable*> create();
+
+  // Returns the process and all of its descendants, parents first,
+  // or an empty list if there is no such process.
+  std::list<Process> tree(pid_t pid) const;
+
+  size_t size() const { return processes.size(); }
+
+private:
+  ProcessTable() {}
+
+  hashmap<pid_t, Process> processes;
+  multihashmap<pid_t, pid_t> children;
+};
+
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __PROCESS_TABLE_HPP__
@@ -21,6 +21,7 @@
 
 #include <string>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/flags.hpp>
 #include <stout/option.hpp>
@@ -103,6 +104,21 @@ public:
         "Directory prepended to relative executor URIs",
         "");
 
+    add(&Flags::fetcher_cache_size,
+        "fetcher_cache_size",
+        "Maximum size of the slave wide cache of executor URIs\n"
+        "fetched from HDFS, HTTP(S) or FTP(S) (e.g., 2GB). Least\n"
+        "recently used URIs are evicted when the cache grows\n"
+        "beyond this size. A size of 0B disables the cache",
+        Bytes(0));
+
+    add(&Flags::fetcher_cache_dir,
+        "fetcher_cache_dir",
+        "Directory in which to place the fetcher cache, as\n"
+        "its 'fetch' subdirectory (no default, uses the work\n"
+        "directory). NOTE: The 'fetch' subdirectory is removed\n"
+        "on startup");
+
     add(&Flags::executor_registration_timeout,
         "executor_registration_timeout",
         "Amount of time to wait for an executor\n"
@@ -116,6 +132,14 @@ public:
         "to shut down (e.g., 60secs, 3mins, etc)",
         EXECUTOR_SHUTDOWN_GRACE_PERIOD);
 
+    add(&Flags::executor_launch_concurrency,
+        "executor_launch_concurrency",
+        "Maximum number of executors to launch at once, the launches of\n"
+        "the others get queued (in order) until a launch completes. Tasks\n"
+        "for executors that are already launched don't get queued. This\n"
+        "avoids bursts of tasks thrashing the slave. 0 means no limit.",
+        0);
+
     add(&Flags::gc_delay,
         "gc_delay",
         "Maximum amount of time to wait before cleaning up\n"
@@ -130,6 +154,15 @@ public:
         "to check the disk usage",
         DISK_WATCH_INTERVAL);
 
+    add(&Flags::sandbox_usage_interval,
+        "sandbox_usage_interval",
+        "Periodic time interval (e.g., 1secs, 10secs, etc) to update the\n"
+        "disk usage of executor sandboxes, as reported in the executors'\n"
+        "resource statistics. Sandboxes are scanned incrementally, a\n"
+        "bounded number of files per interval, and directories that\n"
+        "haven't changed since they were last scanned aren't listed again.\n"
+        "If not set, the disk usage of sandboxes is not tracked.");
+
     add(&Flags::resource_monitoring_interval,
         "resource_monitoring_interval",
         "Periodic time interval for monitoring executor\n"
@@ -145,6 +178,16 @@ public:
         "kill (--recover=kill) old executors",
         true);
 
+    add(&Flags::checkpoint_journal,
+        "checkpoint_journal",
+        "Whether to checkpoint to a single append-only journal file\n"
+        "(<work_dir>/meta/journal) instead of a file per checkpoint.\n"
+        "This saves creating, syncing and (during recovery) walking\n"
+        "thousands of small files on slaves with many (short) tasks.\n"
+        "NOTE: Once the journal exists it gets used, to switch back\n"
+        "      run the slave with --recover=cleanup first.",
+        false);
+
     add(&Flags::recover,
         "recover",
         "Whether to recover status updates and reconnect with old executors.\n"
@@ -174,6 +217,16 @@ public:
         "state as possible is recovered.\n",
         true);
 
+    add(&Flags::launcher_vfork,
+        "launcher_vfork",
+        "Whether to launch executors with clone(CLONE_VM | CLONE_VFORK)\n"
+        "(i.e., like vfork) rather than fork. The child then shares the\n"
+        "slave's memory until it execs, so that a launch doesn't copy\n"
+        "the page tables of the slave and takes the same time however\n"
+        "big the slave is. The executor gets set up by mesos-launcher\n"
+        "(in --launcher_dir) instead of the child. Only on Linux.",
+        false);
+
 #ifdef __linux__
     add(&Flags::cgroups_hierarchy,
         "cgroups_hierarchy",
@@ -196,6 +249,34 @@ public:
         "via the CFS bandwidth limiting subfeature.\n",
         false);
 
+    add(&Flags::cgroups_cfs_period,
+        "cgroups_cfs_period",
+        "The period over which the CPU time of each container is capped\n"
+        "to its cpus when --cgroups_enable_cfs is set (between 1ms and\n"
+        "1secs). A shorter period makes throttled containers wait less\n"
+        "to run again (i.e., lowers their tail latency) at the cost of\n"
+        "more scheduling overhead.",
+        CPU_CFS_PERIOD);
+
+    add(&Flags::cgroups_pool_size,
+        "cgroups_pool_size",
+        "Number of empty cgroups to keep created ahead of time in each\n"
+        "hierarchy used by the cgroups isolators, so that containers\n"
+        "don't have to wait for their cgroups to be created. A size of\n"
+        "0 disables the pool.",
+        0);
+
+    add(&Flags::cgroups_share_memory_slack,
+        "cgroups_share_memory_slack",
+        "Whether to let containers use the memory that's free on the\n"
+        "host beyond their memory allocation, rather than get OOM killed\n"
+        "at their allocation. The hard memory limit of each container\n"
+        "then includes a share of the free memory (recomputed every\n"
+        "resource_monitoring_interval) while its soft limit stays at\n"
+        "its allocation, so the kernel reclaims memory from containers\n"
+        "beyond their allocation first when memory gets short.",
+        false);
+
     add(&Flags::slave_subsystems,
         "slave_subsystems",
         "List of comma-separated cgroup subsystems to run the slave binary\n"
@@ -217,20 +298,29 @@ public:
   std::string hadoop_home; // TODO(benh): Make an Option.
   bool switch_user;
   std::string frameworks_home;  // TODO(benh): Make an Option.
+  Bytes fetcher_cache_size;
+  Option<std::string> fetcher_cache_dir;
   Duration executor_registration_timeout;
   Duration executor_shutdown_grace_period;
+  size_t executor_launch_concurrency;
   Duration gc_delay;
   Duration disk_watch_interval;
+  Option<Duration> sandbox_usage_interval;
   Duration resource_monitoring_interval;
   bool checkpoint;
+  bool checkpoint_journal;
   std::string recover;
   Duration recovery_timeout;
   bool strict;
+  bool launcher_vfork;
 #ifdef __linux__
   std::string cgroups_hierarchy;
   std::string cgroups_root;
   Option<std::string> cgroups_subsystems;
   bool cgroups_enable_cfs;
+  Duration cgroups_cfs_period;
+  size_t cgroups_pool_size;
+  bool cgroups_share_memory_slack;
   Option<std::string> slave_subsystems;
 #endif
 };
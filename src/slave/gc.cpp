@@ -16,17 +16,31 @@
  * limitations under the License.
  */
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
 #include <list>
 
 #include <process/delay.hpp>
 #include <process/dispatch.hpp>
 
+#include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/os.hpp>
 
+#include "common/lock.hpp"
+
 #include "logging/logging.hpp"
 
+#include "slave/constants.hpp"
 #include "slave/gc.hpp"
+#include "slave/state.hpp"
 
 using namespace process;
 
@@ -41,11 +55,163 @@ namespace internal {
 namespace slave {
 
 
+// Removes the entries of the directory 'fd', recursively, using the
+// '*at' system calls (i.e., without resolving paths over and over)
+// and adds up the disk space they took. Closes 'fd' and stops early
+// if 'stop' gets set.
+static Try<Nothing> clear(int fd, Bytes* bytes, volatile bool* stop)
+{
+  DIR* dir = ::fdopendir(fd);
+  if (dir == NULL) {
+    ErrnoError error("Failed to open directory");
+    ::close(fd);
+    return error;
+  }
+
+  while (!*stop) {
+    errno = 0;
+    struct dirent* entry = ::readdir(dir);
+    if (entry == NULL) {
+      if (errno != 0) {
+        ErrnoError error("Failed to read directory");
+        ::closedir(dir);
+        return error;
+      }
+      break;
+    }
+
+    const string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+
+    struct stat s;
+    if (::fstatat(fd, name.c_str(), &s, AT_SYMLINK_NOFOLLOW) < 0) {
+      if (errno == ENOENT) {
+        continue;
+      }
+      ErrnoError error("Failed to stat '" + name + "'");
+      ::closedir(dir);
+      return error;
+    }
+
+    if (S_ISDIR(s.st_mode)) {
+      int child = ::openat(
+          fd, name.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+      if (child < 0) {
+        ErrnoError error("Failed to open '" + name + "'");
+        ::closedir(dir);
+        return error;
+      }
+
+      Try<Nothing> clear_ = clear(child, bytes, stop);
+      if (clear_.isError()) {
+        ::closedir(dir);
+        return Error(name + "/" + clear_.error());
+      }
+    }
+
+    if (::unlinkat(fd, name.c_str(), S_ISDIR(s.st_mode) ? AT_REMOVEDIR : 0)
+          < 0 && errno != ENOENT) {
+      ErrnoError error("Failed to remove '" + name + "'");
+      ::closedir(dir);
+      return error;
+    }
+
+    // The allocated blocks, i.e., the disk space reclaimed.
+    *bytes += Bytes(s.st_blocks * 512);
+  }
+
+  ::closedir(dir);
+
+  return Nothing();
+}
+
+
+// Removes the file or directory at 'path', returning the disk space
+// reclaimed.
+static Try<Bytes> rm(const string& path, volatile bool* stop)
+{
+  // NOTE: Meta directories might (partly) live in the checkpoint
+  // journal, in which case this removes them from there too. They're
+  // small so we don't bother counting what they took.
+  if (state::journaled(path)) {
+    Try<Nothing> remove = state::remove(path);
+    if (remove.isError()) {
+      return Error(remove.error());
+    }
+    return Bytes(0);
+  }
+
+  struct stat s;
+  if (::lstat(path.c_str(), &s) < 0) {
+    return ErrnoError("Failed to stat");
+  }
+
+  Bytes bytes(s.st_blocks * 512);
+
+  if (S_ISDIR(s.st_mode)) {
+    int fd = ::open(
+        path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+
+    if (fd < 0) {
+      return ErrnoError("Failed to open");
+    }
+
+    Try<Nothing> clear_ = clear(fd, &bytes, stop);
+    if (clear_.isError()) {
+      return Error(clear_.error());
+    }
+
+    if (::rmdir(path.c_str()) < 0) {
+      return ErrnoError("Failed to remove");
+    }
+  } else if (::unlink(path.c_str()) < 0) {
+    return ErrnoError("Failed to remove");
+  }
+
+  return bytes;
+}
+
+
+GarbageCollectorProcess::GarbageCollectorProcess()
+  : threads(0),
+    stopping(false),
+    removals(0)
+{
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&cond, NULL);
+}
+
+
 GarbageCollectorProcess::~GarbageCollectorProcess()
 {
+  // Wait for the pool to stop, abandoning any paths that are still
+  // queued or being removed.
+  {
+    Lock lock(&mutex);
+    stopping = true;
+    queue.clear();
+    while (threads > 0) {
+      pthread_cond_wait(&cond, &mutex);
+    }
+  }
+
   foreachvalue (const PathInfo& info, paths) {
     info.promise->discard();
   }
+
+  foreachvalue (const PathInfo& info, removing) {
+    info.promise->discard();
+  }
+
+  foreachvalue (const Owned<Promise<bool> >& promise, unschedules) {
+    promise->discard();
+  }
+
+  pthread_cond_destroy(&cond);
+  pthread_mutex_destroy(&mutex);
 }
 
 
@@ -58,7 +224,7 @@ Future<Nothing> GarbageCollectorProcess::schedule(
   // If there's an existing schedule for this path, we must remove
   // it here in order to reschedule.
   if (timeouts.contains(path)) {
-    CHECK(unschedule(path));
+    CHECK(unschedule(path).get());
   }
 
   Owned<Promise<Nothing> > promise(new Promise<Nothing>());
@@ -79,10 +245,40 @@ Future<Nothing> GarbageCollectorProcess::schedule(
 }
 
 
-bool GarbageCollectorProcess::unschedule(const string& path)
+Future<bool> GarbageCollectorProcess::unschedule(const string& path)
 {
   LOG(INFO) << "Unscheduling '" << path << "' from gc";
 
+  if (removing.contains(path)) {
+    const PathInfo info = removing.find(path)->second;
+
+    // Drop the path if no thread has picked it up yet.
+    {
+      Lock lock(&mutex);
+
+      typedef std::multimap<Timeout, string>::iterator Iterator;
+      for (Iterator it = queue.begin(); it != queue.end(); ++it) {
+        if (it->second == path) {
+          queue.erase(it);
+
+          info.promise->discard();
+          removing.erase(path);
+
+          if (removing.empty()) {
+            busy += stopwatch.elapsed();
+          }
+
+          return true;
+        }
+      }
+    }
+
+    // Otherwise wait for the path to be removed, see 'removed()'.
+    Owned<Promise<bool> > promise(new Promise<bool>());
+    unschedules.put(path, promise);
+    return promise->future();
+  }
+
   if (!timeouts.contains(path)) {
     return false;
   }
@@ -126,28 +322,37 @@ void GarbageCollectorProcess::reset()
 
 void GarbageCollectorProcess::remove(const Timeout& removalTime)
 {
-  // TODO(bmahler): Other dispatches can block waiting for a removal
-  // operation. To fix this, the removal operation can be done
-  // asynchronously in another thread.
   if (paths.count(removalTime) > 0) {
+    if (removing.empty()) {
+      stopwatch.start();
+    }
+
+    Lock lock(&mutex);
+
     foreach (const PathInfo& info, paths.get(removalTime)) {
       LOG(INFO) << "Deleting " << info.path;
 
-      Try<Nothing> rmdir = os::rmdir(info.path);
-
-      if (rmdir.isError()) {
-        LOG(WARNING) << "Failed to delete '" << info.path << "': "
-                     << rmdir.error();
-        info.promise->fail(rmdir.error());
-      } else {
-        LOG(INFO) << "Deleted '" << info.path << "'";
-        info.promise->set(rmdir.get());
-      }
+      removing.put(info.path, info);
+      queue.insert(std::make_pair(removalTime, info.path));
 
       timeouts.erase(info.path);
     }
 
     paths.remove(removalTime);
+
+    // Grow the pool, if need be.
+    while (threads < GC_THREADS && threads < queue.size()) {
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, &Self::work, this) != 0) {
+        // The queued paths get picked up by the existing threads, or
+        // the ones created the next time paths are due.
+        PLOG(ERROR) << "Failed to create a garbage collection thread";
+        break;
+      }
+
+      pthread_detach(thread);
+      threads++;
+    }
   } else {
     // This occurs when either:
     //   1. The path(s) has already been removed (e.g. by prune()).
@@ -172,6 +377,84 @@ void GarbageCollectorProcess::prune(const Duration& d)
 }
 
 
+JSON::Object GarbageCollectorProcess::statistics()
+{
+  Duration elapsed = busy;
+  if (!removing.empty()) {
+    elapsed += stopwatch.elapsed();
+  }
+
+  JSON::Object object;
+  object.values["gc_removals"] = removals;
+  object.values["gc_reclaimed_bytes"] = reclaimed.bytes();
+  object.values["gc_reclaimed_bytes_per_sec"] =
+    elapsed > Duration::zero() ? reclaimed.bytes() / elapsed.secs() : 0.0;
+  return object;
+}
+
+
+void GarbageCollectorProcess::removed(
+    const string& path,
+    const Try<Bytes>& bytes)
+{
+  if (!removing.contains(path)) {
+    return;
+  }
+
+  const PathInfo info = removing.find(path)->second;
+  removing.erase(path);
+
+  if (bytes.isError()) {
+    LOG(WARNING) << "Failed to delete '" << path << "': " << bytes.error();
+    info.promise->fail(bytes.error());
+  } else {
+    LOG(INFO) << "Deleted '" << path << "' (" << bytes.get() << ")";
+    removals++;
+    reclaimed += bytes.get();
+    info.promise->set(Nothing());
+  }
+
+  // The path is gone (or, on error, won't be touched anymore), so it
+  // can't be unscheduled anymore.
+  foreach (const Owned<Promise<bool> >& promise, unschedules.get(path)) {
+    promise->set(false);
+  }
+  unschedules.remove(path);
+
+  if (removing.empty()) {
+    busy += stopwatch.elapsed();
+
+    LOG(INFO) << "Reclaimed " << reclaimed << " in " << busy;
+  }
+}
+
+
+void* GarbageCollectorProcess::work(void* arg)
+{
+  GarbageCollectorProcess* process = (GarbageCollectorProcess*) arg;
+
+  Lock lock(&process->mutex);
+
+  while (!process->stopping && !process->queue.empty()) {
+    const string path = process->queue.begin()->second;
+    process->queue.erase(process->queue.begin());
+
+    lock.unlock();
+
+    Try<Bytes> bytes = rm(path, &process->stopping);
+
+    dispatch(process->self(), &GarbageCollectorProcess::removed, path, bytes);
+
+    lock.lock();
+  }
+
+  process->threads--;
+  pthread_cond_broadcast(&process->cond);
+
+  return NULL;
+}
+
+
 GarbageCollector::GarbageCollector()
 {
   process = new GarbageCollectorProcess();
@@ -206,6 +489,12 @@ void GarbageCollector::prune(const Duration& d)
   dispatch(process, &GarbageCollectorProcess::prune, d);
 }
 
+
+Future<JSON::Object> GarbageCollector::statistics() const
+{
+  return dispatch(process, &GarbageCollectorProcess::statistics);
+}
+
 } // namespace mesos {
 } // namespace internal {
 } // namespace slave {
@@ -19,6 +19,9 @@
 #ifndef __SLAVE_GC_HPP__
 #define __SLAVE_GC_HPP__
 
+#include <pthread.h>
+
+#include <map>
 #include <string>
 #include <vector>
 
@@ -28,10 +31,14 @@
 #include <process/timeout.hpp>
 #include <process/timer.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
+#include <stout/json.hpp>
+#include <stout/multihashmap.hpp>
 #include <stout/multimap.hpp>
 #include <stout/nothing.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/try.hpp>
 
 namespace mesos {
@@ -69,7 +76,9 @@ public:
   // Unschedules the specified path for removal.
   // The future will be true if the path has been unscheduled.
   // The future will be false if the path is not scheduled for
-  // removal, or the path has already being removed.
+  // removal, or the path has already been removed. If the path is
+  // being removed the future will only be satisfied (with false) once
+  // it has been removed, so callers can safely recreate it.
   // Note that you currently cannot discard a returned future.
   process::Future<bool> unschedule(const std::string& path);
 
@@ -77,30 +86,48 @@ public:
   // is within the next 'd' duration of time.
   void prune(const Duration& d);
 
+  // Returns the number of paths removed, the bytes reclaimed and the
+  // rate at which they were reclaimed.
+  process::Future<JSON::Object> statistics() const;
+
 private:
   GarbageCollectorProcess* process;
 };
 
 
+// Paths are removed, once due, by a bounded pool of threads so that
+// removing (huge) directories neither blocks the process nor one
+// another. When more paths are due than there are threads (e.g., when
+// pruning because the disk is nearly full) the paths that were due
+// first, i.e., the oldest ones, get removed first.
 class GarbageCollectorProcess :
     public process::Process<GarbageCollectorProcess>
 {
 public:
+  GarbageCollectorProcess();
   virtual ~GarbageCollectorProcess();
 
   process::Future<Nothing> schedule(
       const Duration& d,
       const std::string& path);
 
-  bool unschedule(const std::string& path);
+  process::Future<bool> unschedule(const std::string& path);
 
   void prune(const Duration& d);
 
+  JSON::Object statistics();
+
 private:
   void reset();
 
   void remove(const process::Timeout& removalTime);
 
+  // Invoked (by a thread of the pool) once a path has been removed.
+  void removed(const std::string& path, const Try<Bytes>& bytes);
+
+  // Removes the queued paths, run by each thread of the pool.
+  static void* work(void* arg);
+
   struct PathInfo
   {
     PathInfo(const std::string& _path,
@@ -126,6 +153,27 @@ private:
   hashmap<std::string, process::Timeout> timeouts;
 
   process::Timer timer;
+
+  // Paths handed to the pool that haven't been removed yet.
+  hashmap<std::string, PathInfo> removing;
+
+  // Unschedules waiting for paths that are being removed.
+  multihashmap<std::string, process::Owned<process::Promise<bool> > >
+    unschedules;
+
+  // The following are shared with the pool, protected by 'mutex'.
+  // Paths waiting for a thread, keyed by their removal time.
+  std::multimap<process::Timeout, std::string> queue;
+  size_t threads; // Number of threads in the pool.
+  volatile bool stopping; // Whether the threads should stop removing.
+  pthread_mutex_t mutex;
+  pthread_cond_t cond; // Signaled when a thread exits.
+
+  // Statistics.
+  uint64_t removals;
+  Bytes reclaimed;
+  Duration busy; // Time spent with paths being removed.
+  Stopwatch stopwatch; // Running while paths are being removed.
 };
 
 } // namespace mesos {
@@ -16,16 +16,19 @@
  * limitations under the License.
  */
 
+#include <list>
 #include <map>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include <process/collect.hpp>
 #include <process/help.hpp>
 #include <process/owned.hpp>
 
 #include <stout/foreach.hpp>
 #include <stout/json.hpp>
+#include <stout/lambda.hpp>
 #include <stout/net.hpp>
 #include <stout/numify.hpp>
 #include <stout/stringify.hpp>
@@ -43,6 +46,7 @@
 
 
 using process::Clock;
+using process::collect;
 using process::DESCRIPTION;
 using process::Future;
 using process::HELP;
@@ -52,6 +56,7 @@ using process::USAGE;
 
 using process::http::OK;
 
+using std::list;
 using std::map;
 using std::string;
 using std::vector;
@@ -224,6 +229,25 @@ Future<Response> Slave::Http::health(const Request& request)
 }
 
 
+// Continues 'Slave::Http::stats' once the containerizer's and the
+// garbage collector's statistics are available.
+Future<Response> _stats(
+    JSON::Object object,
+    const Option<string>& jsonp,
+    const list<JSON::Object>& statistics)
+{
+  foreach (const JSON::Object& statistics_, statistics) {
+    foreachpair (const string& key,
+                 const JSON::Value& value,
+                 statistics_.values) {
+      object.values[key] = value;
+    }
+  }
+
+  return OK(object, jsonp);
+}
+
+
 Future<Response> Slave::Http::stats(const Request& request)
 {
   LOG(INFO) << "HTTP request for '" << request.path << "'";
@@ -233,6 +257,13 @@ Future<Response> Slave::Http::stats(const Request& request)
   object.values["total_frameworks"] = slave.frameworks.size();
   object.values["registered"] = slave.master.isSome() ? "1" : "0";
   object.values["recovery_errors"] = slave.recoveryErrors;
+  object.values["recovery_parse_secs"] = slave.recovery.parse.secs();
+  object.values["recovery_status_updates_secs"] =
+    slave.recovery.statusUpdates.secs();
+  object.values["recovery_containerizer_secs"] =
+    slave.recovery.containerizer.secs();
+  object.values["recovery_reregistration_secs"] =
+    slave.recovery.reregistration.secs();
 
   // NOTE: These are monotonically increasing counters.
   object.values["staged_tasks"] = slave.stats.tasks[TASK_STAGING];
@@ -262,7 +293,20 @@ Future<Response> Slave::Http::stats(const Request& request)
   object.values["queued_tasks_gauge"] = queued_tasks;
   object.values["launched_tasks_gauge"] = launched_tasks;
 
-  return OK(object, request.query.get("jsonp"));
+  // Executors waiting to be launched (see --executor_launch_concurrency)
+  // and being launched.
+  object.values["queued_launches_gauge"] = slave.launches.size();
+  object.values["launching_executors_gauge"] = slave.launching;
+
+  // Add the containerizer's statistics (e.g., of the fetcher cache)
+  // and the garbage collector's.
+  list<Future<JSON::Object> > statistics;
+  statistics.push_back(slave.containerizer->statistics());
+  statistics.push_back(slave.gc.statistics());
+
+  return collect(statistics)
+    .then(lambda::bind(
+        &_stats, object, request.query.get("jsonp"), lambda::_1));
 }
 
 
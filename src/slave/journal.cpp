@@ -0,0 +1,510 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fnmatch.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stout/error.hpp>
+#include <stout/foreach.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/protobuf.hpp>
+#include <stout/strings.hpp>
+
+#include "common/lock.hpp"
+#include "common/type_utils.hpp"
+
+#include "logging/logging.hpp"
+
+#include "slave/journal.hpp"
+#include "slave/paths.hpp"
+
+using std::list;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace state {
+
+// Journals smaller than this don't get compacted.
+static const Bytes MIN_COMPACTION_SIZE = Megabytes(1);
+
+// Journals get compacted when they're this many times the size of
+// their contents.
+static const size_t COMPACTION_FACTOR = 4;
+
+
+Try<Journal*> Journal::open(const string& rootDir)
+{
+  Try<Nothing> mkdir = os::mkdir(rootDir);
+  if (mkdir.isError()) {
+    return Error("Failed to create directory '" + rootDir + "': " +
+                 mkdir.error());
+  }
+
+  const string& path = paths::getJournalPath(rootDir);
+
+  // Open the journal for reading and writing (for truncating).
+  Try<int> fd = os::open(
+      path,
+      O_CREAT | O_RDWR | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
+
+  if (fd.isError()) {
+    return Error("Failed to open journal '" + path + "': " + fd.error());
+  }
+
+  Journal* journal = new Journal(rootDir, fd.get());
+
+  // Now, replay the records.
+  Result<JournalRecord> record = None();
+  while (true) {
+    // Ignore errors due to partial protobuf read.
+    record = ::protobuf::read<JournalRecord>(fd.get(), true);
+
+    if (!record.isSome()) {
+      break;
+    }
+
+    journal->apply(record.get());
+  }
+
+  if (record.isError()) {
+    delete journal;
+    return Error("Failed to read journal '" + path + "': " + record.error());
+  }
+
+  // Truncate any partially written record.
+  // NOTE: This is safe because 'fd' is properly set to the end of the
+  // last valid record by 'protobuf::read()'.
+  off_t offset = lseek(fd.get(), 0, SEEK_CUR);
+  if (ftruncate(fd.get(), offset) != 0) {
+    ErrnoError error("Failed to truncate journal '" + path + "'");
+    delete journal;
+    return error;
+  }
+
+  journal->journaled = Bytes(offset);
+
+  LOG(INFO) << "Replayed " << journal->files.size() << " files ("
+            << journal->contents << ") from journal '" << path << "' ("
+            << journal->journaled << ")";
+
+  return journal;
+}
+
+
+Journal::Journal(const string& _rootDir, int _fd)
+  : rootDir(_rootDir), fd(_fd), dirty(false)
+{
+  pthread_mutex_init(&mutex, NULL);
+}
+
+
+Journal::~Journal()
+{
+  os::close(fd);
+  pthread_mutex_destroy(&mutex);
+}
+
+
+Try<Nothing> Journal::write(const string& path, const string& data)
+{
+  Try<string> relative_ = relative(path);
+  if (relative_.isError()) {
+    return Error(relative_.error());
+  }
+
+  JournalRecord record;
+  record.set_type(JournalRecord::WRITE);
+  record.set_path(relative_.get());
+  record.set_data(data);
+
+  Lock lock(&mutex);
+  return _append(record, false);
+}
+
+
+Try<Nothing> Journal::append(
+    const string& path,
+    const string& data,
+    bool sync)
+{
+  Try<string> relative_ = relative(path);
+  if (relative_.isError()) {
+    return Error(relative_.error());
+  }
+
+  JournalRecord record;
+  record.set_type(JournalRecord::APPEND);
+  record.set_path(relative_.get());
+  record.set_data(data);
+
+  Lock lock(&mutex);
+  return _append(record, sync);
+}
+
+
+Try<Nothing> Journal::remove(const string& path)
+{
+  Try<string> relative_ = relative(path);
+  if (relative_.isError()) {
+    return Error(relative_.error());
+  }
+
+  JournalRecord record;
+  record.set_type(JournalRecord::REMOVE);
+  record.set_path(relative_.get());
+
+  Lock lock(&mutex);
+
+  // Don't bother journaling the removal of nothing.
+  if (!files.contains(record.path()) &&
+      !directories.contains(record.path())) {
+    return Nothing();
+  }
+
+  return _append(record, false);
+}
+
+
+Option<string> Journal::read(const string& path)
+{
+  Try<string> relative_ = relative(path);
+  if (relative_.isError()) {
+    return None();
+  }
+
+  Lock lock(&mutex);
+
+  if (!files.contains(relative_.get())) {
+    return None();
+  }
+
+  return files[relative_.get()];
+}
+
+
+bool Journal::exists(const string& path)
+{
+  Try<string> relative_ = relative(path);
+  if (relative_.isError()) {
+    return false;
+  }
+
+  Lock lock(&mutex);
+
+  return files.contains(relative_.get()) ||
+    directories.contains(relative_.get());
+}
+
+
+list<string> Journal::glob(const string& pattern)
+{
+  list<string> result;
+
+  Try<string> relative_ = relative(pattern);
+  if (relative_.isError()) {
+    return result;
+  }
+
+  const size_t depth = strings::tokenize(relative_.get(), "/").size();
+
+  Lock lock(&mutex);
+
+  // Match the pattern against the files and directories that are at
+  // the same depth as the pattern.
+  set<string> matches;
+  foreachkey (const string& file, files) {
+    if (strings::tokenize(file, "/").size() == depth &&
+        ::fnmatch(relative_.get().c_str(), file.c_str(), FNM_PATHNAME) == 0) {
+      matches.insert(path::join(rootDir, file));
+    }
+  }
+
+  foreachkey (const string& directory, directories) {
+    if (strings::tokenize(directory, "/").size() == depth &&
+        ::fnmatch(relative_.get().c_str(), directory.c_str(), FNM_PATHNAME)
+          == 0) {
+      matches.insert(path::join(rootDir, directory));
+    }
+  }
+
+  result.assign(matches.begin(), matches.end());
+  return result;
+}
+
+
+Try<Nothing> Journal::sync()
+{
+  Lock lock(&mutex);
+
+  if (dirty) {
+    if (::fdatasync(fd) != 0) {
+      return ErrnoError("Failed to sync journal '" +
+                        paths::getJournalPath(rootDir) + "'");
+    }
+    dirty = false;
+  }
+
+  return Nothing();
+}
+
+
+Bytes Journal::size()
+{
+  Lock lock(&mutex);
+  return journaled;
+}
+
+
+Try<Nothing> Journal::_append(const JournalRecord& record, bool sync)
+{
+  Try<Nothing> write = ::protobuf::write(fd, record);
+  if (write.isError()) {
+    return Error("Failed to write to journal '" +
+                 paths::getJournalPath(rootDir) + "': " + write.error());
+  }
+
+  dirty = true;
+
+  // NOTE: Syncing also makes any earlier (unsynced) records durable.
+  if (sync) {
+    if (::fdatasync(fd) != 0) {
+      return ErrnoError("Failed to sync journal '" +
+                        paths::getJournalPath(rootDir) + "'");
+    }
+    dirty = false;
+  }
+
+  journaled += Bytes(sizeof(uint32_t) + record.ByteSize());
+
+  apply(record);
+
+  if (journaled > MIN_COMPACTION_SIZE &&
+      journaled.bytes() > COMPACTION_FACTOR * contents.bytes()) {
+    Try<Nothing> compact_ = compact();
+    if (compact_.isError()) {
+      // We can keep appending to the current journal.
+      LOG(ERROR) << "Failed to compact journal '"
+                 << paths::getJournalPath(rootDir) << "': "
+                 << compact_.error();
+    }
+  }
+
+  return Nothing();
+}
+
+
+// Syncs the directory containing 'path', e.g., to make a rename
+// durable.
+static Try<Nothing> syncDirectory(const string& path)
+{
+  Try<string> directory = os::dirname(path);
+  if (directory.isError()) {
+    return Error(directory.error());
+  }
+
+  Try<int> fd = os::open(directory.get(), O_RDONLY | O_CLOEXEC);
+  if (fd.isError()) {
+    return Error(fd.error());
+  }
+
+  if (::fsync(fd.get()) != 0) {
+    ErrnoError error;
+    os::close(fd.get());
+    return error;
+  }
+
+  os::close(fd.get());
+
+  return Nothing();
+}
+
+
+Try<Nothing> Journal::compact()
+{
+  const string& path = paths::getJournalPath(rootDir);
+  const string& temporary = path + ".tmp";
+
+  Try<int> fd_ = os::open(
+      temporary,
+      O_CREAT | O_WRONLY | O_TRUNC | O_APPEND | O_CLOEXEC,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
+
+  if (fd_.isError()) {
+    return Error("Failed to open '" + temporary + "': " + fd_.error());
+  }
+
+  Bytes compacted;
+  foreachpair (const string& file, const string& data, files) {
+    JournalRecord record;
+    record.set_type(JournalRecord::WRITE);
+    record.set_path(file);
+    record.set_data(data);
+
+    Try<Nothing> write = ::protobuf::write(fd_.get(), record);
+    if (write.isError()) {
+      os::close(fd_.get());
+      os::rm(temporary);
+      return Error("Failed to write '" + temporary + "': " + write.error());
+    }
+
+    compacted += Bytes(sizeof(uint32_t) + record.ByteSize());
+  }
+
+  if (::fdatasync(fd_.get()) != 0) {
+    ErrnoError error("Failed to sync '" + temporary + "'");
+    os::close(fd_.get());
+    os::rm(temporary);
+    return error;
+  }
+
+  // The rename atomically replaces the journal, so a crash leaves
+  // either the old or the compacted journal behind.
+  if (::rename(temporary.c_str(), path.c_str()) != 0) {
+    ErrnoError error("Failed to rename '" + temporary + "'");
+    os::close(fd_.get());
+    os::rm(temporary);
+    return error;
+  }
+
+  // Sync the directory too, otherwise the rename (and with it any
+  // record appended to the compacted journal) might not survive a
+  // crash.
+  Try<Nothing> sync = syncDirectory(path);
+
+  if (sync.isSome()) {
+    VLOG(1) << "Compacted journal '" << path << "' from " << journaled
+            << " to " << compacted;
+  }
+
+  // NOTE: The path refers to the compacted journal now, whether or
+  // not the directory got synced, so that's where to keep appending.
+  os::close(fd);
+  fd = fd_.get();
+  dirty = false;
+  journaled = compacted;
+
+  if (sync.isError()) {
+    return Error("Failed to sync the directory of '" + path + "': " +
+                 sync.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<string> Journal::relative(const string& path) const
+{
+  if (!strings::startsWith(path, rootDir + "/")) {
+    return Error("'" + path + "' is not under '" + rootDir + "'");
+  }
+
+  return strings::trim(path.substr(rootDir.size()), "/");
+}
+
+
+void Journal::apply(const JournalRecord& record)
+{
+  switch (record.type()) {
+    case JournalRecord::WRITE:
+      if (files.contains(record.path())) {
+        contents -= Bytes(files[record.path()].size());
+      } else {
+        add(record.path());
+      }
+      files[record.path()] = record.data();
+      contents += Bytes(record.data().size());
+      break;
+    case JournalRecord::APPEND:
+      if (!files.contains(record.path())) {
+        add(record.path());
+      }
+      files[record.path()] += record.data();
+      contents += Bytes(record.data().size());
+      break;
+    case JournalRecord::REMOVE: {
+      if (files.contains(record.path())) {
+        remove_(record.path());
+      }
+
+      if (directories.contains(record.path())) {
+        // Collect first, erasing invalidates the iteration.
+        list<string> removed;
+        foreachkey (const string& file, files) {
+          if (strings::startsWith(file, record.path() + "/")) {
+            removed.push_back(file);
+          }
+        }
+
+        foreach (const string& file, removed) {
+          remove_(file);
+        }
+      }
+      break;
+    }
+    default:
+      LOG(WARNING) << "Ignoring unknown journal record type "
+                   << record.type();
+      break;
+  }
+}
+
+
+void Journal::add(const string& file)
+{
+  files[file] = "";
+  contents += Bytes(file.size());
+
+  size_t slash = file.rfind('/');
+  while (slash != string::npos && slash > 0) {
+    directories[file.substr(0, slash)]++;
+    slash = file.rfind('/', slash - 1);
+  }
+}
+
+
+void Journal::remove_(const string& file)
+{
+  contents -= Bytes(file.size() + files[file].size());
+  files.erase(file);
+
+  size_t slash = file.rfind('/');
+  while (slash != string::npos && slash > 0) {
+    const string& directory = file.substr(0, slash);
+    if (--directories[directory] == 0) {
+      directories.erase(directory);
+    }
+    slash = file.rfind('/', slash - 1);
+  }
+}
+
+} // namespace state {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
@@ -0,0 +1,132 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SLAVE_JOURNAL_HPP__
+#define __SLAVE_JOURNAL_HPP__
+
+#include <pthread.h>
+
+#include <list>
+#include <string>
+
+#include <stout/bytes.hpp>
+#include <stout/hashmap.hpp>
+#include <stout/nothing.hpp>
+#include <stout/option.hpp>
+#include <stout/try.hpp>
+
+#include "messages/messages.hpp"
+
+namespace mesos {
+namespace internal {
+namespace slave {
+namespace state {
+
+// A single append-only file holding the contents of all the files
+// checkpointed under a root directory, as an alternative to creating
+// (and later walking) a file per checkpoint. Each modification of a
+// file is appended as a record and the whole journal is replayed into
+// memory when opened. Once the journal grows to several times the
+// size of its contents it gets compacted, i.e., rewritten with a
+// single record per file.
+// NOTE: All paths are absolute paths under the root directory and
+// the journal is safe to use from multiple threads.
+class Journal
+{
+public:
+  // Opens the journal in 'rootDir', creating it if it doesn't exist
+  // and replaying it otherwise.
+  static Try<Journal*> open(const std::string& rootDir);
+
+  ~Journal();
+
+  const std::string& root() const { return rootDir; }
+
+  // Replaces the contents of the file at 'path'. Like writing a file
+  // this doesn't sync the journal.
+  Try<Nothing> write(const std::string& path, const std::string& data);
+
+  // Appends to the contents of the file at 'path' and, unless asked
+  // not to, syncs the journal (i.e., like appending to a file opened
+  // with O_SYNC).
+  Try<Nothing> append(
+      const std::string& path,
+      const std::string& data,
+      bool sync = true);
+
+  // Syncs any records that have been appended since the last sync.
+  Try<Nothing> sync();
+
+  // Removes the file at 'path', or all files under 'path'.
+  Try<Nothing> remove(const std::string& path);
+
+  // Returns the contents of the file at 'path', if it exists.
+  Option<std::string> read(const std::string& path);
+
+  // Returns true if there is a file at 'path' or any files under it.
+  bool exists(const std::string& path);
+
+  // Returns the (absolute) paths of the files and directories that
+  // match 'pattern' (see fnmatch(3)).
+  std::list<std::string> glob(const std::string& pattern);
+
+  // Returns the size of the journal file.
+  Bytes size();
+
+private:
+  Journal(const std::string& rootDir, int fd);
+
+  // Appends the record (syncing if requested) and applies it.
+  Try<Nothing> _append(const JournalRecord& record, bool sync);
+
+  // Rewrites the journal with one record per file.
+  Try<Nothing> compact();
+
+  // Returns 'path' relative to the root directory.
+  Try<std::string> relative(const std::string& path) const;
+
+  void apply(const JournalRecord& record);
+
+  // Adds the file to (or removes it from) 'files' and 'directories'.
+  void add(const std::string& file);
+  void remove_(const std::string& file);
+
+  const std::string rootDir;
+
+  int fd;
+
+  // Contents of the files, keyed by their relative path.
+  hashmap<std::string, std::string> files;
+
+  // Number of files under each (relative) directory.
+  hashmap<std::string, size_t> directories;
+
+  bool dirty; // Whether there are records that haven't been synced.
+
+  Bytes journaled; // Size of the journal file.
+  Bytes contents; // Total size of 'files' (including paths).
+
+  pthread_mutex_t mutex;
+};
+
+} // namespace state {
+} // namespace slave {
+} // namespace internal {
+} // namespace mesos {
+
+#endif // __SLAVE_JOURNAL_HPP__
@@ -16,6 +16,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <string>
@@ -32,9 +33,12 @@
 #include <process/process.hpp>
 #include <process/statistics.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/json.hpp>
 #include <stout/lambda.hpp>
 #include <stout/protobuf.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 
 #include "slave/containerizer/containerizer.hpp"
 #include "slave/monitor.hpp"
@@ -72,10 +76,11 @@ Future<Nothing> ResourceMonitorProcess::start(
   monitored[containerId] =
       MonitoringInfo(executorInfo,
                      MONITORING_TIME_SERIES_WINDOW,
-                     MONITORING_TIME_SERIES_CAPACITY);
+                     MONITORING_TIME_SERIES_CAPACITY,
+                     interval);
 
-  // Schedule the resource collection.
-  delay(interval, self(), &Self::collect, containerId, interval);
+  // Reschedule the collection in case this container is due first.
+  schedule();
 
   return Nothing();
 }
@@ -92,32 +97,114 @@ Future<Nothing> ResourceMonitorProcess::stop(
   archive.push_back(monitored[containerId]);
   monitored.erase(containerId);
 
+  schedule();
+
   return Nothing();
 }
 
 
-void ResourceMonitorProcess::collect(
-    const ContainerID& containerId,
-    const Duration& interval)
+void ResourceMonitorProcess::schedule()
 {
-  // Has monitoring stopped?
-  if (!monitored.contains(containerId)) {
+  // The collection in progress schedules the next one once done.
+  if (collecting) {
+    return;
+  }
+
+  if (timer.isSome()) {
+    Timer::cancel(timer.get());
+    timer = None();
+  }
+
+  Option<Time> next;
+  foreachvalue (const MonitoringInfo& info, monitored) {
+    if (next.isNone() || info.next < next.get()) {
+      next = info.next;
+    }
+  }
+
+  if (next.isSome()) {
+    timer = delay(
+        std::max(next.get() - Clock::now(), Duration::zero()),
+        self(),
+        &Self::collect);
+  }
+}
+
+
+// Gives up on collecting the usage of a container, e.g., because the
+// containerizer is stuck, so that it doesn't hold up the collection of
+// the other containers.
+static Future<ResourceStatistics> timedout(
+    Future<ResourceStatistics> statistics,
+    const Duration& timeout)
+{
+  statistics.discard();
+  return Failure("Timed out after " + stringify(timeout));
+}
+
+
+void ResourceMonitorProcess::collect()
+{
+  timer = None();
+
+  const Time now = Clock::now();
+
+  list<ContainerID> containerIds;
+  list<Future<ResourceStatistics> > futures;
+
+  foreachkey (const ContainerID& containerId, monitored) {
+    MonitoringInfo& info = monitored[containerId];
+
+    if (info.next <= now) {
+      containerIds.push_back(containerId);
+      futures.push_back(containerizer->usage(containerId)
+        .after(info.interval,
+               lambda::bind(&timedout, lambda::_1, info.interval)));
+
+      // NOTE: The next collection is an interval after this one
+      // started, a slow collection delays it further though since
+      // collections don't overlap.
+      info.next = now + info.interval;
+    }
+  }
+
+  if (containerIds.empty()) {
+    schedule();
     return;
   }
 
-  containerizer->usage(containerId)
-    .onAny(defer(self(),
-                 &Self::_collect,
-                 lambda::_1,
-                 containerId,
-                 interval));
+  collecting = true;
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  await(futures)
+    .onAny(defer(self(), &Self::_collect, containerIds, futures, stopwatch));
 }
 
 
 void ResourceMonitorProcess::_collect(
-    const Future<ResourceStatistics>& statistics,
+    const list<ContainerID>& containerIds,
+    const list<Future<ResourceStatistics> >& futures,
+    const Stopwatch& stopwatch)
+{
+  collecting = false;
+
+  VLOG(1) << "Collected the resource usage of " << containerIds.size()
+          << " containers in " << stopwatch.elapsed();
+
+  list<ContainerID>::const_iterator containerId = containerIds.begin();
+  foreach (const Future<ResourceStatistics>& statistics, futures) {
+    add(*containerId++, statistics);
+  }
+
+  schedule();
+}
+
+
+void ResourceMonitorProcess::add(
     const ContainerID& containerId,
-    const Duration& interval)
+    const Future<ResourceStatistics>& statistics)
 {
   // Has monitoring been stopped?
   if (!monitored.contains(containerId)) {
@@ -151,14 +238,31 @@ void ResourceMonitorProcess::_collect(
                  << "' for executor '" << executorId
                  << "' of framework '" << frameworkId << ": " << time.error();
     } else {
+      MonitoringInfo& info = monitored[containerId];
+
+      // Derive the throttling since the previous collection, if
+      // the container is limited by CFS.
+      Option<TimeSeries<ResourceStatistics>::Value> previous =
+        info.statistics.latest();
+
+      if (previous.isSome() &&
+          previous.get().time < time.get() &&
+          previous.get().data.has_cpus_nr_periods() &&
+          statistics.get().has_cpus_nr_periods() &&
+          statistics.get().cpus_nr_periods() >
+            previous.get().data.cpus_nr_periods()) {
+        const uint32_t periods = statistics.get().cpus_nr_periods() -
+          previous.get().data.cpus_nr_periods();
+        const uint32_t throttled = statistics.get().cpus_nr_throttled() -
+          previous.get().data.cpus_nr_throttled();
+
+        info.throttling.set((double) throttled / periods, time.get());
+      }
+
       // Add the statistics to the time series.
-      monitored[containerId].statistics.set(
-          statistics.get(), time.get());
+      info.statistics.set(statistics.get(), time.get());
     }
   }
-
-  // Schedule the next collection.
-  delay(interval, self(), &Self::collect, containerId, interval);
 }
 
 
@@ -234,6 +338,33 @@ Future<http::Response> ResourceMonitorProcess::__statistics(
 }
 
 
+Future<http::Response> ResourceMonitorProcess::throttling(
+    const http::Request& request)
+{
+  JSON::Array result;
+
+  foreachvalue (const MonitoringInfo& info, monitored) {
+    JSON::Array throttling;
+    foreach (const TimeSeries<double>::Value& value,
+             info.throttling.get()) {
+      JSON::Object sample;
+      sample.values["timestamp"] = value.time.secs();
+      sample.values["ratio"] = value.data;
+      throttling.values.push_back(sample);
+    }
+
+    JSON::Object entry;
+    entry.values["framework_id"] = info.executorInfo.framework_id().value();
+    entry.values["executor_id"] = info.executorInfo.executor_id().value();
+    entry.values["throttling"] = throttling;
+
+    result.values.push_back(entry);
+  }
+
+  return http::OK(result, request.query.get("jsonp"));
+}
+
+
 const string ResourceMonitorProcess::STATISTICS_HELP = HELP(
     TLDR(
         "Retrieve resource monitoring information."),
@@ -259,10 +390,15 @@ const string ResourceMonitorProcess::STATISTICS_HELP = HELP(
         "        \"cpus_system_time_secs\":34501.45,",
         "        \"cpus_throttled_time_secs\":352.597023453,",
         "        \"cpus_user_time_secs\":96348.84,",
+        "        \"disk_limit_bytes\":10737418240,",
+        "        \"disk_used_bytes\":2147483648,",
         "        \"mem_anon_bytes\":4845449216,",
+        "        \"mem_critical_pressure_counter\":0,",
         "        \"mem_file_bytes\":260165632,",
         "        \"mem_limit_bytes\":7650410496,",
+        "        \"mem_low_pressure_counter\":52,",
         "        \"mem_mapped_file_bytes\":7159808,",
+        "        \"mem_medium_pressure_counter\":3,",
         "        \"mem_rss_bytes\":5105614848,",
         "        \"timestamp\":1388534400.0",
         "    }",
@@ -270,6 +406,32 @@ const string ResourceMonitorProcess::STATISTICS_HELP = HELP(
         "```"));
 
 
+const string ResourceMonitorProcess::THROTTLING_HELP = HELP(
+    TLDR(
+        "Retrieve the CPU throttling of containers over time."),
+    USAGE(
+        "/throttling.json"),
+    DESCRIPTION(
+        "Returns, for each container running under this slave, the",
+        "fraction of CFS periods in which the container got throttled",
+        "between consecutive resource usage collections. Containers that",
+        "aren't capped by CFS (see --cgroups_enable_cfs) have no samples.",
+        "",
+        "Example:",
+        "",
+        "```",
+        "[{",
+        "    \"executor_id\":\"executor\",",
+        "    \"framework_id\":\"framework\",",
+        "    \"throttling\":",
+        "    [",
+        "        {\"ratio\":0.02,\"timestamp\":1388534400.0},",
+        "        {\"ratio\":0.15,\"timestamp\":1388534401.0}",
+        "    ]",
+        "}]",
+        "```"));
+
+
 ResourceMonitor::ResourceMonitor(Containerizer* containerizer)
 {
   process = new ResourceMonitorProcess(containerizer);
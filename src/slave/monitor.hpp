@@ -19,6 +19,7 @@
 #ifndef __SLAVE_MONITOR_HPP__
 #define __SLAVE_MONITOR_HPP__
 
+#include <list>
 #include <map>
 #include <string>
 
@@ -26,15 +27,19 @@
 
 #include <mesos/mesos.hpp>
 
+#include <process/clock.hpp>
 #include <process/future.hpp>
 #include <process/limiter.hpp>
 #include <process/statistics.hpp>
+#include <process/time.hpp>
+#include <process/timer.hpp>
 
 #include <stout/cache.hpp>
 #include <stout/duration.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/nothing.hpp>
 #include <stout/option.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/try.hpp>
 
 #include "common/type_utils.hpp"
@@ -96,7 +101,8 @@ public:
     : ProcessBase("monitor"),
       containerizer(_containerizer),
       limiter(2, Seconds(1)), // 2 permits per second.
-      archive(MONITORING_ARCHIVED_TIME_SERIES) {}
+      archive(MONITORING_ARCHIVED_TIME_SERIES),
+      collecting(false) {}
 
   virtual ~ResourceMonitorProcess() {}
 
@@ -115,19 +121,32 @@ protected:
           STATISTICS_HELP,
           &ResourceMonitorProcess::statistics);
 
+    route("/throttling.json",
+          THROTTLING_HELP,
+          &ResourceMonitorProcess::throttling);
+
     // TODO(bmahler): Add a archive.json endpoint that exposes
     // historical information, once we have path parameters for
     // routes.
   }
 
 private:
-  void collect(
-      const ContainerID& containerId,
-      const Duration& interval);
+  // Schedules the next collection, for when the earliest due
+  // container is due.
+  void schedule();
+
+  // Collects the usage of all the containers that are due in a
+  // single pass, rather than on a timer per container.
+  void collect();
   void _collect(
-      const process::Future<ResourceStatistics>& statistics,
+      const std::list<ContainerID>& containerIds,
+      const std::list<process::Future<ResourceStatistics> >& statistics,
+      const Stopwatch& stopwatch);
+
+  // Adds the collected usage to the container's time series.
+  void add(
       const ContainerID& containerId,
-      const Duration& interval);
+      const process::Future<ResourceStatistics>& statistics);
 
   // This is a convenience struct for bundling usage information.
   struct Usage
@@ -152,7 +171,13 @@ private:
       const std::list<Usage>& usages,
       const process::http::Request& request);
 
+  // Returns the time series of the fraction of CFS periods in which
+  // each container got throttled. Requests have no parameters.
+  process::Future<process::http::Response> throttling(
+      const process::http::Request& request);
+
   static const std::string STATISTICS_HELP;
+  static const std::string THROTTLING_HELP;
 
   Containerizer* containerizer;
 
@@ -166,11 +191,22 @@ private:
 
     MonitoringInfo(const ExecutorInfo& _executorInfo,
                    const Duration& window,
-                   size_t capacity)
-      : executorInfo(_executorInfo), statistics(window, capacity) {}
+                   size_t capacity,
+                   const Duration& _interval)
+      : executorInfo(_executorInfo),
+        statistics(window, capacity),
+        throttling(window, capacity),
+        interval(_interval),
+        next(process::Clock::now() + _interval) {}
 
     ExecutorInfo executorInfo;   // Non-const for assignability.
     process::TimeSeries<ResourceStatistics> statistics;
+
+    // Fraction of the CFS periods in which the container got
+    // throttled, between consecutive collections.
+    process::TimeSeries<double> throttling;
+    Duration interval;
+    process::Time next; // When the usage is to be collected next.
   };
 
   // The monitoring info is stored for each monitored container.
@@ -178,6 +214,10 @@ private:
 
   // Fixed-size history of monitoring information.
   boost::circular_buffer<MonitoringInfo> archive;
+
+  // The next collection, unless collecting.
+  Option<process::Timer> timer;
+  bool collecting;
 };
 
 } // namespace slave {
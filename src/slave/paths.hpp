@@ -45,6 +45,7 @@ const std::string LATEST_SYMLINK = "latest";
 
 // File names.
 const std::string BOOT_ID_FILE = "boot_id";
+const std::string JOURNAL_FILE = "journal";
 const std::string SLAVE_INFO_FILE = "slave.info";
 const std::string FRAMEWORK_PID_FILE = "framework.pid";
 const std::string FRAMEWORK_INFO_FILE = "framework.info";
@@ -63,6 +64,8 @@ const std::string SLAVE_PATH =
   path::join(ROOT_PATH, "slaves", "%s");
 const std::string BOOT_ID_PATH =
   path::join(ROOT_PATH, BOOT_ID_FILE);
+const std::string JOURNAL_PATH =
+  path::join(ROOT_PATH, JOURNAL_FILE);
 const std::string SLAVE_INFO_PATH =
   path::join(SLAVE_PATH, SLAVE_INFO_FILE);
 const std::string FRAMEWORK_PATH =
@@ -119,6 +122,12 @@ inline std::string getBootIdPath(const std::string& rootDir)
 }
 
 
+inline std::string getJournalPath(const std::string& rootDir)
+{
+  return strings::format(JOURNAL_PATH, rootDir).get();
+}
+
+
 inline std::string getSlaveInfoPath(
     const std::string& rootDir,
     const SlaveID& slaveId)
@@ -106,7 +106,8 @@ Slave::Slave(const slave::Flags& _flags,
     monitor(containerizer),
     statusUpdateManager(new StatusUpdateManager()),
     metaDir(paths::getMetaRootDir(flags.work_dir)),
-    recoveryErrors(0) {}
+    recoveryErrors(0),
+    launching(0) {}
 
 
 Slave::~Slave()
@@ -121,6 +122,10 @@ Slave::~Slave()
   }
 
   delete statusUpdateManager;
+
+  // Nothing gets checkpointed by us once the status update manager
+  // is gone.
+  state::closeJournal(metaDir);
 }
 
 
@@ -277,11 +282,13 @@ void Slave::initialize()
   // Install protobuf handlers.
   install<SlaveRegisteredMessage>(
       &Slave::registered,
-      &SlaveRegisteredMessage::slave_id);
+      &SlaveRegisteredMessage::slave_id,
+      &SlaveRegisteredMessage::version);
 
   install<SlaveReregisteredMessage>(
       &Slave::reregistered,
-      &SlaveReregisteredMessage::slave_id);
+      &SlaveReregisteredMessage::slave_id,
+      &SlaveReregisteredMessage::version);
 
   install<RunTaskMessage>(
       &Slave::runTask,
@@ -318,6 +325,10 @@ void Slave::initialize()
       &StatusUpdateAcknowledgementMessage::task_id,
       &StatusUpdateAcknowledgementMessage::uuid);
 
+  install<StatusUpdateAcknowledgementsMessage>(
+      &Slave::statusUpdateAcknowledgements,
+      &StatusUpdateAcknowledgementsMessage::acknowledgements);
+
   install<RegisterExecutorMessage>(
       &Slave::registerExecutor,
       &RegisterExecutorMessage::framework_id,
@@ -373,7 +384,16 @@ void Slave::initialize()
             << ". Please run the slave with '--help' to see the valid options";
   }
 
+  if (flags.checkpoint && flags.checkpoint_journal) {
+    Try<Nothing> journal = state::journal(metaDir);
+    if (journal.isError()) {
+      EXIT(1) << "Failed to open the checkpoint journal: " << journal.error();
+    }
+  }
+
   // Do recovery.
+  recovery.stopwatch.start();
+
   async(&state::recover, metaDir, flags.strict)
     .then(defer(self(), &Slave::recover, lambda::_1))
     .then(defer(self(), &Slave::_recover))
@@ -524,7 +544,10 @@ void Slave::detected(const Future<Option<MasterInfo> >& _master)
 }
 
 
-void Slave::registered(const UPID& from, const SlaveID& slaveId)
+void Slave::registered(
+    const UPID& from,
+    const SlaveID& slaveId,
+    const string& version)
 {
   if (master != from) {
     LOG(WARNING) << "Ignoring registration message from " << from
@@ -533,6 +556,8 @@ void Slave::registered(const UPID& from, const SlaveID& slaveId)
     return;
   }
 
+  statusUpdateManager->registered(version);
+
   switch(state) {
     case DISCONNECTED: {
       CHECK_SOME(master);
@@ -574,7 +599,10 @@ void Slave::registered(const UPID& from, const SlaveID& slaveId)
 }
 
 
-void Slave::reregistered(const UPID& from, const SlaveID& slaveId)
+void Slave::reregistered(
+    const UPID& from,
+    const SlaveID& slaveId,
+    const string& version)
 {
   if (master != from) {
     LOG(WARNING) << "Ignoring re-registration message from " << from
@@ -583,6 +611,8 @@ void Slave::reregistered(const UPID& from, const SlaveID& slaveId)
     return;
   }
 
+  statusUpdateManager->registered(version);
+
   switch(state) {
     case DISCONNECTED:
       CHECK_SOME(master);
@@ -843,7 +873,9 @@ void Slave::runTask(
     }
   }
 
-  // Run the task after the unschedules are done.
+  // Run the task after the unschedules are done. NOTE: Unscheduling
+  // a directory that is being removed only completes once it is gone,
+  // so '_runTask()' never creates directories that are then removed.
   unschedule.onAny(
       defer(self(),
             &Self::_runTask,
@@ -1369,6 +1401,20 @@ void Slave::statusUpdateAcknowledgement(
 }
 
 
+void Slave::statusUpdateAcknowledgements(
+    const vector<StatusUpdateAcknowledgementMessage>& acknowledgements)
+{
+  foreach (const StatusUpdateAcknowledgementMessage& acknowledgement,
+           acknowledgements) {
+    statusUpdateAcknowledgement(
+        acknowledgement.slave_id(),
+        acknowledgement.framework_id(),
+        acknowledgement.task_id(),
+        acknowledgement.uuid());
+  }
+}
+
+
 void Slave::_statusUpdateAcknowledgement(
     const Future<bool>& future,
     const TaskID& taskId,
@@ -1704,6 +1750,22 @@ void Slave::reregisterExecutor(
           statusUpdate(update, UPID());
         }
       }
+
+      // Finish recovery without waiting for the re-register timeout
+      // if this was the last executor we were waiting for.
+      bool reregistering = false;
+      foreachvalue (Framework* framework_, frameworks) {
+        foreachvalue (Executor* executor_, framework_->executors) {
+          if (executor_->state == Executor::REGISTERING) {
+            reregistering = true;
+          }
+        }
+      }
+
+      if (!reregistering) {
+        LOG(INFO) << "All executors have re-registered";
+        reregisterExecutorTimeout();
+      }
       break;
     }
     default:
@@ -1718,6 +1780,12 @@ void Slave::reregisterExecutor(
 
 void Slave::reregisterExecutorTimeout()
 {
+  // Recovery might have finished early, i.e., once all the executors
+  // re-registered (see 'reregisterExecutor').
+  if (!recovered.future().isPending()) {
+    return;
+  }
+
   CHECK(state == RECOVERING || state == TERMINATING) << state;
 
   LOG(INFO) << "Cleaning up un-reregistered executors";
@@ -2059,12 +2127,75 @@ void _monitor(
   }
 }
 
+void Slave::admit()
+{
+  while (!launches.empty() &&
+         (flags.executor_launch_concurrency == 0 ||
+          launching < flags.executor_launch_concurrency)) {
+    const Launch launch = launches.front();
+    launches.pop_front();
+
+    // NOTE: A queued executor can't have terminated (nor been
+    // removed) since its container doesn't exist yet, and it gets
+    // taken off the queue when it's shut down (see
+    // 'shutdownExecutor').
+    Framework* framework = getFramework(launch.frameworkId);
+    CHECK_NOTNULL(framework);
+
+    Executor* executor = framework->getExecutor(launch.executorId);
+    CHECK_NOTNULL(executor);
+
+    CHECK_EQ(Executor::REGISTERING, executor->state);
+
+    launching++;
+
+    // Launch the container.
+    containerizer->launch(
+        executor->containerId,
+        launch.executorInfo,
+        executor->directory,
+        flags.switch_user ? Option<string>(framework->info.user()) : None(),
+        info.id(),
+        self(),
+        framework->info.checkpoint())
+      .onAny(defer(self(),
+                   &Self::executorLaunched,
+                   framework->id,
+                   executor->id,
+                   executor->containerId,
+                   lambda::_1));
+
+    // Set up callback for executor termination.
+    containerizer->wait(executor->containerId)
+      .onAny(defer(self(),
+                   &Self::executorTerminated,
+                   framework->id,
+                   executor->id,
+                   lambda::_1));
+
+    // Make sure the executor registers within the given timeout.
+    delay(flags.executor_registration_timeout,
+          self(),
+          &Slave::registerExecutorTimeout,
+          framework->id,
+          executor->id,
+          executor->containerId);
+  }
+}
+
+
 void Slave::executorLaunched(
     const FrameworkID& frameworkId,
     const ExecutorID& executorId,
     const ContainerID& containerId,
     const Future<Nothing>& future)
 {
+  CHECK(launching > 0);
+  launching--;
+
+  // Launch the next queued executors, if any.
+  admit();
+
   if (!future.isReady()) {
     // The containerizer will clean up if the launch fails we'll just log this
     // and leave the executor registration to timeout.
@@ -2330,7 +2461,7 @@ void Slave::removeExecutor(Framework* framework, Executor* executor)
   if (executor->checkpoint) {
     const string& path = paths::getExecutorSentinelPath(
         metaDir, info.id(), framework->id, executor->id, executor->containerId);
-    CHECK_SOME(os::touch(path));
+    CHECK_SOME(state::checkpoint(path, ""));
   }
 
   // TODO(vinod): Move the responsibility of gc'ing to the
@@ -2470,6 +2601,35 @@ void Slave::shutdownExecutor(Framework* framework, Executor* executor)
 
   executor->state = Executor::TERMINATING;
 
+  // An executor still waiting to be launched (see 'admit') has no
+  // container to shut down, so it terminates right away.
+  // NOTE: We dispatch rather than call 'executorTerminated' since it
+  // might remove the executor (and the framework) while the caller
+  // (e.g., 'shutdownFramework') still uses them.
+  for (std::deque<Launch>::iterator launch = launches.begin();
+       launch != launches.end();
+       ++launch) {
+    if (launch->frameworkId == framework->id &&
+        launch->executorId == executor->id) {
+      launches.erase(launch);
+
+      LOG(INFO) << "Not launching executor '" << executor->id
+                << "' of framework " << framework->id
+                << " because it was shut down";
+
+      dispatch(self(),
+               &Slave::executorTerminated,
+               framework->id,
+               executor->id,
+               Future<Containerizer::Termination>(
+                   Containerizer::Termination(
+                       None(),
+                       false,
+                       "Executor was shut down before it was launched")));
+      return;
+    }
+  }
+
   // If the executor hasn't yet registered, this message
   // will be dropped to the floor!
   send(executor->pid, ShutdownExecutorMessage());
@@ -2655,6 +2815,8 @@ void Slave::_checkDiskUsage(const Future<Try<double> >& usage)
 
 Future<Nothing> Slave::recover(const Result<SlaveState>& _state)
 {
+  recovery.parse = recovery.stopwatch.elapsed();
+
   if (_state.isError()) {
     return Failure(_state.error());
   }
@@ -2705,12 +2867,17 @@ Future<Nothing> Slave::recover(const Result<SlaveState>& _state)
 Future<Nothing> Slave::_recoverContainerizer(
     const Option<state::SlaveState>& state)
 {
+  recovery.statusUpdates = recovery.stopwatch.elapsed() - recovery.parse;
+
   return containerizer->recover(state);
 }
 
 
 Future<Nothing> Slave::_recover()
 {
+  recovery.containerizer = recovery.stopwatch.elapsed() -
+    recovery.parse - recovery.statusUpdates;
+
   foreachvalue (Framework* framework, frameworks) {
     foreachvalue (Executor* executor, framework->executors) {
       // Monitor the executor.
@@ -2794,7 +2961,14 @@ void Slave::__recover(const Future<Nothing>& future)
       << "Step 2: Restart the slave.";
   }
 
-  LOG(INFO) << "Finished recovery";
+  recovery.reregistration = recovery.stopwatch.elapsed() -
+    recovery.parse - recovery.statusUpdates - recovery.containerizer;
+
+  LOG(INFO) << "Finished recovery in " << recovery.stopwatch.elapsed()
+            << " (parse: " << recovery.parse
+            << ", status updates: " << recovery.statusUpdates
+            << ", containerizer: " << recovery.containerizer
+            << ", reregistration: " << recovery.reregistration << ")";
 
   CHECK_EQ(RECOVERING, state);
   state = DISCONNECTED;
@@ -2990,45 +3164,26 @@ Executor* Framework::launchExecutor(
                  lambda::_1,
                  executor->directory));
 
-  // Tell the containerizer to launch the executor.
+  // Queue the executor to be launched by the containerizer (see
+  // 'Slave::admit').
   // NOTE: We modify the ExecutorInfo to include the task's
   // resources when launching the executor so that the containerizer
   // has non-zero resources to work with when the executor has
   // no resources. This should be revisited after MESOS-600.
-  ExecutorInfo executorInfo_ = executor->info;
-  executorInfo_.mutable_resources()->MergeFrom(taskInfo.resources());
-
-  // Launch the container.
-  slave->containerizer->launch(
-      containerId,
-      executorInfo_, // modified to include the task's resources
-      executor->directory,
-      slave->flags.switch_user ? Option<string>(info.user()) : None(),
-      slave->info.id(),
-      slave->self(),
-      info.checkpoint())
-    .onAny(defer(slave,
-                 &Slave::executorLaunched,
-                 id,
-                 executor->id,
-                 containerId,
-                 lambda::_1));
-
-  // Set up callback for executor termination.
-  slave->containerizer->wait(containerId)
-    .onAny(defer(slave,
-                 &Slave::executorTerminated,
-                 id,
-                 executor->id,
-                 lambda::_1));
-
-  // Make sure the executor registers within the given timeout.
-  delay(slave->flags.executor_registration_timeout,
-        slave,
-        &Slave::registerExecutorTimeout,
-        id,
-        executor->id,
-        containerId);
+  Slave::Launch launch;
+  launch.frameworkId = id;
+  launch.executorId = executor->id;
+  launch.executorInfo = executor->info;
+  launch.executorInfo.mutable_resources()->MergeFrom(taskInfo.resources());
+
+  slave->launches.push_back(launch);
+  slave->admit();
+
+  if (!slave->launches.empty()) {
+    LOG(INFO) << "Queued the launch of executor '" << executor->id
+              << "' of framework " << id << " behind "
+              << slave->launches.size() - 1 << " other launches";
+  }
 
   return executor;
 }
@@ -21,6 +21,7 @@
 
 #include <stdint.h>
 
+#include <deque>
 #include <list>
 #include <string>
 #include <vector>
@@ -36,6 +37,7 @@
 #include <process/protobuf.hpp>
 
 #include <stout/bytes.hpp>
+#include <stout/duration.hpp>
 #include <stout/linkedhashmap.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
@@ -43,6 +45,7 @@
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/uuid.hpp>
 
 #include "master/detector.hpp"
@@ -89,8 +92,14 @@ public:
 
   void shutdown(const process::UPID& from);
 
-  void registered(const process::UPID& from, const SlaveID& slaveId);
-  void reregistered(const process::UPID& from, const SlaveID& slaveId);
+  void registered(
+      const process::UPID& from,
+      const SlaveID& slaveId,
+      const std::string& version);
+  void reregistered(
+      const process::UPID& from,
+      const SlaveID& slaveId,
+      const std::string& version);
   void doReliableRegistration();
 
   void runTask(
@@ -171,12 +180,19 @@ public:
       const TaskID& taskId,
       const std::string& uuid);
 
+  void statusUpdateAcknowledgements(
+      const std::vector<StatusUpdateAcknowledgementMessage>& acknowledgements);
+
   void _statusUpdateAcknowledgement(
       const process::Future<bool>& future,
       const TaskID& taskId,
       const FrameworkID& frameworkId,
       const UUID& uuid);
 
+  // Launches the queued executors, in order, while fewer than
+  // --executor_launch_concurrency are being launched.
+  void admit();
+
   void executorLaunched(
       const FrameworkID& frameworkId,
       const ExecutorID& executorId,
@@ -365,6 +381,29 @@ private:
 
   // Indicates the number of errors ignored in "--no-strict" recovery mode.
   unsigned int recoveryErrors;
+
+  // Durations of the recovery phases (set as recovery progresses).
+  struct {
+    Stopwatch stopwatch; // Started when recovery starts.
+    Duration parse; // Reading the checkpointed state.
+    Duration statusUpdates; // Recovering the status update manager.
+    Duration containerizer; // Recovering the containerizer.
+    Duration reregistration; // Reconnecting with the executors.
+  } recovery;
+
+  // An executor waiting to be launched (see 'admit').
+  struct Launch
+  {
+    FrameworkID frameworkId;
+    ExecutorID executorId;
+
+    // Includes the resources of the task it gets launched for.
+    ExecutorInfo executorInfo;
+  };
+
+  std::deque<Launch> launches;
+
+  size_t launching; // Number of executors being launched.
 };
 
 
@@ -1,20 +1,30 @@
+#include <pthread.h>
+#include <string.h>
 #include <unistd.h>
 
 #include <glog/logging.h>
 
 #include <iostream>
+#include <set>
+#include <vector>
 
 #include <process/pid.hpp>
 
 #include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/format.hpp>
+#include <stout/lambda.hpp>
+#include <stout/memory.hpp>
 #include <stout/none.hpp>
 #include <stout/numify.hpp>
+#include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/try.hpp>
 
+#include "common/lock.hpp"
+
+#include "slave/journal.hpp"
 #include "slave/paths.hpp"
 #include "slave/state.hpp"
 
@@ -24,8 +34,214 @@ namespace slave {
 namespace state {
 
 using std::list;
-using std::string;
 using std::max;
+using std::set;
+using std::string;
+using std::vector;
+
+
+// The journals in use, keyed by their root directory, until they get
+// closed (see 'closeJournal').
+static hashmap<string, memory::shared_ptr<Journal> >* journals =
+  new hashmap<string, memory::shared_ptr<Journal> >();
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Returns the journal that the given path is checkpointed to, if any.
+// NOTE: A journal that gets closed stays open until the checkpoints
+// that looked it up are done with it.
+static memory::shared_ptr<Journal> lookup(const string& path)
+{
+  Lock lock(&mutex);
+
+  if (journals->empty()) {
+    return memory::shared_ptr<Journal>();
+  }
+
+  // Look up each of the parent directories of the path, rather than
+  // matching the path against every journal.
+  size_t slash = path.rfind('/');
+  while (slash != string::npos && slash > 0) {
+    const string& directory = path.substr(0, slash);
+    if (journals->contains(directory)) {
+      return (*journals)[directory];
+    }
+    slash = path.rfind('/', slash - 1);
+  }
+
+  return memory::shared_ptr<Journal>();
+}
+
+
+// The helpers below read checkpointed state from the journal, when
+// the path is journaled, falling back to the file system (e.g., for
+// state checkpointed before the journal was enabled).
+
+static bool exists(const string& path)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  return (journal.get() != NULL && journal->exists(path)) || os::exists(path);
+}
+
+
+static Try<string> read(const string& path)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    Option<string> data = journal->read(path);
+    if (data.isSome()) {
+      return data.get();
+    }
+  }
+
+  return os::read(path);
+}
+
+
+// Parses the next length prefixed protobuf (as written by
+// '::protobuf::write') from 'data' at 'offset', advancing 'offset'.
+// Like '::protobuf::read' None is returned at the end of 'data', as
+// well as for a partially written protobuf.
+template <typename T>
+static Result<T> parse(const string& data, size_t* offset)
+{
+  uint32_t size;
+  if (data.size() - *offset < sizeof(size)) {
+    return None();
+  }
+
+  memcpy((void*) &size, (void*) (data.data() + *offset), sizeof(size));
+
+  if (data.size() - *offset - sizeof(size) < size) {
+    return None();
+  }
+
+  T message;
+  if (!message.ParseFromArray(data.data() + *offset + sizeof(size), size)) {
+    return Error("Failed to deserialize message");
+  }
+
+  *offset += sizeof(size) + size;
+
+  return message;
+}
+
+
+template <typename T>
+static Result<T> read(const string& path)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    Option<string> data = journal->read(path);
+    if (data.isSome()) {
+      size_t offset = 0;
+      return parse<T>(data.get(), &offset);
+    }
+  }
+
+  return ::protobuf::read<T>(path);
+}
+
+
+static Try<list<string> > glob(const string& pattern)
+{
+  Try<list<string> > glob_ = os::glob(pattern);
+  if (glob_.isError()) {
+    return glob_;
+  }
+
+  memory::shared_ptr<Journal> journal = lookup(pattern);
+  if (journal.get() == NULL) {
+    return glob_;
+  }
+
+  // Directories can be both on disk and in the journal.
+  set<string> result(glob_.get().begin(), glob_.get().end());
+
+  foreach (const string& path, journal->glob(pattern)) {
+    result.insert(path);
+  }
+
+  return list<string>(result.begin(), result.end());
+}
+
+
+// Maximum number of threads, across all (possibly nested) calls to
+// 'parallel', used to recover the state. Recovery is dominated by
+// reading (lots of small) files so this mostly hides I/O latency.
+static const int MAX_RECOVERY_THREADS = 8;
+
+static int threads = 0; // Number of threads currently recovering.
+
+
+struct Jobs
+{
+  const vector<lambda::function<void(void)> >* jobs;
+  size_t next; // Index of the next job to run.
+};
+
+
+static void* run(void* arg)
+{
+  Jobs* jobs = (Jobs*) arg;
+
+  while (true) {
+    size_t index = __sync_fetch_and_add(&jobs->next, 1);
+    if (index >= jobs->jobs->size()) {
+      break;
+    }
+    (*jobs->jobs)[index]();
+  }
+
+  return NULL;
+}
+
+
+// Runs the jobs using as many threads as are available, including
+// the calling thread, and returns once all of them have finished.
+// NOTE: The calling thread always runs jobs too, so nested calls can
+// make progress even when no more threads are available.
+static void parallel(const vector<lambda::function<void(void)> >& jobs)
+{
+  Jobs jobs_;
+  jobs_.jobs = &jobs;
+  jobs_.next = 0;
+
+  vector<pthread_t> workers;
+  while (workers.size() + 1 < jobs.size()) {
+    if (__sync_add_and_fetch(&threads, 1) > MAX_RECOVERY_THREADS) {
+      __sync_fetch_and_sub(&threads, 1);
+      break;
+    }
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, run, &jobs_) != 0) {
+      PLOG(WARNING) << "Failed to create recovery thread";
+      __sync_fetch_and_sub(&threads, 1);
+      break;
+    }
+
+    workers.push_back(thread);
+  }
+
+  run(&jobs_);
+
+  foreach (const pthread_t& thread, workers) {
+    pthread_join(thread, NULL);
+    __sync_fetch_and_sub(&threads, 1);
+  }
+}
+
+
+// Stores the result of 'f' in 'result', for use with 'parallel'.
+template <typename T>
+static void call(
+    const lambda::function<Try<T>(void)>& f,
+    Option<Try<T> >* result)
+{
+  *result = f();
+}
 
 
 Result<SlaveState> recover(const string& rootDir, bool strict)
@@ -39,14 +255,23 @@ Result<SlaveState> recover(const string& rootDir, bool strict)
     return None();
   }
 
+  // Keep using the journal if there is one, otherwise we'd lose the
+  // state in it.
+  if (os::exists(paths::getJournalPath(rootDir))) {
+    Try<Nothing> journal_ = journal(rootDir);
+    if (journal_.isError()) {
+      return Error(journal_.error());
+    }
+  }
+
   // Did the machine reboot?
-  if (os::exists(paths::getBootIdPath(rootDir))) {
-    Try<string> read = os::read(paths::getBootIdPath(rootDir));
-    if (read.isSome()) {
+  if (exists(paths::getBootIdPath(rootDir))) {
+    Try<string> read_ = read(paths::getBootIdPath(rootDir));
+    if (read_.isSome()) {
       Try<string> id = os::bootId();
       CHECK_SOME(id);
 
-      if (id.get() != strings::trim(read.get())) {
+      if (id.get() != strings::trim(read_.get())) {
         LOG(INFO) << "Slave host rebooted";
         return None();
       }
@@ -94,14 +319,14 @@ Try<SlaveState> SlaveState::recover(
 
   // Read the slave info.
   const string& path = paths::getSlaveInfoPath(rootDir, slaveId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died before it registered
     // with the master.
     LOG(WARNING) << "Failed to find slave info file '" << path << "'";
     return state;
   }
 
-  const Result<SlaveInfo>& slaveInfo = ::protobuf::read<SlaveInfo>(path);
+  const Result<SlaveInfo>& slaveInfo = read<SlaveInfo>(path);
 
   if (slaveInfo.isError()) {
     const string& message = "Failed to read slave info from '" + path + "': " +
@@ -125,7 +350,7 @@ Try<SlaveState> SlaveState::recover(
   state.info = slaveInfo.get();
 
   // Find the frameworks.
-  Try<list<string> > frameworks = os::glob(
+  Try<list<string> > frameworks = glob(
       strings::format(paths::FRAMEWORK_PATH, rootDir, slaveId, "*").get());
 
   if (frameworks.isError()) {
@@ -133,13 +358,28 @@ Try<SlaveState> SlaveState::recover(
                  ": " + frameworks.error());
   }
 
-  // Recover each of the frameworks.
+  // Recover the frameworks in parallel.
+  vector<FrameworkID> frameworkIds;
   foreach (const string& path, frameworks.get()) {
     FrameworkID frameworkId;
     frameworkId.set_value(os::basename(path).get());
+    frameworkIds.push_back(frameworkId);
+  }
+
+  vector<Option<Try<FrameworkState> > > results(frameworkIds.size());
+  vector<lambda::function<void(void)> > jobs;
+  for (size_t i = 0; i < frameworkIds.size(); i++) {
+    lambda::function<Try<FrameworkState>(void)> f = lambda::bind(
+        &FrameworkState::recover, rootDir, slaveId, frameworkIds[i], strict);
 
-    Try<FrameworkState> framework =
-      FrameworkState::recover(rootDir, slaveId, frameworkId, strict);
+    jobs.push_back(lambda::bind(&call<FrameworkState>, f, &results[i]));
+  }
+
+  parallel(jobs);
+
+  for (size_t i = 0; i < frameworkIds.size(); i++) {
+    const FrameworkID& frameworkId = frameworkIds[i];
+    const Try<FrameworkState>& framework = results[i].get();
 
     if (framework.isError()) {
       return Error("Failed to recover framework " + frameworkId.value() +
@@ -166,7 +406,7 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework info.
   string path = paths::getFrameworkInfoPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died after creating the
     // framework directory but before it checkpointed the
     // framework info.
@@ -175,7 +415,7 @@ Try<FrameworkState> FrameworkState::recover(
   }
 
   const Result<FrameworkInfo>& frameworkInfo =
-    ::protobuf::read<FrameworkInfo>(path);
+    read<FrameworkInfo>(path);
 
   if (frameworkInfo.isError()) {
     message = "Failed to read framework info from '" + path + "': " +
@@ -201,14 +441,14 @@ Try<FrameworkState> FrameworkState::recover(
 
   // Read the framework pid.
   path = paths::getFrameworkPidPath(rootDir, slaveId, frameworkId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died after creating the
     // framework info but before it checkpointed the framework pid.
     LOG(WARNING) << "Failed to framework pid file '" << path << "'";
     return state;
   }
 
-  Try<string> pid = os::read(path);
+  Try<string> pid = read(path);
 
   if (pid.isError()) {
     message =
@@ -233,7 +473,7 @@ Try<FrameworkState> FrameworkState::recover(
   state.pid = process::UPID(pid.get());
 
   // Find the executors.
-  Try<list<string> > executors = os::glob(strings::format(
+  Try<list<string> > executors = glob(strings::format(
       paths::EXECUTOR_PATH, rootDir, slaveId, frameworkId, "*").get());
 
   if (executors.isError()) {
@@ -242,13 +482,33 @@ Try<FrameworkState> FrameworkState::recover(
         ": " + executors.error());
   }
 
-   // Recover the executors.
+  // Recover the executors in parallel.
+  vector<ExecutorID> executorIds;
   foreach (const string& path, executors.get()) {
     ExecutorID executorId;
     executorId.set_value(os::basename(path).get());
+    executorIds.push_back(executorId);
+  }
+
+  vector<Option<Try<ExecutorState> > > results(executorIds.size());
+  vector<lambda::function<void(void)> > jobs;
+  for (size_t i = 0; i < executorIds.size(); i++) {
+    lambda::function<Try<ExecutorState>(void)> f = lambda::bind(
+        &ExecutorState::recover,
+        rootDir,
+        slaveId,
+        frameworkId,
+        executorIds[i],
+        strict);
+
+    jobs.push_back(lambda::bind(&call<ExecutorState>, f, &results[i]));
+  }
+
+  parallel(jobs);
 
-    Try<ExecutorState> executor =
-      ExecutorState::recover(rootDir, slaveId, frameworkId, executorId, strict);
+  for (size_t i = 0; i < executorIds.size(); i++) {
+    const ExecutorID& executorId = executorIds[i];
+    const Try<ExecutorState>& executor = results[i].get();
 
     if (executor.isError()) {
       return Error("Failed to recover executor " + executorId.value() +
@@ -277,7 +537,7 @@ Try<ExecutorState> ExecutorState::recover(
   // Read the executor info.
   const string& path =
     paths::getExecutorInfoPath(rootDir, slaveId, frameworkId, executorId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died after creating the executor
     // directory but before it checkpointed the executor info.
     LOG(WARNING) << "Failed to find executor info file '" << path << "'";
@@ -285,7 +545,7 @@ Try<ExecutorState> ExecutorState::recover(
   }
 
   const Result<ExecutorInfo>& executorInfo =
-    ::protobuf::read<ExecutorInfo>(path);
+    read<ExecutorInfo>(path);
 
   if (executorInfo.isError()) {
     message = "Failed to read executor info from '" + path + "': " +
@@ -310,7 +570,7 @@ Try<ExecutorState> ExecutorState::recover(
   state.info = executorInfo.get();
 
   // Find the runs.
-  Try<list<string> > runs = os::glob(strings::format(
+  Try<list<string> > runs = glob(strings::format(
       paths::EXECUTOR_RUN_PATH,
       rootDir,
       slaveId,
@@ -385,7 +645,7 @@ Try<RunState> RunState::recover(
   string message;
 
   // Find the tasks.
-  Try<list<string> > tasks = os::glob(strings::format(
+  Try<list<string> > tasks = glob(strings::format(
       paths::TASK_PATH,
       rootDir,
       slaveId,
@@ -420,14 +680,14 @@ Try<RunState> RunState::recover(
   // Read the forked pid.
   string path = paths::getForkedPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died before the isolator
     // checkpointed the forked pid.
     LOG(WARNING) << "Failed to find executor forked pid file '" << path << "'";
     return state;
   }
 
-  Try<string> pid = os::read(path);
+  Try<string> pid = read(path);
 
   if (pid.isError()) {
     message = "Failed to read executor forked pid from '" + path +
@@ -461,7 +721,7 @@ Try<RunState> RunState::recover(
   path = paths::getLibprocessPidPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died before the executor
     // registered with the slave.
     LOG(WARNING)
@@ -469,7 +729,7 @@ Try<RunState> RunState::recover(
     return state;
   }
 
-  pid = os::read(path);
+  pid = read(path);
 
   if (pid.isError()) {
     message = "Failed to read executor libprocess pid from '" + path +
@@ -497,7 +757,7 @@ Try<RunState> RunState::recover(
   path = paths::getExecutorSentinelPath(
       rootDir, slaveId, frameworkId, executorId, containerId);
 
-  state.completed = os::exists(path);
+  state.completed = exists(path);
 
   return state;
 }
@@ -519,14 +779,14 @@ Try<TaskState> TaskState::recover(
   // Read the task info.
   string path = paths::getTaskInfoPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died after creating the task
     // directory but before it checkpointed the task info.
     LOG(WARNING) << "Failed to find task info file '" << path << "'";
     return state;
   }
 
-  const Result<Task>& task = ::protobuf::read<Task>(path);
+  const Result<Task>& task = read<Task>(path);
 
   if (task.isError()) {
     message = "Failed to read task info from '" + path + "': " + task.error();
@@ -552,13 +812,55 @@ Try<TaskState> TaskState::recover(
   // Read the status updates.
   path = paths::getTaskUpdatesPath(
       rootDir, slaveId, frameworkId, executorId, containerId, taskId);
-  if (!os::exists(path)) {
+  if (!exists(path)) {
     // This could happen if the slave died before it checkpointed
     // any status updates for this task.
     LOG(WARNING) << "Failed to find status updates file '" << path << "'";
     return state;
   }
 
+  // Read the updates from the journal, if the file is there.
+  memory::shared_ptr<Journal> journal = lookup(path);
+  Option<string> data = None();
+  if (journal.get() != NULL) {
+    data = journal->read(path);
+  }
+
+  if (data.isSome()) {
+    size_t offset = 0;
+    Result<StatusUpdateRecord> record = None();
+    while (true) {
+      // A partially written update can't be in the journal, as the
+      // journal truncates partially written records.
+      record = parse<StatusUpdateRecord>(data.get(), &offset);
+
+      if (!record.isSome()) {
+        break;
+      }
+
+      if (record.get().type() == StatusUpdateRecord::UPDATE) {
+        state.updates.push_back(record.get().update());
+      } else {
+        state.acks.insert(UUID::fromBytes(record.get().uuid()));
+      }
+    }
+
+    if (record.isError()) {
+      message = "Failed to read status updates from journaled file '" +
+                path + "': " + record.error();
+
+      if (strict) {
+        return Error(message);
+      } else {
+        LOG(WARNING) << message;
+        state.errors++;
+        return state;
+      }
+    }
+
+    return state;
+  }
+
   // Open the status updates file for reading and writing (for truncating).
   Try<int> fd = os::open(path, O_RDWR);
 
@@ -641,6 +943,22 @@ Try<Nothing> checkpoint(
     const string& path,
     const google::protobuf::Message& message)
 {
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    // Journal exactly what '::protobuf::write' writes to the file.
+    uint32_t size = message.ByteSize();
+    string data = string((char*) &size, sizeof(size));
+    data += message.SerializeAsString();
+
+    Try<Nothing> result = journal->write(path, data);
+    if (result.isError()) {
+      return Error("Failed to checkpoint \n" + message.DebugString() +
+                   "\n to '" + path + "': " + result.error());
+    }
+
+    return Nothing();
+  }
+
   // Create the base directory.
   Try<Nothing> result = os::mkdir(os::dirname(path).get());
   if (result.isError()) {
@@ -661,6 +979,17 @@ Try<Nothing> checkpoint(
 
 Try<Nothing> checkpoint(const std::string& path, const std::string& message)
 {
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    Try<Nothing> result = journal->write(path, message);
+    if (result.isError()) {
+      return Error("Failed to checkpoint '" + message + "' to '" + path +
+                   "': " + result.error());
+    }
+
+    return Nothing();
+  }
+
   // Create the base directory.
   Try<Nothing> result = os::mkdir(os::dirname(path).get());
   if (result.isError()) {
@@ -678,6 +1007,130 @@ Try<Nothing> checkpoint(const std::string& path, const std::string& message)
   return Nothing();
 }
 
+
+Try<Nothing> append(
+    const string& path,
+    const google::protobuf::Message& message,
+    bool sync)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    uint32_t size = message.ByteSize();
+    string data = string((char*) &size, sizeof(size));
+    data += message.SerializeAsString();
+
+    Try<Nothing> result = journal->append(path, data, sync);
+    if (result.isError()) {
+      return Error("Failed to append \n" + message.DebugString() +
+                   "\n to '" + path + "': " + result.error());
+    }
+
+    return Nothing();
+  }
+
+  // Create the base directory.
+  Try<Nothing> result = os::mkdir(os::dirname(path).get());
+  if (result.isError()) {
+    return Error("Failed to create directory '" + os::dirname(path).get() +
+                 "': " + result.error());
+  }
+
+  Try<int> fd = os::open(
+      path,
+      O_CREAT | O_WRONLY | O_APPEND | (sync ? O_SYNC : 0),
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
+
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  result = ::protobuf::write(fd.get(), message);
+  os::close(fd.get());
+
+  if (result.isError()) {
+    return Error("Failed to append \n" + message.DebugString() +
+                 "\n to '" + path + "': " + result.error());
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> sync(const string& path)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() != NULL) {
+    return journal->sync();
+  }
+
+  Try<int> fd = os::open(path, O_WRONLY);
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "': " + fd.error());
+  }
+
+  if (::fdatasync(fd.get()) != 0) {
+    ErrnoError error("Failed to sync '" + path + "'");
+    os::close(fd.get());
+    return error;
+  }
+
+  os::close(fd.get());
+  return Nothing();
+}
+
+
+Try<Nothing> remove(const string& path)
+{
+  memory::shared_ptr<Journal> journal = lookup(path);
+  if (journal.get() == NULL) {
+    return os::rmdir(path);
+  }
+
+  Try<Nothing> result = journal->remove(path);
+  if (result.isError()) {
+    return Error(result.error());
+  }
+
+  // Directories (e.g., of executor runs) are still on disk.
+  if (os::exists(path)) {
+    return os::rmdir(path);
+  }
+
+  return Nothing();
+}
+
+
+Try<Nothing> journal(const string& rootDir)
+{
+  Lock lock(&mutex);
+
+  if (journals->contains(rootDir)) {
+    return Nothing();
+  }
+
+  Try<Journal*> journal = Journal::open(rootDir);
+  if (journal.isError()) {
+    return Error("Failed to open journal: " + journal.error());
+  }
+
+  (*journals)[rootDir] = memory::shared_ptr<Journal>(journal.get());
+
+  return Nothing();
+}
+
+
+void closeJournal(const string& rootDir)
+{
+  Lock lock(&mutex);
+  journals->erase(rootDir);
+}
+
+
+bool journaled(const string& path)
+{
+  return lookup(path).get() != NULL;
+}
+
 } // namespace state {
 } // namespace slave {
 } // namespace internal {
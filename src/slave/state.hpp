@@ -77,6 +77,33 @@ Try<Nothing> checkpoint(
 // Checkpoints a string at the given path.
 Try<Nothing> checkpoint(const std::string& path, const std::string& message);
 
+// Checkpoints a protobuf by appending it to the file at the given
+// path, e.g., a status update record. The append is synced unless
+// 'sync' is false, in which case 'sync' below needs to be called.
+Try<Nothing> append(
+    const std::string& path,
+    const google::protobuf::Message& message,
+    bool sync = true);
+
+// Syncs the appends to the file at the given path.
+Try<Nothing> sync(const std::string& path);
+
+// Removes the checkpointed file or directory at the given path.
+Try<Nothing> remove(const std::string& path);
+
+// Makes all checkpoints under 'rootDir' go to a single append-only
+// journal (see slave/journal.hpp) instead of a file per checkpoint.
+// Once a journal exists, 'recover' (and hence the checkpoints that
+// follow) uses it whether or not this gets called.
+Try<Nothing> journal(const std::string& rootDir);
+
+// Stops checkpointing to the journal of 'rootDir', if it was opened,
+// and closes it once the checkpoints in progress are done with it.
+void closeJournal(const std::string& rootDir);
+
+// Returns true if checkpoints at the given path go to a journal.
+bool journaled(const std::string& path);
+
 // Each of the structs below (recursively) recover the checkpointed
 // state.
 struct SlaveState
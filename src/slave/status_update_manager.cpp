@@ -16,15 +16,24 @@
  * limitations under the License.
  */
 
+#include <unistd.h>
+
+#include <list>
+#include <vector>
+
+#include <process/defer.hpp>
 #include <process/delay.hpp>
+#include <process/owned.hpp>
 #include <process/process.hpp>
 #include <process/timer.hpp>
 
 #include <stout/check.hpp>
+#include <stout/error.hpp>
 #include <stout/foreach.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/hashset.hpp>
 #include <stout/option.hpp>
+#include <stout/os.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/utils.hpp>
 #include <stout/uuid.hpp>
@@ -37,12 +46,17 @@
 #include "slave/state.hpp"
 #include "slave/status_update_manager.hpp"
 
+using std::list;
 using std::string;
+using std::vector;
 
 using process::wait; // Necessary on some OS's to disambiguate.
 using process::Failure;
 using process::Future;
+using process::Owned;
 using process::PID;
+using process::Process;
+using process::Promise;
 using process::Timeout;
 using process::UPID;
 
@@ -57,11 +71,247 @@ using state::RunState;
 using state::TaskState;
 
 
+class StatusUpdateWriterProcess : public Process<StatusUpdateWriterProcess>
+{
+public:
+  StatusUpdateWriterProcess() : committing(false) {}
+  virtual ~StatusUpdateWriterProcess();
+
+  Future<Nothing> append(const string& path, const StatusUpdateRecord& record);
+  void close(const string& path);
+
+private:
+  struct Write
+  {
+    Write(const string& _path, const StatusUpdateRecord& _record)
+      : path(_path), record(_record) {}
+
+    const string path;
+    const StatusUpdateRecord record;
+    Promise<Nothing> promise;
+  };
+
+  // Writes and then syncs all the queued records.
+  void commit();
+
+  // Returns the (open) file descriptor of the updates file at 'path'
+  // or none if the file is journaled.
+  Try<Option<int> > open(const string& path);
+
+  // Records waiting for the next commit.
+  list<Owned<Write> > writes;
+
+  // Files to close after the next commit.
+  list<string> closes;
+
+  // Whether a commit has been dispatched.
+  bool committing;
+
+  hashmap<string, int> fds;
+
+  // Paths that failed to be written, see 'append'.
+  hashmap<string, string> errors;
+};
+
+
+StatusUpdateWriterProcess::~StatusUpdateWriterProcess()
+{
+  foreachvalue (int fd, fds) {
+    os::close(fd);
+  }
+}
+
+
+Future<Nothing> StatusUpdateWriterProcess::append(
+    const string& path,
+    const StatusUpdateRecord& record)
+{
+  // Once a record fails to be written, all the records that follow it
+  // fail too, otherwise recovery might find an ACK without an update.
+  if (errors.contains(path)) {
+    return Failure(errors[path]);
+  }
+
+  Owned<Write> write(new Write(path, record));
+  writes.push_back(write);
+
+  // Any records that get appended before the commit gets dispatched
+  // (e.g., while the previous commit is syncing) are committed with
+  // this record.
+  if (!committing) {
+    committing = true;
+    dispatch(self(), &Self::commit);
+  }
+
+  return write->promise.future();
+}
+
+
+void StatusUpdateWriterProcess::close(const string& path)
+{
+  closes.push_back(path);
+
+  if (!committing) {
+    committing = true;
+    dispatch(self(), &Self::commit);
+  }
+}
+
+
+void StatusUpdateWriterProcess::commit()
+{
+  committing = false;
+
+  // Files (or journals) that need to be synced: their file descriptor
+  // or none if the file is journaled.
+  hashmap<string, Option<int> > unsynced;
+
+  list<Owned<Write> > written;
+
+  foreach (const Owned<Write>& write, writes) {
+    if (errors.contains(write->path)) {
+      write->promise.fail(errors[write->path]);
+      continue;
+    }
+
+    Try<Option<int> > fd = open(write->path);
+
+    Try<Nothing> result = Nothing();
+    if (fd.isError()) {
+      result = Error(fd.error());
+    } else if (fd.get().isSome()) {
+      result = ::protobuf::write(fd.get().get(), write->record);
+    } else {
+      result = state::append(write->path, write->record, false);
+    }
+
+    if (result.isError()) {
+      errors[write->path] =
+        "Failed to write status update record to '" + write->path +
+        "': " + result.error();
+      write->promise.fail(errors[write->path]);
+      continue;
+    }
+
+    unsynced[write->path] = fd.get();
+    written.push_back(write);
+  }
+
+  writes.clear();
+
+  foreachpair (const string& path, const Option<int>& fd, unsynced) {
+    Try<Nothing> sync = Nothing();
+    if (fd.isNone()) {
+      // NOTE: This is a no-op once the journal has been synced.
+      sync = state::sync(path);
+    } else if (::fdatasync(fd.get()) != 0) {
+      sync = ErrnoError();
+    }
+
+    if (sync.isError()) {
+      errors[path] = "Failed to sync '" + path + "': " + sync.error();
+    }
+  }
+
+  foreach (const Owned<Write>& write, written) {
+    if (errors.contains(write->path)) {
+      write->promise.fail(errors[write->path]);
+    } else {
+      write->promise.set(Nothing());
+    }
+  }
+
+  VLOG(2) << "Committed " << written.size() << " status update records to "
+          << unsynced.size() << " files";
+
+  foreach (const string& path, closes) {
+    if (fds.contains(path)) {
+      Try<Nothing> close = os::close(fds[path]);
+      if (close.isError()) {
+        LOG(ERROR) << "Failed to close file '" << path << "': "
+                   << close.error();
+      }
+      fds.erase(path);
+    }
+    errors.erase(path);
+  }
+
+  closes.clear();
+}
+
+
+Try<Option<int> > StatusUpdateWriterProcess::open(const string& path)
+{
+  if (fds.contains(path)) {
+    return Option<int>(fds[path]);
+  }
+
+  // Updates get appended to the journal, if there is one.
+  if (state::journaled(path)) {
+    return None();
+  }
+
+  // Create the base updates directory, if it doesn't exist.
+  Try<Nothing> directory = os::mkdir(os::dirname(path).get());
+  if (directory.isError()) {
+    return Error("Failed to create " + os::dirname(path).get() + ": " +
+                 directory.error());
+  }
+
+  // Open the updates file. We keep it open until the stream is closed
+  // because it makes it easy to append status update records to the
+  // file. The records get synced in 'commit'.
+  Try<int> fd = os::open(
+      path,
+      O_CREAT | O_WRONLY | O_APPEND,
+      S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
+
+  if (fd.isError()) {
+    return Error("Failed to open '" + path + "' for status updates: " +
+                 fd.error());
+  }
+
+  fds[path] = fd.get();
+  return Option<int>(fd.get());
+}
+
+
+StatusUpdateWriter::StatusUpdateWriter()
+{
+  process = new StatusUpdateWriterProcess();
+  spawn(process);
+}
+
+
+StatusUpdateWriter::~StatusUpdateWriter()
+{
+  // Let the queued records get written.
+  terminate(process, false);
+  wait(process);
+  delete process;
+}
+
+
+Future<Nothing> StatusUpdateWriter::append(
+    const string& path,
+    const StatusUpdateRecord& record)
+{
+  return dispatch(process, &StatusUpdateWriterProcess::append, path, record);
+}
+
+
+void StatusUpdateWriter::close(const string& path)
+{
+  dispatch(process, &StatusUpdateWriterProcess::close, path);
+}
+
+
+
 class StatusUpdateManagerProcess
   : public ProtobufProcess<StatusUpdateManagerProcess>
 {
 public:
-  StatusUpdateManagerProcess() {}
+  StatusUpdateManagerProcess() : batching(false) {}
   virtual ~StatusUpdateManagerProcess();
 
   // Explicitely use 'initialize' since we're overloading below.
@@ -93,6 +343,8 @@ public:
 
   void newMasterDetected(const UPID& pid);
 
+  void registered(const string& version);
+
   void flush();
 
   void cleanup(const FrameworkID& frameworkId);
@@ -106,6 +358,17 @@ private:
       const Option<ExecutorID>& executorId,
       const Option<ContainerID>& containerId);
 
+  // Continuations of 'update()' and 'acknowledgement()' once the
+  // stream has been checkpointed.
+  Future<Nothing> __update(
+      const TaskID& taskId,
+      const FrameworkID& frameworkId);
+
+  Future<bool> _acknowledgement(
+      const TaskID& taskId,
+      const FrameworkID& frameworkId,
+      bool terminated);
+
   // Status update timeout.
   void timeout(const Duration& duration);
 
@@ -115,6 +378,14 @@ private:
   // ACK (e.g updates from the executor).
   Timeout forward(const StatusUpdate& update, const Duration& duration);
 
+  // Sends the updates batched up by 'forward' to the master.
+  void _forward();
+
+  // Forwards the next pending update of the stream, unless it has
+  // already been forwarded or the stream is still being checkpointed
+  // (in which case this gets called again once it has been).
+  Try<Nothing> forward(StatusUpdateStream* stream);
+
   // Helper functions.
 
   // Creates a new status update stream (opening the updates file, if path is
@@ -136,9 +407,18 @@ private:
       const FrameworkID& frameworkId);
 
   UPID master;
+
+  // Whether the master can handle a StatusUpdatesMessage.
+  bool batching;
+
+  // Updates waiting to be sent to the master, see '_forward'.
+  vector<StatusUpdate> batch;
+
   Flags flags;
   PID<Slave> slave;
   hashmap<FrameworkID, hashmap<TaskID, StatusUpdateStream*> > streams;
+
+  StatusUpdateWriter writer;
 };
 
 
@@ -167,16 +447,31 @@ void StatusUpdateManagerProcess::newMasterDetected(const UPID& pid)
   LOG(INFO) << "New master detected at " << pid;
   master = pid;
 
+  // We don't know whether the new master can handle batches until we
+  // register with it. The updates of the current batch get resent by
+  // 'flush' below.
+  batching = false;
+  batch.clear();
+
   // Retry any pending status updates.
   flush();
 }
 
 
+void StatusUpdateManagerProcess::registered(const string& version)
+{
+  batching = !version.empty();
+}
+
+
 void StatusUpdateManagerProcess::flush()
 {
   foreachkey (const FrameworkID& frameworkId, streams) {
     foreachvalue (StatusUpdateStream* stream, streams[frameworkId]) {
-      if (!stream->pending.empty()) {
+      // Updates that are still being checkpointed (and hence haven't
+      // been forwarded yet) get forwarded once they have been.
+      if (!stream->pending.empty() &&
+          (stream->timeout.isSome() || stream->checkpointed.isReady())) {
         const StatusUpdate& update = stream->pending.front();
         LOG(WARNING) << "Resending status update " << update;
         stream->timeout = forward(update, STATUS_UPDATE_RETRY_INTERVAL_MIN);
@@ -343,22 +638,38 @@ Future<Nothing> StatusUpdateManagerProcess::_update(
   }
 
   // We don't return a failed future here so that the slave can re-ack
-  // the duplicate update.
+  // the duplicate update (once the original has been checkpointed).
   if (!result.get()) {
+    return stream->checkpointed;
+  }
+
+  // Wait for the status update to be checkpointed before forwarding it
+  // (and letting the slave ack it).
+  if (!stream->checkpointed.isReady()) {
+    return stream->checkpointed
+      .then(defer(self(), &Self::__update, taskId, frameworkId));
+  }
+
+  return __update(taskId, frameworkId);
+}
+
+
+Future<Nothing> StatusUpdateManagerProcess::__update(
+    const TaskID& taskId,
+    const FrameworkID& frameworkId)
+{
+  StatusUpdateStream* stream = getStatusUpdateStream(taskId, frameworkId);
+
+  // The stream might have been cleaned up while being checkpointed.
+  if (stream == NULL) {
     return Nothing();
   }
 
   // Forward the status update to the master if this is the first in the stream.
   // Subsequent status updates will get sent in 'acknowledgement()'.
-  if (stream->pending.size() == 1) {
-    CHECK(stream->timeout.isNone());
-    const Result<StatusUpdate>& next = stream->next();
-    if (next.isError()) {
-      return Failure(next.error());
-    }
-
-    CHECK_SOME(next);
-    stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+  Try<Nothing> forward = this->forward(stream);
+  if (forward.isError()) {
+    return Failure(forward.error());
   }
 
   return Nothing();
@@ -369,7 +680,17 @@ Timeout StatusUpdateManagerProcess::forward(
     const StatusUpdate& update,
     const Duration& duration)
 {
-  if (master) {
+  if (master && batching) {
+    LOG(INFO) << "Batching status update " << update << " for " << master;
+
+    // The update gets sent along with the other updates that get
+    // forwarded before '_forward' runs, e.g., the next updates of
+    // the streams acknowledged in a StatusUpdateAcknowledgementsMessage.
+    if (batch.empty()) {
+      dispatch(self(), &Self::_forward);
+    }
+    batch.push_back(update);
+  } else if (master) {
     LOG(INFO) << "Forwarding status update " << update << " to " << master;
 
     StatusUpdateMessage message;
@@ -390,6 +711,57 @@ Timeout StatusUpdateManagerProcess::forward(
 }
 
 
+void StatusUpdateManagerProcess::_forward()
+{
+  // The batch gets dropped when a new master is detected.
+  if (batch.empty()) {
+    return;
+  }
+
+  // A single update is sent as usual so that it can be acknowledged
+  // as usual.
+  if (batch.size() == 1) {
+    StatusUpdateMessage message;
+    message.mutable_update()->MergeFrom(batch.front());
+    message.set_pid(slave); // The ACK will be first received by the slave.
+
+    send(master, message);
+  } else {
+    LOG(INFO) << "Forwarding " << batch.size() << " status updates to "
+              << master;
+
+    StatusUpdatesMessage message;
+    foreach (const StatusUpdate& update, batch) {
+      message.add_updates()->MergeFrom(update);
+    }
+    message.set_pid(slave); // The ACKs will be first received by the slave.
+
+    send(master, message);
+  }
+
+  batch.clear();
+}
+
+
+Try<Nothing> StatusUpdateManagerProcess::forward(StatusUpdateStream* stream)
+{
+  if (stream->timeout.isSome() || !stream->checkpointed.isReady()) {
+    return Nothing();
+  }
+
+  const Result<StatusUpdate>& next = stream->next();
+  if (next.isError()) {
+    return Error(next.error());
+  }
+
+  if (next.isSome()) {
+    stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+  }
+
+  return Nothing();
+}
+
+
 Future<bool> StatusUpdateManagerProcess::acknowledgement(
     const TaskID& taskId,
     const FrameworkID& frameworkId,
@@ -447,6 +819,10 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
 
   bool terminated = stream->terminated;
 
+  // NOTE: We hold on to this because cleaning up the stream doesn't
+  // stop the ACK from being checkpointed.
+  Future<Nothing> checkpointed = stream->checkpointed;
+
   if (terminated) {
     if (next.isSome()) {
       LOG(WARNING) << "Acknowledged a terminal"
@@ -454,9 +830,39 @@ Future<bool> StatusUpdateManagerProcess::acknowledgement(
                    << " but updates are still pending";
     }
     cleanupStatusUpdateStream(taskId, frameworkId);
-  } else if (next.isSome()) {
-    // Forward the next queued status update.
-    stream->timeout = forward(next.get(), STATUS_UPDATE_RETRY_INTERVAL_MIN);
+  }
+
+  // Wait for the ACK to be checkpointed before forwarding the next
+  // queued status update.
+  if (!checkpointed.isReady()) {
+    return checkpointed
+      .then(defer(self(),
+                  &Self::_acknowledgement,
+                  taskId,
+                  frameworkId,
+                  terminated));
+  }
+
+  return _acknowledgement(taskId, frameworkId, terminated);
+}
+
+
+Future<bool> StatusUpdateManagerProcess::_acknowledgement(
+    const TaskID& taskId,
+    const FrameworkID& frameworkId,
+    bool terminated)
+{
+  if (!terminated) {
+    StatusUpdateStream* stream = getStatusUpdateStream(taskId, frameworkId);
+
+    // The stream might have been cleaned up while being checkpointed.
+    if (stream != NULL) {
+      // Forward the next queued status update.
+      Try<Nothing> forward = this->forward(stream);
+      if (forward.isError()) {
+        return Failure(forward.error());
+      }
+    }
   }
 
   return !terminated;
@@ -470,18 +876,18 @@ void StatusUpdateManagerProcess::timeout(const Duration& duration)
   foreachkey (const FrameworkID& frameworkId, streams) {
     foreachvalue (StatusUpdateStream* stream, streams[frameworkId]) {
       CHECK_NOTNULL(stream);
-      if (!stream->pending.empty()) {
-        CHECK(stream->timeout.isSome());
-        if (stream->timeout.get().expired()) {
-          const StatusUpdate& update = stream->pending.front();
-          LOG(WARNING) << "Resending status update " << update;
+      // NOTE: Updates that are still being checkpointed don't have a
+      // timeout yet.
+      if (!stream->pending.empty() && stream->timeout.isSome() &&
+          stream->timeout.get().expired()) {
+        const StatusUpdate& update = stream->pending.front();
+        LOG(WARNING) << "Resending status update " << update;
 
-          // Bounded exponential backoff.
-          Duration duration_ =
-            std::min(duration * 2, STATUS_UPDATE_RETRY_INTERVAL_MAX);
+        // Bounded exponential backoff.
+        Duration duration_ =
+          std::min(duration * 2, STATUS_UPDATE_RETRY_INTERVAL_MAX);
 
-          stream->timeout = forward(update, duration_);
-        }
+        stream->timeout = forward(update, duration_);
       }
     }
   }
@@ -500,7 +906,14 @@ StatusUpdateStream* StatusUpdateManagerProcess::createStatusUpdateStream(
           << " of framework " << frameworkId;
 
   StatusUpdateStream* stream = new StatusUpdateStream(
-      taskId, frameworkId, slaveId, flags, checkpoint, executorId, containerId);
+      taskId,
+      frameworkId,
+      slaveId,
+      flags,
+      checkpoint,
+      executorId,
+      containerId,
+      &writer);
 
   streams[frameworkId][taskId] = stream;
   return stream;
@@ -628,6 +1041,12 @@ void StatusUpdateManager::newMasterDetected(const UPID& pid)
 }
 
 
+void StatusUpdateManager::registered(const string& version)
+{
+  dispatch(process, &StatusUpdateManagerProcess::registered, version);
+}
+
+
 void StatusUpdateManager::flush()
 {
   dispatch(process, &StatusUpdateManagerProcess::flush);
@@ -24,6 +24,7 @@
 #include <string>
 #include <utility>
 
+#include <process/future.hpp>
 #include <process/pid.hpp>
 #include <process/process.hpp>
 #include <process/protobuf.hpp>
@@ -61,6 +62,7 @@ struct SlaveState;
 }
 
 class StatusUpdateManagerProcess;
+class StatusUpdateWriterProcess;
 struct StatusUpdateStream;
 
 
@@ -120,6 +122,12 @@ public:
   // TODO(vinod): Remove this hack once the new leader detector code is merged.
   void newMasterDetected(const process::UPID& pid);
 
+  // Informs the status update manager of the version of the master
+  // once the slave has (re-)registered with it. Masters that report a
+  // version (i.e., 0.19.0 and newer) get the updates that are being
+  // forwarded at the same time in a single StatusUpdatesMessage.
+  void registered(const std::string& version);
+
   // Resend all the pending updates right away.
   // This is useful when the updates were pending because there was
   // no master elected (e.g., during recovery) or framework failed over.
@@ -134,6 +142,35 @@ private:
 };
 
 
+// StatusUpdateWriter checkpoints status update records on behalf of
+// the status update streams so that the status update manager doesn't
+// block on disk I/O. Records appended while earlier ones are being
+// synced get written and synced together (i.e., group committed), so
+// a burst of updates costs a sync per updates file (or a single sync
+// when checkpointing to a journal) rather than a sync per record.
+// Records appended to the same file are written in order.
+class StatusUpdateWriter
+{
+public:
+  StatusUpdateWriter();
+  ~StatusUpdateWriter();
+
+  // Appends the record to the updates file at 'path'.
+  // @return Ready once the record is durable, failed if it (or any
+  //         earlier record appended to 'path') couldn't be written.
+  process::Future<Nothing> append(
+      const std::string& path,
+      const StatusUpdateRecord& record);
+
+  // Closes the updates file at 'path' once all the records appended
+  // to it so far have been written.
+  void close(const std::string& path);
+
+private:
+  StatusUpdateWriterProcess* process;
+};
+
+
 // StatusUpdateStream handles the status updates and acknowledgements
 // of a task, checkpointing them if necessary. It also holds the information
 // about received, acknowledged and pending status updates.
@@ -148,13 +185,16 @@ struct StatusUpdateStream
                      const Flags& _flags,
                      bool _checkpoint,
                      const Option<ExecutorID>& executorId,
-                     const Option<ContainerID>& containerId)
+                     const Option<ContainerID>& containerId,
+                     StatusUpdateWriter* _writer)
     : checkpoint(_checkpoint),
       terminated(false),
+      checkpointed(Nothing()),
       taskId(_taskId),
       frameworkId(_frameworkId),
       slaveId(_slaveId),
       flags(_flags),
+      writer(_writer),
       error(None())
   {
     if (checkpoint) {
@@ -168,40 +208,13 @@ struct StatusUpdateStream
           executorId.get(),
           containerId.get(),
           taskId);
-
-      // Create the base updates directory, if it doesn't exist.
-      Try<Nothing> directory = os::mkdir(os::dirname(path.get()).get());
-      if (directory.isError()) {
-        error = "Failed to create " + os::dirname(path.get()).get();
-        return;
-      }
-
-      // Open the updates file.
-      Try<int> result = os::open(
-          path.get(),
-          O_CREAT | O_WRONLY | O_APPEND | O_SYNC,
-          S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
-
-      if (result.isError()) {
-        error = "Failed to open '" + path.get() + "' for status updates";
-        return;
-      }
-
-      // We keep the file open through the lifetime of the task, because it
-      // makes it easy to append status update records to the file.
-      fd = result.get();
     }
   }
 
   ~StatusUpdateStream()
   {
-    if (fd.isSome()) {
-      Try<Nothing> close = os::close(fd.get());
-      if (close.isError()) {
-        CHECK_SOME(path);
-        LOG(ERROR) << "Failed to close file '" << path.get() << "': "
-                   << close.error();
-      }
+    if (path.isSome()) {
+      writer->close(path.get());
     }
   }
 
@@ -211,7 +224,7 @@ struct StatusUpdateStream
   //           Error Any errors (e.g., checkpointing).
   Try<bool> update(const StatusUpdate& update)
   {
-    if (error.isSome()) {
+    if (failed()) {
       return Error(error.get());
     }
 
@@ -251,7 +264,7 @@ struct StatusUpdateStream
       const UUID& uuid,
       const StatusUpdate& update)
   {
-    if (error.isSome()) {
+    if (failed()) {
       return Error(error.get());
     }
 
@@ -282,7 +295,7 @@ struct StatusUpdateStream
   // Returns the next update (or none, if empty) in the queue.
   Result<StatusUpdate> next()
   {
-    if (error.isSome()) {
+    if (failed()) {
       return Error(error.get());
     }
 
@@ -324,13 +337,25 @@ struct StatusUpdateStream
   Option<process::Timeout> timeout; // Timeout for resending status update.
   std::queue<StatusUpdate> pending;
 
+  // Ready once everything handled so far has been checkpointed.
+  // NOTE: Updates are handled (e.g., added to 'pending') right away,
+  // so callers must wait for this before forwarding an update or
+  // acknowledging it to the executor.
+  process::Future<Nothing> checkpointed;
+
 private:
-  // Handles the status update and writes it to disk, if necessary.
-  // TODO(vinod): The write has to be asynchronous to avoid status updates that
-  // are being checkpointed, blocking the processing of other updates.
-  // One solution is to wrap the protobuf::write inside async, but its probably
-  // too much of an overhead to spin up a new libprocess per status update?
-  // A better solution might be to be have async write capability for file io.
+  // Returns true if the stream has failed, e.g., because an update
+  // could not be checkpointed.
+  bool failed()
+  {
+    if (error.isNone() && checkpointed.isFailed()) {
+      error = checkpointed.failure();
+    }
+    return error.isSome();
+  }
+
+  // Handles the status update and writes it to disk (asynchronously,
+  // see 'checkpointed'), if necessary.
   Try<Nothing> handle(
       const StatusUpdate& update,
       const StatusUpdateRecord::Type& type)
@@ -341,8 +366,6 @@ private:
     if (checkpoint) {
       LOG(INFO) << "Checkpointing " << type << " for status update " << update;
 
-      CHECK_SOME(fd);
-
       StatusUpdateRecord record;
       record.set_type(type);
 
@@ -352,12 +375,7 @@ private:
         record.set_uuid(update.uuid());
       }
 
-      Try<Nothing> write = ::protobuf::write(fd.get(), record);
-      if (write.isError()) {
-        error = "Failed to write status update " + stringify(update) +
-                " to '" + path.get() + "': " + write.error();
-        return Error(error.get());
-      }
+      checkpointed = writer->append(path.get(), record);
     }
 
     // Now actually handle the update.
@@ -395,11 +413,12 @@ private:
 
   const Flags flags;
 
+  StatusUpdateWriter* writer; // Checkpoints the updates.
+
   hashset<UUID> received;
   hashset<UUID> acknowledged;
 
   Option<std::string> path; // File path of the update stream.
-  Option<int> fd; // File descriptor to the update stream.
 
   Option<std::string> error; // Potential non-retryable error.
 };
@@ -1,4 +1,5 @@
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/dispatch.hpp>
@@ -16,6 +17,7 @@
 
 using namespace process;
 
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -44,6 +46,27 @@ public:
     return true;
   }
 
+  bool set(const vector<pair<Entry, UUID> >& _entries)
+  {
+    // Check all the versions before setting any of the entries.
+    for (size_t i = 0; i < _entries.size(); i++) {
+      const Entry& entry = _entries[i].first;
+      const UUID& uuid = _entries[i].second;
+
+      const Option<Entry>& option = entries.get(entry.name());
+
+      if (option.isSome() && UUID::fromBytes(option.get().uuid()) != uuid) {
+        return false;
+      }
+    }
+
+    for (size_t i = 0; i < _entries.size(); i++) {
+      entries.put(_entries[i].first.name(), _entries[i].first);
+    }
+
+    return true;
+  }
+
   bool expunge(const Entry& entry)
   {
     const Option<Entry>& option = entries.get(entry.name());
@@ -95,7 +118,21 @@ Future<Option<Entry> > InMemoryStorage::get(const string& name)
 
 Future<bool> InMemoryStorage::set(const Entry& entry, const UUID& uuid)
 {
-  return dispatch(process, &InMemoryStorageProcess::set, entry, uuid);
+  // Need to disambiguate overloaded function.
+  bool (InMemoryStorageProcess::*set)(const Entry&, const UUID&) =
+    &InMemoryStorageProcess::set;
+
+  return dispatch(process, set, entry, uuid);
+}
+
+
+Future<bool> InMemoryStorage::set(const vector<pair<Entry, UUID> >& entries)
+{
+  // Need to disambiguate overloaded function.
+  bool (InMemoryStorageProcess::*set)(const vector<pair<Entry, UUID> >&) =
+    &InMemoryStorageProcess::set;
+
+  return dispatch(process, set, entries);
 }
 
 
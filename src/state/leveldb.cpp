@@ -1,10 +1,12 @@
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 
 #include <google/protobuf/message.h>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h> // For ArrayInputStream.
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/dispatch.hpp>
@@ -27,6 +29,7 @@
 
 using namespace process;
 
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -46,6 +49,7 @@ public:
   // Storage implementation.
   Future<Option<Entry> > get(const string& name);
   Future<bool> set(const Entry& entry, const UUID& uuid);
+  Future<bool> set(const vector<pair<Entry, UUID> >& entries);
   Future<bool> expunge(const Entry& entry);
   Future<vector<string> > names();
 
@@ -162,6 +166,55 @@ Future<bool> LevelDBStorageProcess::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<bool> LevelDBStorageProcess::set(
+    const vector<pair<Entry, UUID> >& entries)
+{
+  if (error.isSome()) {
+    return Failure(error.get());
+  }
+
+  leveldb::WriteBatch batch;
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    const Entry& entry = entries[i].first;
+    const UUID& uuid = entries[i].second;
+
+    // Make sure the version has not changed, as in 'set' above.
+    Try<Option<Entry> > option = read(entry.name());
+
+    if (option.isError()) {
+      return Failure(option.error());
+    }
+
+    if (option.get().isSome()) {
+      if (UUID::fromBytes(option.get().get().uuid()) != uuid) {
+        return false;
+      }
+    }
+
+    string value;
+
+    if (!entry.SerializeToString(&value)) {
+      return Failure("Failed to serialize Entry");
+    }
+
+    batch.Put(entry.name(), value);
+  }
+
+  // Apply all the writes atomically and with a single sync.
+  leveldb::WriteOptions options;
+  options.sync = true;
+
+  leveldb::Status status = db->Write(options, &batch);
+
+  if (!status.ok()) {
+    return Failure(status.ToString());
+  }
+
+  return true;
+}
+
+
 Future<bool> LevelDBStorageProcess::expunge(const Entry& entry)
 {
   if (error.isSome()) {
@@ -277,7 +330,21 @@ Future<Option<Entry> > LevelDBStorage::get(const string& name)
 
 Future<bool> LevelDBStorage::set(const Entry& entry, const UUID& uuid)
 {
-  return dispatch(process, &LevelDBStorageProcess::set, entry, uuid);
+  // Need to disambiguate overloaded function.
+  Future<bool> (LevelDBStorageProcess::*set)(const Entry&, const UUID&) =
+    &LevelDBStorageProcess::set;
+
+  return dispatch(process, set, entry, uuid);
+}
+
+
+Future<bool> LevelDBStorage::set(const vector<pair<Entry, UUID> >& entries)
+{
+  // Need to disambiguate overloaded function.
+  Future<bool> (LevelDBStorageProcess::*set)(
+      const vector<pair<Entry, UUID> >&) = &LevelDBStorageProcess::set;
+
+  return dispatch(process, set, entries);
 }
 
 
@@ -20,9 +20,11 @@
 #define __STATE_PROTOBUF_HPP__
 
 #include <string>
+#include <vector>
 
 #include <process/future.hpp>
 
+#include <stout/foreach.hpp>
 #include <stout/lambda.hpp>
 #include <stout/option.hpp>
 #include <stout/some.hpp>
@@ -85,6 +87,14 @@ public:
   template <typename T>
   process::Future<Option<Variable<T> > > store(const Variable<T>& variable);
 
+  // Returns the variables specified if they were all successfully
+  // stored in the state in a single atomic operation, otherwise
+  // returns none if the version of any of the variables was no longer
+  // valid, or an error if one occurs.
+  template <typename T>
+  process::Future<Option<std::vector<Variable<T> > > > store(
+      const std::vector<Variable<T> >& variables);
+
   // Expunges the variable from the state.
   template <typename T>
   process::Future<bool> expunge(const Variable<T>& variable);
@@ -101,6 +111,11 @@ private:
   static process::Future<Option<Variable<T> > > _store(
       const T& t,
       const Option<state::Variable>& variable);
+
+  template <typename T>
+  static process::Future<Option<std::vector<Variable<T> > > > _store(
+      const std::vector<T>& ts,
+      const Option<std::vector<state::Variable> >& variables);
 };
 
 
@@ -135,8 +150,13 @@ process::Future<Option<Variable<T> > > State::store(
     return process::Failure(value.error());
   }
 
+  // Necessary to disambiguate overloaded function.
+  process::Future<Option<Variable<T> > > (*_store)(
+      const T& t,
+      const Option<state::Variable>& variable) = &State::template _store<T>;
+
   return state::State::store(variable.variable.mutate(value.get()))
-    .then(lambda::bind(&State::template _store<T>, variable.t, lambda::_1));
+    .then(lambda::bind(_store, variable.t, lambda::_1));
 }
 
 
@@ -153,6 +173,55 @@ process::Future<Option<Variable<T> > > State::_store(
 }
 
 
+template <typename T>
+process::Future<Option<std::vector<Variable<T> > > > State::store(
+    const std::vector<Variable<T> >& variables)
+{
+  std::vector<state::Variable> mutated;
+  std::vector<T> ts;
+
+  foreach (const Variable<T>& variable, variables) {
+    Try<std::string> value = messages::serialize(variable.t);
+
+    if (value.isError()) {
+      return process::Failure(value.error());
+    }
+
+    mutated.push_back(variable.variable.mutate(value.get()));
+    ts.push_back(variable.t);
+  }
+
+  // Necessary to disambiguate overloaded function.
+  process::Future<Option<std::vector<Variable<T> > > > (*_store)(
+      const std::vector<T>& ts,
+      const Option<std::vector<state::Variable> >& variables) =
+    &State::template _store<T>;
+
+  return state::State::store(mutated)
+    .then(lambda::bind(_store, ts, lambda::_1));
+}
+
+
+template <typename T>
+process::Future<Option<std::vector<Variable<T> > > > State::_store(
+    const std::vector<T>& ts,
+    const Option<std::vector<state::Variable> >& variables)
+{
+  if (variables.isNone()) {
+    return None();
+  }
+
+  CHECK_EQ(ts.size(), variables.get().size());
+
+  std::vector<Variable<T> > results;
+  for (size_t i = 0; i < ts.size(); i++) {
+    results.push_back(Variable<T>(variables.get()[i], ts[i]));
+  }
+
+  return Some(results);
+}
+
+
 template <typename T>
 process::Future<bool> State::expunge(const Variable<T>& variable)
 {
@@ -20,11 +20,14 @@
 #define __STATE_STATE_HPP__
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/deferred.hpp> // TODO(benh): This is required by Clang.
 #include <process/future.hpp>
 
+#include <stout/foreach.hpp>
+#include <stout/hashset.hpp>
 #include <stout/lambda.hpp>
 #include <stout/none.hpp>
 #include <stout/option.hpp>
@@ -107,6 +110,14 @@ public:
   // was no longer valid, or an error if one occurs.
   process::Future<Option<Variable> > store(const Variable& variable);
 
+  // Stores all of the specified variables atomically (i.e., either
+  // all of them are stored or none is) in a single storage operation.
+  // Returns the stored variables (in the same order) if successful,
+  // none if the version of any of the variables was no longer valid,
+  // or an error if one occurs.
+  process::Future<Option<std::vector<Variable> > > store(
+      const std::vector<Variable>& variables);
+
   // Returns true if successfully expunged the variable from the state.
   process::Future<bool> expunge(const Variable& variable);
 
@@ -125,6 +136,10 @@ private:
       const Entry& entry,
       const bool& b); // TODO(benh): Remove 'const &' after fixing libprocess.
 
+  static process::Future<Option<std::vector<Variable> > > _store(
+      const std::vector<std::pair<Entry, UUID> >& entries,
+      const bool& b); // TODO(benh): Remove 'const &' after fixing libprocess.
+
   Storage* storage;
 };
 
@@ -166,8 +181,13 @@ inline process::Future<Option<Variable> > State::store(const Variable& variable)
   entry.set_uuid(UUID::random().toBytes());
   entry.set_value(variable.entry.value());
 
+  // Necessary to disambiguate overloaded function.
+  process::Future<Option<Variable> > (*_store)(
+      const Entry& entry,
+      const bool& b) = &State::_store;
+
   return storage->set(entry, uuid)
-    .then(lambda::bind(&State::_store, entry, lambda::_1));
+    .then(lambda::bind(_store, entry, lambda::_1));
 }
 
 
@@ -183,6 +203,59 @@ inline process::Future<Option<Variable > > State::_store(
 }
 
 
+inline process::Future<Option<std::vector<Variable> > > State::store(
+    const std::vector<Variable>& variables)
+{
+  std::vector<std::pair<Entry, UUID> > entries;
+  hashset<std::string> names;
+
+  foreach (const Variable& variable, variables) {
+    // Storing the same variable twice in one batch would validate
+    // both against the same version, so we disallow it.
+    if (names.contains(variable.entry.name())) {
+      return process::Failure(
+          "Variable '" + variable.entry.name() + "' is stored more than once");
+    }
+
+    names.insert(variable.entry.name());
+
+    // Same as storing a single variable, see above.
+    Entry entry;
+    entry.set_name(variable.entry.name());
+    entry.set_uuid(UUID::random().toBytes());
+    entry.set_value(variable.entry.value());
+
+    entries.push_back(
+        std::make_pair(entry, UUID::fromBytes(variable.entry.uuid())));
+  }
+
+  // Necessary to disambiguate overloaded function.
+  process::Future<Option<std::vector<Variable> > > (*_store)(
+      const std::vector<std::pair<Entry, UUID> >& entries,
+      const bool& b) = &State::_store;
+
+  return storage->set(entries)
+    .then(lambda::bind(_store, entries, lambda::_1));
+}
+
+
+inline process::Future<Option<std::vector<Variable> > > State::_store(
+    const std::vector<std::pair<Entry, UUID> >& entries,
+    const bool& b) // TODO(benh): Remove 'const &' after fixing libprocess.
+{
+  if (!b) {
+    return None();
+  }
+
+  std::vector<Variable> variables;
+  for (size_t i = 0; i < entries.size(); i++) {
+    variables.push_back(Variable(entries[i].first));
+  }
+
+  return Some(variables);
+}
+
+
 inline process::Future<bool> State::expunge(const Variable& variable)
 {
   return storage->expunge(variable.entry);
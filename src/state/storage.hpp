@@ -20,6 +20,7 @@
 #define __STATE_STORAGE_HPP__
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/future.hpp>
@@ -46,6 +47,12 @@ public:
   virtual process::Future<Option<Entry> > get(const std::string& name) = 0;
   virtual process::Future<bool> set(const Entry& entry, const UUID& uuid) = 0;
 
+  // Atomically sets a group of entries, each of which is required to
+  // still have the UUID it is paired with. Returns false (and sets
+  // none of the entries) if any of the UUIDs do not match.
+  virtual process::Future<bool> set(
+      const std::vector<std::pair<Entry, UUID> >& entries) = 0;
+
   // Returns true if successfully expunged the variable from the state.
   virtual process::Future<bool> expunge(const Entry& entry) = 0;
 
@@ -4,6 +4,7 @@
 
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/dispatch.hpp>
@@ -12,10 +13,13 @@
 
 #include <stout/duration.hpp>
 #include <stout/error.hpp>
+#include <stout/hashmap.hpp>
 #include <stout/none.hpp>
+#include <stout/nothing.hpp>
 #include <stout/option.hpp>
 #include <stout/result.hpp>
 #include <stout/some.hpp>
+#include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 #include <stout/try.hpp>
 #include <stout/uuid.hpp>
@@ -33,6 +37,7 @@
 
 using namespace process;
 
+using std::pair;
 using std::queue;
 using std::string;
 using std::vector;
@@ -51,7 +56,8 @@ public:
       const string& servers,
       const Duration& timeout,
       const string& znode,
-      const Option<Authentication>& auth);
+      const Option<Authentication>& auth,
+      bool caching);
   virtual ~ZooKeeperStorageProcess();
 
   virtual void initialize();
@@ -59,6 +65,7 @@ public:
   // Storage implementation.
   Future<Option<Entry> > get(const string& name);
   Future<bool> set(const Entry& entry, const UUID& uuid);
+  Future<bool> set(const vector<pair<Entry, UUID> >& entries);
   virtual Future<bool> expunge(const Entry& entry);
   Future<vector<string> > names();
 
@@ -75,8 +82,16 @@ private:
   Result<vector<string> > doNames();
   Result<Option<Entry> > doGet(const string& name);
   Result<bool> doSet(const Entry& entry, const UUID& uuid);
+  Result<bool> doSet(const vector<pair<Entry, UUID> >& entries);
   Result<bool> doExpunge(const Entry& entry);
 
+  // Helper for creating the directory path znodes as necessary.
+  Result<Nothing> doCreateParents();
+
+  // Helpers for invalidating cached names and entries.
+  void invalidate(const string& path);
+  void invalidate(const Entry& entry);
+
   const string servers;
 
   // The session timeout requested by the client.
@@ -86,6 +101,9 @@ private:
 
   Option<Authentication> auth; // ZooKeeper authentication.
 
+  // Whether or not to cache entries and names (see 'cache' below).
+  const bool caching;
+
   const ACL_vector acl; // Default ACL to use.
 
   Watcher* watcher;
@@ -112,10 +130,13 @@ private:
 
   struct Set
   {
-    Set(const Entry& _entry, const UUID& _uuid) : entry(_entry), uuid(_uuid) {}
+    Set(const Entry& entry, const UUID& uuid)
+      : entries(1, std::make_pair(entry, uuid)) {}
 
-    Entry entry;
-    UUID uuid;
+    explicit Set(const vector<pair<Entry, UUID> >& _entries)
+      : entries(_entries) {}
+
+    vector<pair<Entry, UUID> > entries;
     Promise<bool> promise;
   };
 
@@ -136,6 +157,16 @@ private:
     queue<Expunge*> expunges;
   } pending;
 
+  // Cached results of reads, each of which has a ZooKeeper watch set
+  // on it that invalidates it when it changes. A cached entry of
+  // 'None' means the znode did not exist (and we're watching for its
+  // creation). Everything is dropped when the connection is lost
+  // since watches don't survive session expiration.
+  struct {
+    hashmap<string, Option<Entry> > entries;
+    Option<vector<string> > names;
+  } cache;
+
   Option<string> error;
 };
 
@@ -157,11 +188,13 @@ ZooKeeperStorageProcess::ZooKeeperStorageProcess(
     const string& _servers,
     const Duration& _timeout,
     const string& _znode,
-    const Option<Authentication>& _auth)
+    const Option<Authentication>& _auth,
+    bool _caching)
   : servers(_servers),
     timeout(_timeout),
     znode(strings::remove(_znode, "/", strings::SUFFIX)),
     auth(_auth),
+    caching(_caching),
     acl(_auth.isSome()
         ? zookeeper::EVERYONE_READ_CREATOR_ALL
         : ZOO_OPEN_ACL_UNSAFE),
@@ -263,6 +296,31 @@ Future<bool> ZooKeeperStorageProcess::set(const Entry& entry, const UUID& uuid)
 }
 
 
+Future<bool> ZooKeeperStorageProcess::set(
+    const vector<pair<Entry, UUID> >& entries)
+{
+  if (error.isSome()) {
+    return Failure(error.get());
+  } else if (state != CONNECTED) {
+    Set* set = new Set(entries);
+    pending.sets.push(set);
+    return set->promise.future();
+  }
+
+  Result<bool> result = doSet(entries);
+
+  if (result.isNone()) { // Try again later.
+    Set* set = new Set(entries);
+    pending.sets.push(set);
+    return set->promise.future();
+  } else if (result.isError()) {
+    return Failure(result.error());
+  }
+
+  return result.get();
+}
+
+
 Future<bool> ZooKeeperStorageProcess::expunge(const Entry& entry)
 {
   if (error.isSome()) {
@@ -336,7 +394,7 @@ void ZooKeeperStorageProcess::connected(bool reconnect)
 
   while (!pending.sets.empty()) {
     Set* set = pending.sets.front();
-    Result<bool> result = doSet(set->entry, set->uuid);
+    Result<bool> result = doSet(set->entries);
     if (result.isNone()) {
       return; // Try again later.
     } else if (result.isError()) {
@@ -353,6 +411,11 @@ void ZooKeeperStorageProcess::connected(bool reconnect)
 void ZooKeeperStorageProcess::reconnecting()
 {
   state = CONNECTING;
+
+  // We might miss events while disconnected so stop trusting the
+  // cache, reads will go to ZooKeeper (and reset watches) instead.
+  cache.entries.clear();
+  cache.names = None();
 }
 
 
@@ -360,6 +423,10 @@ void ZooKeeperStorageProcess::expired()
 {
   state = DISCONNECTED;
 
+  // All of our watches are gone with the session.
+  cache.entries.clear();
+  cache.names = None();
+
   delete zk;
   zk = new ZooKeeper(servers, timeout, watcher);
 
@@ -369,28 +436,58 @@ void ZooKeeperStorageProcess::expired()
 
 void ZooKeeperStorageProcess::updated(const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  CHECK(caching) << "Unexpected ZooKeeper event";
+  invalidate(path);
 }
 
 
 void ZooKeeperStorageProcess::created(const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  CHECK(caching) << "Unexpected ZooKeeper event";
+  invalidate(path);
 }
 
 
 void ZooKeeperStorageProcess::deleted(const string& path)
 {
-  LOG(FATAL) << "Unexpected ZooKeeper event";
+  CHECK(caching) << "Unexpected ZooKeeper event";
+  invalidate(path);
+}
+
+
+void ZooKeeperStorageProcess::invalidate(const string& path)
+{
+  // A create or delete of an entry also changes the names but we
+  // might not get a child event for it if a watch on the children
+  // isn't set (e.g., the names haven't been read yet).
+  if (path == znode) {
+    cache.names = None();
+  } else if (strings::startsWith(path, znode + "/")) {
+    cache.entries.erase(path.substr(znode.size() + 1));
+    cache.names = None();
+  }
+}
+
+
+void ZooKeeperStorageProcess::invalidate(const Entry& entry)
+{
+  // Invalidate before writing so that we never return a cached value
+  // that is older than one we've written (the watch will fire later).
+  cache.entries.erase(entry.name());
+  cache.names = None();
 }
 
 
 Result<vector<string> > ZooKeeperStorageProcess::doNames()
 {
+  if (cache.names.isSome()) {
+    return cache.names.get();
+  }
+
   // Get all children to determine current memberships.
   vector<string> results;
 
-  int code = zk->getChildren(znode, false, &results);
+  int code = zk->getChildren(znode, caching, &results);
 
   if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
@@ -404,6 +501,10 @@ Result<vector<string> > ZooKeeperStorageProcess::doNames()
   // TODO(benh): It might make sense to "mangle" the names so that we
   // can determine when a znode has incorrectly been added that
   // actually doesn't store an Entry.
+  if (caching) {
+    cache.names = results;
+  }
+
   return results;
 }
 
@@ -413,12 +514,29 @@ Result<Option<Entry> > ZooKeeperStorageProcess::doGet(const string& name)
   CHECK(error.isNone()) << ": " << error.get();
   CHECK(state == CONNECTED);
 
+  if (cache.entries.contains(name)) {
+    return cache.entries[name];
+  }
+
   string result;
   Stat stat;
 
-  int code = zk->get(znode + "/" + name, false, &result, &stat);
+  int code = zk->get(znode + "/" + name, caching, &result, &stat);
 
   if (code == ZNONODE) {
+    if (caching) {
+      // A failed get doesn't leave a watch so set one for the
+      // creation of the znode, unless it has been created since.
+      code = zk->exists(znode + "/" + name, true, NULL);
+
+      if (code == ZNONODE) {
+        cache.entries[name] = None();
+      } else if (code == ZINVALIDSTATE ||
+                 (code != ZOK && zk->retryable(code))) {
+        CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+        return None(); // Try again later.
+      }
+    }
     return Option<Entry>::none();
   } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
     CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
@@ -437,6 +555,10 @@ Result<Option<Entry> > ZooKeeperStorageProcess::doGet(const string& name)
     return Error("Failed to deserialize Entry");
   }
 
+  if (caching) {
+    cache.entries[name] = entry;
+  }
+
   return Some(entry);
 }
 
@@ -446,6 +568,8 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry, const UUID& uuid
   CHECK(error.isNone()) << ": " << error.get();
   CHECK(state == CONNECTED);
 
+  invalidate(entry);
+
   // Serialize to make sure we're under the 1 MB limit.
   string data;
 
@@ -464,26 +588,12 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry, const UUID& uuid
   int code = zk->get(znode + "/" + entry.name(), false, &result, &stat);
 
   if (code == ZNONODE) {
-    // Create directory path znodes as necessary.
-    CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
-    size_t index = znode.find("/", 0);
-
-    while (index < string::npos) {
-      // Get out the prefix to create.
-      index = znode.find("/", index + 1);
-      string prefix = znode.substr(0, index);
+    Result<Nothing> created = doCreateParents();
 
-      // Create the znode (even if it already exists).
-      code = zk->create(prefix, "", acl, 0, NULL);
-
-      if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
-        CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
-        return None(); // Try again later.
-      } else if (code != ZOK && code != ZNODEEXISTS) {
-        return Error(
-            "Failed to create '" + prefix +
-            "' in ZooKeeper: " + zk->message(code));
-      }
+    if (!created.isSome()) {
+      return created.isNone()
+        ? Result<bool>::none()
+        : Result<bool>::error(created.error());
     }
 
     code = zk->create(znode + "/" + entry.name(), data, acl, 0, NULL);
@@ -539,11 +649,168 @@ Result<bool> ZooKeeperStorageProcess::doSet(const Entry& entry, const UUID& uuid
 }
 
 
+Result<bool> ZooKeeperStorageProcess::doSet(
+    const vector<pair<Entry, UUID> >& entries)
+{
+  CHECK(error.isNone()) << ": " << error.get();
+  CHECK(state == CONNECTED);
+
+  // A single entry doesn't need a multi operation.
+  if (entries.empty()) {
+    return true;
+  } else if (entries.size() == 1) {
+    return doSet(entries[0].first, entries[0].second);
+  }
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    invalidate(entries[i].first);
+  }
+
+  // The paths and data need to outlive the operations that point to
+  // them, hence we size the vectors up front.
+  vector<string> paths(entries.size());
+  vector<string> datas(entries.size());
+  vector<zoo_op_t> ops(entries.size());
+  bool creates = false;
+
+  // Serialize to make sure we're under the 1 MB limit, which applies
+  // to the whole multi request (see 'jute.maxbuffer') rather than to
+  // each entry. We don't split the batch as it needs to be atomic.
+  size_t size = 0;
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    paths[i] = znode + "/" + entries[i].first.name();
+
+    if (!entries[i].first.SerializeToString(&datas[i])) {
+      return Error("Failed to serialize Entry");
+    }
+
+    size += paths[i].size() + datas[i].size();
+  }
+
+  if (size > 1024 * 1024) { // 1 MB
+    // TODO(benh): Use stout/gzip.hpp for compression.
+    return Error("Serialized data of " + stringify(entries.size()) +
+                 " entries is too big (> 1 MB)");
+  }
+
+  for (size_t i = 0; i < entries.size(); i++) {
+    const UUID& uuid = entries[i].second;
+
+    string result;
+    Stat stat;
+
+    int code = zk->get(paths[i], false, &result, &stat);
+
+    if (code == ZNONODE) {
+      // The create will fail with ZNODEEXISTS if someone else creates
+      // the znode before we commit.
+      zoo_create_op_init(
+          &ops[i],
+          paths[i].c_str(),
+          datas[i].data(),
+          datas[i].size(),
+          &acl,
+          0,
+          NULL,
+          0);
+
+      creates = true;
+      continue;
+    } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK) {
+      return Error(
+          "Failed to get '" + paths[i] + "' in ZooKeeper: " +
+          zk->message(code));
+    }
+
+    google::protobuf::io::ArrayInputStream stream(result.data(), result.size());
+
+    Entry current;
+
+    if (!current.ParseFromZeroCopyStream(&stream)) {
+      return Error("Failed to deserialize Entry");
+    }
+
+    if (UUID::fromBytes(current.uuid()) != uuid) {
+      return false;
+    }
+
+    // We get atomicity by requiring 'stat.version'.
+    zoo_set_op_init(
+        &ops[i],
+        paths[i].c_str(),
+        datas[i].data(),
+        datas[i].size(),
+        stat.version,
+        NULL);
+  }
+
+  if (creates) {
+    Result<Nothing> created = doCreateParents();
+
+    if (!created.isSome()) {
+      return created.isNone()
+        ? Result<bool>::none()
+        : Result<bool>::error(created.error());
+    }
+  }
+
+  vector<zoo_op_result_t> results(entries.size());
+
+  int code = zk->multi(ops.size(), &ops[0], &results[0]);
+
+  if (code == ZBADVERSION || code == ZNODEEXISTS || code == ZNONODE) {
+    return false; // Lost a race with someone else.
+  } else if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+    CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+    return None(); // Try again later.
+  } else if (code != ZOK) {
+    return Error(
+        "Failed to set " + stringify(entries.size()) +
+        " entries in ZooKeeper: " + zk->message(code));
+  }
+
+  return true;
+}
+
+
+Result<Nothing> ZooKeeperStorageProcess::doCreateParents()
+{
+  CHECK(znode.size() == 0 || znode.at(znode.size() - 1) != '/');
+  size_t index = znode.find("/", 0);
+
+  while (index < string::npos) {
+    // Get out the prefix to create.
+    index = znode.find("/", index + 1);
+    string prefix = znode.substr(0, index);
+
+    // Create the znode (even if it already exists).
+    int code = zk->create(prefix, "", acl, 0, NULL);
+
+    if (code == ZINVALIDSTATE || (code != ZOK && zk->retryable(code))) {
+      CHECK(zk->getState() != ZOO_AUTH_FAILED_STATE);
+      return None(); // Try again later.
+    } else if (code != ZOK && code != ZNODEEXISTS) {
+      return Error(
+          "Failed to create '" + prefix +
+          "' in ZooKeeper: " + zk->message(code));
+    }
+  }
+
+  return Nothing();
+}
+
+
 Result<bool> ZooKeeperStorageProcess::doExpunge(const Entry& entry)
 {
   CHECK(error.isNone()) << ": " << error.get();
   CHECK(state == CONNECTED);
 
+  invalidate(entry);
+
   string result;
   Stat stat;
 
@@ -594,9 +861,10 @@ ZooKeeperStorage::ZooKeeperStorage(
     const string& servers,
     const Duration& timeout,
     const string& znode,
-    const Option<Authentication>& auth)
+    const Option<Authentication>& auth,
+    bool cache)
 {
-  process = new ZooKeeperStorageProcess(servers, timeout, znode, auth);
+  process = new ZooKeeperStorageProcess(servers, timeout, znode, auth, cache);
   spawn(process);
 }
 
@@ -617,7 +885,21 @@ Future<Option<Entry> > ZooKeeperStorage::get(const string& name)
 
 Future<bool> ZooKeeperStorage::set(const Entry& entry, const UUID& uuid)
 {
-  return dispatch(process, &ZooKeeperStorageProcess::set, entry, uuid);
+  // Need to disambiguate overloaded function.
+  Future<bool> (ZooKeeperStorageProcess::*set)(const Entry&, const UUID&) =
+    &ZooKeeperStorageProcess::set;
+
+  return dispatch(process, set, entry, uuid);
+}
+
+
+Future<bool> ZooKeeperStorage::set(const vector<pair<Entry, UUID> >& entries)
+{
+  // Need to disambiguate overloaded function.
+  Future<bool> (ZooKeeperStorageProcess::*set)(
+      const vector<pair<Entry, UUID> >&) = &ZooKeeperStorageProcess::set;
+
+  return dispatch(process, set, entries);
 }
 
 
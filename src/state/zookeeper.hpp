@@ -2,6 +2,7 @@
 #define __STATE_ZOOKEEPER_HPP__
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <process/future.hpp>
@@ -28,16 +29,27 @@ class ZooKeeperStorage : public Storage
 {
 public:
   // TODO(benh): Just take a zookeeper::URL.
+  // If 'cache' is true, entries and names are cached after they are
+  // first read and ZooKeeper watches are used to invalidate them, so
+  // repeated reads of unchanged variables don't go to ZooKeeper. The
+  // cache is dropped whenever the session is lost.
+  // NOTE: Caching is opt-in since it only pays off for clients that
+  // fetch the same variables over and over, at the cost of a watch
+  // per variable read. E.g., the master's registrar fetches the
+  // registry once, when recovering, and keeps it in memory after.
   ZooKeeperStorage(
       const std::string& servers,
       const Duration& timeout,
       const std::string& znode,
-      const Option<zookeeper::Authentication>& auth = None());
+      const Option<zookeeper::Authentication>& auth = None(),
+      bool cache = false);
   virtual ~ZooKeeperStorage();
 
   // Storage implementation.
   virtual process::Future<Option<Entry> > get(const std::string& name);
   virtual process::Future<bool> set(const Entry& entry, const UUID& uuid);
+  virtual process::Future<bool> set(
+      const std::vector<std::pair<Entry, UUID> >& entries);
   virtual process::Future<bool> expunge(const Entry& entry);
   virtual process::Future<std::vector<std::string> > names();
 
@@ -25,6 +25,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <iostream>
 #include <set>
 #include <string>
 #include <vector>
@@ -36,12 +37,14 @@
 #include <gmock/gmock.h>
 
 #include <process/gtest.hpp>
+#include <process/owned.hpp>
 
 #include <stout/gtest.hpp>
 #include <stout/hashmap.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 #include <stout/stringify.hpp>
 #include <stout/strings.hpp>
 
@@ -490,6 +493,137 @@ TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest, ROOT_CGROUPS_Stat)
 }
 
 
+// Compares reading cpuacct.stat through a reader, which parses it in
+// place, against reading it into a hashmap.
+TEST_F(CgroupsAnyHierarchyWithCpuAcctMemoryTest,
+       DISABLED_ROOT_CGROUPS_ReaderBenchmark)
+{
+  const size_t iterations = 10000;
+  const std::string hierarchy = path::join(baseHierarchy, "cpuacct");
+
+  Try<cgroups::Reader*> reader =
+    cgroups::Reader::create(hierarchy, "/", "cpuacct.stat");
+  ASSERT_SOME(reader);
+
+  Owned<cgroups::Reader> owned(reader.get());
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<cgroups::cpuacct::Stat> stat = cgroups::cpuacct::stat(reader.get());
+    ASSERT_SOME(stat);
+    EXPECT_SOME(stat.get().user);
+    EXPECT_SOME(stat.get().system);
+  }
+
+  const Duration parsed = stopwatch.elapsed();
+
+  stopwatch.start();
+
+  for (size_t i = 0; i < iterations; i++) {
+    Try<hashmap<std::string, uint64_t> > stat =
+      cgroups::stat(hierarchy, "/", "cpuacct.stat");
+    ASSERT_SOME(stat);
+    EXPECT_TRUE(stat.get().contains("user"));
+    EXPECT_TRUE(stat.get().contains("system"));
+  }
+
+  const Duration hashed = stopwatch.elapsed();
+
+  std::cout << "Read cpuacct.stat " << iterations << " times in " << parsed
+            << " (" << hashed << " into a hashmap)" << std::endl;
+
+  // Both must agree on what's in the control file.
+  Try<hashmap<std::string, uint64_t> > expected =
+    cgroups::stat(hierarchy, "/", "cpuacct.stat");
+  ASSERT_SOME(expected);
+
+  Try<cgroups::cpuacct::Stat> stat = cgroups::cpuacct::stat(reader.get());
+  ASSERT_SOME(stat);
+  EXPECT_LE(expected.get().get("user").get(), stat.get().user.get());
+  EXPECT_LE(expected.get().get("system").get(), stat.get().system.get());
+
+  // Missing fields are left unset rather than reported as 0.
+  Try<cgroups::cpu::Stat> missing = cgroups::cpu::stat(reader.get());
+  ASSERT_SOME(missing);
+  EXPECT_NONE(missing.get().nr_periods);
+  EXPECT_NONE(missing.get().nr_throttled);
+  EXPECT_NONE(missing.get().throttled_time);
+}
+
+
+// Waits (for up to 5 seconds) until there are 'count' cgroups under
+// 'cgroup', returning them.
+static Try<std::vector<std::string> > await(
+    const std::string& hierarchy,
+    const std::string& cgroup,
+    size_t count)
+{
+  Try<std::vector<std::string> > nested = cgroups::get(hierarchy, cgroup);
+
+  Duration waited = Duration::zero();
+  while (nested.isSome() &&
+         nested.get().size() != count &&
+         waited < Seconds(5)) {
+    os::sleep(Milliseconds(10));
+    waited += Milliseconds(10);
+    nested = cgroups::get(hierarchy, cgroup);
+  }
+
+  return nested;
+}
+
+
+TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Pool)
+{
+  std::string hierarchy = path::join(baseHierarchy, "cpu");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  const std::string cgroup = path::join(TEST_CGROUPS_ROOT, "container");
+
+  {
+    cgroups::Pool pool(hierarchy, TEST_CGROUPS_ROOT, 2);
+
+    // The pool gets filled in the background.
+    Try<std::vector<std::string> > pooled =
+      await(hierarchy, TEST_CGROUPS_ROOT, 2);
+    ASSERT_SOME(pooled);
+    ASSERT_EQ(2u, pooled.get().size());
+
+    foreach (const std::string& name, pooled.get()) {
+      EXPECT_TRUE(pool.contains(name));
+    }
+
+    // Creating a cgroup takes one of the pooled cgroups.
+    ASSERT_SOME(pool.create(cgroup));
+    EXPECT_SOME_TRUE(cgroups::exists(hierarchy, cgroup));
+    EXPECT_FALSE(pool.contains(cgroup));
+
+    EXPECT_NE(os::exists(path::join(hierarchy, pooled.get()[0])),
+              os::exists(path::join(hierarchy, pooled.get()[1])));
+
+    // Which gets replaced.
+    Try<std::vector<std::string> > replaced =
+      await(hierarchy, TEST_CGROUPS_ROOT, 3);
+    ASSERT_SOME(replaced);
+    EXPECT_EQ(3u, replaced.get().size());
+
+    // Cgroups elsewhere don't come from the pool.
+    ASSERT_SOME(pool.create(path::join(cgroup, "nested")));
+    EXPECT_SOME_TRUE(cgroups::exists(hierarchy, path::join(cgroup, "nested")));
+    ASSERT_SOME(cgroups::remove(hierarchy, path::join(cgroup, "nested")));
+  }
+
+  // The remaining pooled cgroups get removed along with the pool.
+  Try<std::vector<std::string> > remaining =
+    cgroups::get(hierarchy, TEST_CGROUPS_ROOT);
+  ASSERT_SOME(remaining);
+  ASSERT_EQ(1u, remaining.get().size());
+  EXPECT_EQ(cgroup, remaining.get()[0]);
+}
+
+
 TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Listen)
 {
   std::string hierarchy = path::join(baseHierarchy, "memory");
@@ -583,6 +717,31 @@ TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Listen)
 }
 
 
+TEST_F(CgroupsAnyHierarchyWithCpuMemoryTest, ROOT_CGROUPS_Listener)
+{
+  std::string hierarchy = path::join(baseHierarchy, "memory");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  EXPECT_ERROR(cgroups::Listener::create(
+      hierarchy, TEST_CGROUPS_ROOT, "invalid"));
+
+  Try<cgroups::Listener*> listener = cgroups::Listener::create(
+      hierarchy, TEST_CGROUPS_ROOT, "memory.oom_control");
+
+  ASSERT_SOME(listener);
+
+  Future<uint64_t> future = listener.get()->listen();
+  EXPECT_TRUE(future.isPending());
+
+  // Only one listen may be pending at a time.
+  AWAIT_FAILED(listener.get()->listen());
+
+  // Deleting the listener unregisters it and discards the listen.
+  delete listener.get();
+
+  AWAIT_DISCARDED(future);
+}
+
 TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_Freeze)
 {
   int pipes[2];
@@ -784,3 +943,49 @@ TEST_F(CgroupsAnyHierarchyWithFreezerTest, ROOT_CGROUPS_Destroy)
     abort();
   }
 }
+
+
+// Measures how long it takes to destroy a cgroup with many processes.
+TEST_F(CgroupsAnyHierarchyWithFreezerTest,
+       DISABLED_ROOT_CGROUPS_DestroyBenchmark)
+{
+  const size_t count = 200;
+
+  std::string hierarchy = path::join(baseHierarchy, "freezer");
+  ASSERT_SOME(cgroups::create(hierarchy, TEST_CGROUPS_ROOT));
+
+  std::vector<pid_t> pids;
+  for (size_t i = 0; i < count; i++) {
+    pid_t pid = ::fork();
+    ASSERT_NE(-1, pid);
+
+    if (pid == 0) {
+      // In child process, wait until killed.
+      while (true) { ::sleep(1); }
+
+      // Should not reach here.
+      std::cerr << "Reach an unreachable statement!" << std::endl;
+      abort();
+    }
+
+    pids.push_back(pid);
+
+    ASSERT_SOME(cgroups::assign(hierarchy, TEST_CGROUPS_ROOT, pid));
+  }
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Future<bool> future = cgroups::destroy(hierarchy, TEST_CGROUPS_ROOT);
+  AWAIT_READY_FOR(future, Seconds(30));
+  EXPECT_TRUE(future.get());
+
+  std::cout << "Destroyed a cgroup with " << count << " processes in "
+            << stopwatch.elapsed() << std::endl;
+
+  foreach (pid_t pid, pids) {
+    int status;
+    EXPECT_EQ(pid, ::waitpid(pid, &status, 0));
+    EXPECT_TRUE(WIFSIGNALED(status));
+  }
+}
@@ -23,30 +23,45 @@
 
 #include <mesos/mesos.hpp>
 
+#include <process/clock.hpp>
+#include <process/future.hpp>
+#include <process/gmock.hpp>
+#include <process/gtest.hpp>
+#include <process/http.hpp>
+#include <process/process.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/json.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#ifdef __linux__
+#include <slave/containerizer/cgroups_launcher.hpp>
+#endif // __linux__
+#include <slave/containerizer/disk_usage.hpp>
+#include <slave/containerizer/fetcher_cache.hpp>
+#include <slave/containerizer/isolators/posix.hpp>
+#include <slave/containerizer/launcher.hpp>
 #include <slave/containerizer/mesos_containerizer.hpp>
 #include <slave/flags.hpp>
 
+#include "tests/flags.hpp"
+#include "tests/utils.hpp"
+
 using namespace mesos;
 using namespace mesos::internal;
 using namespace mesos::internal::slave;
 
+using namespace process;
+
 using std::string;
 using std::vector;
 
-namespace mesos {
-namespace internal {
-namespace slave {
-
-// Forward declaration.
-string buildCommand(
-    const CommandInfo& commandInfo,
-    const string& directory,
-    const Option<string>& user,
-    const Flags& flags);
+using testing::_;
+using testing::Return;
 
-}  // namespace slave {
-}  // namespace internal {
-}  // namespace mesos {
+using mesos::internal::tests::TemporaryDirectoryTest;
 
 class MesosContainerizerProcessTest : public ::testing::Test {};
 
@@ -182,3 +197,316 @@ TEST_F(MesosContainerizerProcessTest, NoHadoop) {
       "MESOS_FRAMEWORKS_HOME=/tmp/frameworks",
       command.c_str());
 }
+
+
+class FetcherCacheTest : public TemporaryDirectoryTest {};
+
+
+// Serves the URIs fetched into the cache.
+class FileServerProcess : public Process<FileServerProcess>
+{
+public:
+  FileServerProcess()
+  {
+    route("/file", None(), &FileServerProcess::file);
+  }
+
+  MOCK_METHOD1(file, Future<http::Response>(const http::Request&));
+};
+
+
+TEST_F(FetcherCacheTest, FetchOnceAndEvict)
+{
+  FileServerProcess server;
+  spawn(server);
+
+  // Both executors should share a single fetch.
+  EXPECT_CALL(server, file(_))
+    .WillOnce(Return(http::OK("executor")));
+
+  Flags flags;
+  flags.launcher_dir =
+    path::join(mesos::internal::tests::flags.build_dir, "src");
+  flags.fetcher_cache_dir = path::join(os::getcwd(), "fetch");
+  flags.fetcher_cache_size = Bytes(1); // Evict anything unused.
+
+  FetcherCache cache(flags);
+
+  CommandInfo::URI uri;
+  uri.set_value(
+      "http://" + strings::split(stringify(server.self()), "@")[1] +
+      "/" + server.self().id + "/file");
+
+  Future<string> path1 = cache.get(uri);
+  Future<string> path2 = cache.get(uri);
+
+  AWAIT_READY(path1);
+  AWAIT_READY(path2);
+
+  EXPECT_EQ(path1.get(), path2.get());
+  EXPECT_SOME_EQ("executor", os::read(path1.get()));
+
+  // The copy is in use, so it must not be evicted even though the
+  // cache is over its capacity.
+  Future<JSON::Object> statistics = cache.statistics();
+  AWAIT_READY(statistics);
+
+  JSON::Object object = statistics.get();
+
+  EXPECT_EQ(1, object.values["fetcher_cache_hits"]);
+  EXPECT_EQ(1, object.values["fetcher_cache_misses"]);
+  EXPECT_EQ(0, object.values["fetcher_cache_evictions"]);
+  EXPECT_TRUE(os::exists(path1.get()));
+
+  cache.release(uri);
+  cache.release(uri);
+
+  statistics = cache.statistics();
+  AWAIT_READY(statistics);
+
+  object = statistics.get();
+
+  EXPECT_EQ(1, object.values["fetcher_cache_evictions"]);
+  EXPECT_EQ(0, object.values["fetcher_cache_size_bytes"]);
+  EXPECT_FALSE(os::exists(path1.get()));
+
+  terminate(server);
+  wait(server);
+}
+
+
+class MesosContainerizerTest : public TemporaryDirectoryTest {};
+
+
+TEST_F(MesosContainerizerTest, LaunchPhaseLatencies)
+{
+  Flags flags;
+  flags.launcher_dir =
+    path::join(mesos::internal::tests::flags.build_dir, "src");
+  flags.work_dir = os::getcwd();
+
+  Try<Launcher*> launcher = PosixLauncher::create(flags);
+  ASSERT_SOME(launcher);
+
+  Try<Isolator*> cpu = PosixCpuIsolatorProcess::create(flags);
+  ASSERT_SOME(cpu);
+
+  Try<Isolator*> mem = PosixMemIsolatorProcess::create(flags);
+  ASSERT_SOME(mem);
+
+  vector<Owned<Isolator> > isolators;
+  isolators.push_back(Owned<Isolator>(cpu.get()));
+  isolators.push_back(Owned<Isolator>(mem.get()));
+
+  MesosContainerizer containerizer(
+      flags, true, Owned<Launcher>(launcher.get()), isolators);
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_command()->set_value("exit 0");
+
+  const string& directory = path::join(os::getcwd(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  Future<Nothing> launch = containerizer.launch(
+      containerId,
+      executorInfo,
+      directory,
+      None(),
+      SlaveID(),
+      PID<Slave>(),
+      false);
+
+  AWAIT_READY(launch);
+
+  Future<Containerizer::Termination> termination =
+    containerizer.wait(containerId);
+
+  AWAIT_READY(termination);
+
+  Future<JSON::Object> statistics = containerizer.statistics();
+  AWAIT_READY(statistics);
+
+  JSON::Object object = statistics.get();
+
+  const string phases[] = { "prepare", "fetch", "fork", "isolate", "launch" };
+  foreach (const string& phase, phases) {
+    EXPECT_EQ(1u, object.values.count("containerizer_" + phase + "_ms_p50"))
+      << phase;
+    EXPECT_EQ(1u, object.values.count("containerizer_" + phase + "_ms_p99"))
+      << phase;
+  }
+}
+
+
+#ifdef __linux__
+// Launches an executor with --launcher_vfork, i.e., through the
+// mesos-launcher helper, and checks that it runs in its sandbox, with
+// its output redirected, and with the environment it was given. If a
+// freezer cgroup is specified also checks that the executor ran in it.
+static void launchVfork(
+    const Flags& flags,
+    Launcher* launcher,
+    const Option<string>& freezer)
+{
+  MesosContainerizer containerizer(
+      flags, false, Owned<Launcher>(launcher), vector<Owned<Isolator> >());
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_command()->set_value(
+      "pwd -P > cwd && "
+      "cat /proc/self/cgroup > cgroup && "
+      "echo $MESOS_EXECUTOR_ID && "
+      "echo $MESOS_TEST_VARIABLE");
+
+  Environment::Variable* variable =
+    executorInfo.mutable_command()->mutable_environment()->add_variables();
+  variable->set_name("MESOS_TEST_VARIABLE");
+  variable->set_value("value");
+
+  const string& directory = path::join(os::getcwd(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  Future<Nothing> launch = containerizer.launch(
+      containerId,
+      executorInfo,
+      directory,
+      None(),
+      SlaveID(),
+      PID<Slave>(),
+      false);
+
+  AWAIT_READY(launch);
+
+  Future<Containerizer::Termination> termination =
+    containerizer.wait(containerId);
+
+  AWAIT_READY(termination);
+  EXPECT_SOME_EQ(0, termination.get().status);
+
+  Result<string> realpath = os::realpath(directory);
+  ASSERT_SOME(realpath);
+
+  Try<string> cwd = os::read(path::join(directory, "cwd"));
+  ASSERT_SOME(cwd);
+  EXPECT_EQ(realpath.get(), strings::trim(cwd.get()));
+
+  EXPECT_SOME_EQ("executor\nvalue\n",
+                 os::read(path::join(directory, "stdout")));
+
+  if (freezer.isSome()) {
+    Try<string> cgroup = os::read(path::join(directory, "cgroup"));
+    ASSERT_SOME(cgroup);
+    EXPECT_TRUE(strings::contains(cgroup.get(), ":freezer:/" + freezer.get()))
+      << cgroup.get();
+  }
+}
+
+
+TEST_F(MesosContainerizerTest, LaunchVfork)
+{
+  Flags flags;
+  flags.launcher_dir =
+    path::join(mesos::internal::tests::flags.build_dir, "src");
+  flags.work_dir = os::getcwd();
+  flags.launcher_vfork = true;
+
+  Try<Launcher*> launcher = PosixLauncher::create(flags);
+  ASSERT_SOME(launcher);
+
+  launchVfork(flags, launcher.get(), None());
+}
+
+
+// Like the above but the child moves itself into the freezer cgroup
+// of the container before it execs mesos-launcher.
+TEST_F(MesosContainerizerTest, ROOT_CGROUPS_LaunchVfork)
+{
+  Flags flags;
+  flags.launcher_dir =
+    path::join(mesos::internal::tests::flags.build_dir, "src");
+  flags.work_dir = os::getcwd();
+  flags.launcher_vfork = true;
+
+  Try<Launcher*> launcher = CgroupsLauncher::create(flags);
+  ASSERT_SOME(launcher);
+
+  launchVfork(
+      flags, launcher.get(), path::join(flags.cgroups_root, "container"));
+}
+#endif // __linux__
+
+
+class DiskUsageCollectorTest : public TemporaryDirectoryTest {};
+
+
+TEST_F(DiskUsageCollectorTest, Usage)
+{
+  const string& sandbox = path::join(os::getcwd(), "sandbox");
+  const string& file = path::join(sandbox, "a", "b", "file");
+
+  ASSERT_SOME(os::mkdir(path::join(sandbox, "a", "b")));
+  ASSERT_SOME(os::write(path::join(sandbox, "stdout"), string(65536, 'x')));
+  ASSERT_SOME(os::write(file, string(65536, 'x')));
+
+  Clock::pause();
+
+  DiskUsageCollector collector(Seconds(1));
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  collector.watch(containerId, sandbox);
+
+  // Nothing is known until the sandbox has been scanned.
+  Future<Option<Bytes> > usage = collector.usage(containerId);
+  AWAIT_READY(usage);
+  EXPECT_NONE(usage.get());
+
+  Clock::advance(Seconds(1));
+  Clock::settle();
+
+  usage = collector.usage(containerId);
+  AWAIT_READY(usage);
+  ASSERT_SOME(usage.get());
+  EXPECT_LE(Bytes(2 * 65536), usage.get().get());
+
+  const Bytes scanned = usage.get().get();
+
+  // Files growing in a directory that didn't change get noticed.
+  ASSERT_SOME(os::write(file, string(2 * 65536, 'x')));
+
+  Clock::advance(Seconds(1));
+  Clock::settle();
+
+  usage = collector.usage(containerId);
+  AWAIT_READY(usage);
+  ASSERT_SOME(usage.get());
+  EXPECT_LE(scanned + Bytes(65536), usage.get().get());
+
+  // As do removed directories.
+  ASSERT_SOME(os::rmdir(path::join(sandbox, "a")));
+
+  Clock::advance(Seconds(1));
+  Clock::settle();
+
+  usage = collector.usage(containerId);
+  AWAIT_READY(usage);
+  ASSERT_SOME(usage.get());
+  EXPECT_GT(scanned, usage.get().get());
+
+  collector.unwatch(containerId);
+
+  usage = collector.usage(containerId);
+  AWAIT_READY(usage);
+  EXPECT_NONE(usage.get());
+
+  Clock::resume();
+}
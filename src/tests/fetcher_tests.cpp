@@ -0,0 +1,360 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+#include <mesos/mesos.hpp>
+
+#include <process/future.hpp>
+#include <process/gmock.hpp>
+#include <process/gtest.hpp>
+#include <process/http.hpp>
+#include <process/process.hpp>
+#include <process/subprocess.hpp>
+
+#include <stout/gtest.hpp>
+#include <stout/gzip.hpp>
+#include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/strings.hpp>
+
+#include "launcher/extractor.hpp"
+
+#include "slave/containerizer/mesos_containerizer.hpp"
+#include "slave/flags.hpp"
+
+#include "tests/flags.hpp"
+#include "tests/utils.hpp"
+
+using namespace mesos;
+using namespace mesos::internal;
+
+using namespace process;
+
+using std::list;
+using std::string;
+using std::vector;
+
+using testing::_;
+using testing::DoAll;
+using testing::Return;
+
+using mesos::internal::tests::TemporaryDirectoryTest;
+
+
+// An entry of a tar archive built by 'archive()'.
+struct Entry
+{
+  Entry(const string& _name,
+        char _type,
+        const string& _data = "",
+        const string& _link = "")
+    : name(_name), type(_type), data(_data), link(_link) {}
+
+  string name;
+  char type;
+  string data;
+  string link;
+};
+
+
+// Returns the ustar header block of the entry.
+static string header(const Entry& entry)
+{
+  char block[512];
+  memset(block, 0, sizeof(block));
+
+  strncpy(block, entry.name.c_str(), 100);
+  snprintf(block + 100, 8, "%07o", 0644);
+  snprintf(block + 124, 12, "%011lo", (unsigned long) entry.data.size());
+  snprintf(block + 136, 12, "%011o", 0);
+  block[156] = entry.type;
+  strncpy(block + 157, entry.link.c_str(), 100);
+  memcpy(block + 257, "ustar", 6);
+  memcpy(block + 263, "00", 2);
+
+  // The checksum is computed with the checksum field set to spaces.
+  memset(block + 148, ' ', 8);
+
+  unsigned int checksum = 0;
+  for (size_t i = 0; i < sizeof(block); i++) {
+    checksum += (unsigned char) block[i];
+  }
+
+  snprintf(block + 148, 7, "%06o", checksum);
+
+  return string(block, sizeof(block));
+}
+
+
+// Returns the (uncompressed) tar archive of the entries.
+static string tar(const vector<Entry>& entries, bool terminate = true)
+{
+  string archive;
+
+  foreach (const Entry& entry, entries) {
+    archive += header(entry);
+    archive += entry.data;
+    archive += string((512 - entry.data.size() % 512) % 512, '\0');
+  }
+
+  if (terminate) {
+    archive += string(2 * 512, '\0'); // Two zero blocks end the archive.
+  }
+
+  return archive;
+}
+
+
+// Returns the gzip compressed tar archive of the entries.
+static string archive(const vector<Entry>& entries)
+{
+  Try<string> compressed = gzip::compress(tar(entries));
+  CHECK_SOME(compressed);
+  return compressed.get();
+}
+
+
+// Extracts the (compressed) archive into the directory, a piece at a
+// time like a download would arrive.
+static Try<Nothing> extract(const string& archive, const string& directory)
+{
+  Extractor extractor(directory);
+
+  for (size_t i = 0; i < archive.size(); i += 100) {
+    Try<Nothing> written = extractor.write(
+        archive.data() + i, std::min<size_t>(100, archive.size() - i));
+
+    if (written.isError()) {
+      return written;
+    }
+  }
+
+  return extractor.close();
+}
+
+
+class ExtractorTest : public TemporaryDirectoryTest {};
+
+
+TEST_F(ExtractorTest, Extract)
+{
+  const string& directory = path::join(os::getcwd(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  vector<Entry> entries;
+  entries.push_back(Entry("dir/", '5'));
+  entries.push_back(Entry("dir/file", '0', "hello"));
+  entries.push_back(Entry("hardlink", '1', "", "dir/file"));
+  entries.push_back(Entry("dir/symlink", '2', "", "file"));
+  entries.push_back(Entry("dir/up", '2', "", "../hardlink"));
+
+  ASSERT_SOME(extract(archive(entries), directory));
+
+  EXPECT_SOME_EQ("hello", os::read(path::join(directory, "dir/file")));
+  EXPECT_SOME_EQ("hello", os::read(path::join(directory, "hardlink")));
+  EXPECT_SOME_EQ("hello", os::read(path::join(directory, "dir/symlink")));
+  EXPECT_SOME_EQ("hello", os::read(path::join(directory, "dir/up")));
+
+  // The hard link is the same file.
+  struct stat file;
+  struct stat hardlink;
+  ASSERT_EQ(0, ::stat(path::join(directory, "dir/file").c_str(), &file));
+  ASSERT_EQ(0, ::stat(path::join(directory, "hardlink").c_str(), &hardlink));
+  EXPECT_EQ(file.st_ino, hardlink.st_ino);
+
+  char link[PATH_MAX];
+  ssize_t length = ::readlink(
+      path::join(directory, "dir/symlink").c_str(), link, sizeof(link));
+
+  ASSERT_LT(0, length);
+  EXPECT_EQ("file", string(link, length));
+}
+
+
+// Nothing may be extracted outside of the directory, whether by path,
+// by link or through a symbolic link.
+TEST_F(ExtractorTest, Traversal)
+{
+  const string& outside = path::join(os::getcwd(), "outside");
+  ASSERT_SOME(os::mkdir(outside));
+  ASSERT_SOME(os::write(path::join(outside, "file"), "outside"));
+
+  const string& directory = path::join(os::getcwd(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  vector<Entry> absolute;
+  absolute.push_back(Entry(path::join(outside, "absolute"), '0', "x"));
+  EXPECT_ERROR(extract(archive(absolute), directory));
+
+  vector<Entry> parent;
+  parent.push_back(Entry("../outside/parent", '0', "x"));
+  EXPECT_ERROR(extract(archive(parent), directory));
+
+  vector<Entry> hardlink;
+  hardlink.push_back(Entry("hardlink", '1', "", "../outside/file"));
+  EXPECT_ERROR(extract(archive(hardlink), directory));
+
+  vector<Entry> symlink;
+  symlink.push_back(Entry("dir/symlink", '2', "", "../../outside"));
+  EXPECT_ERROR(extract(archive(symlink), directory));
+
+  vector<Entry> absoluteSymlink;
+  absoluteSymlink.push_back(Entry("symlink", '2', "", outside));
+  EXPECT_ERROR(extract(archive(absoluteSymlink), directory));
+
+  // Even a symbolic link within the directory mustn't be followed, it
+  // might get replaced by one pointing elsewhere.
+  vector<Entry> through;
+  through.push_back(Entry("dir/", '5'));
+  through.push_back(Entry("symlink", '2', "", "dir"));
+  through.push_back(Entry("symlink/file", '0', "x"));
+  EXPECT_ERROR(extract(archive(through), directory));
+  EXPECT_FALSE(os::exists(path::join(directory, "dir/file")));
+
+  // Nor one that was there before.
+  ASSERT_EQ(0, ::symlink(
+      outside.c_str(), path::join(directory, "existing").c_str()));
+
+  vector<Entry> existing;
+  existing.push_back(Entry("existing/file", '0', "x"));
+  EXPECT_ERROR(extract(archive(existing), directory));
+
+  vector<Entry> existingDirectory;
+  existingDirectory.push_back(Entry("existing/", '5'));
+  EXPECT_ERROR(extract(archive(existingDirectory), directory));
+
+  Try<list<string> > files = os::ls(outside);
+  ASSERT_SOME(files);
+  EXPECT_EQ(1u, files.get().size());
+  EXPECT_SOME_EQ("outside", os::read(path::join(outside, "file")));
+}
+
+
+TEST_F(ExtractorTest, Truncated)
+{
+  const string& directory = path::join(os::getcwd(), "sandbox");
+  ASSERT_SOME(os::mkdir(directory));
+
+  vector<Entry> entries;
+  entries.push_back(Entry("file", '0', string(4096, 'x')));
+
+  // A tar archive that ends in the middle of an entry.
+  const string& tarball = tar(entries, false);
+  Try<string> truncated = gzip::compress(tarball.substr(0, 2048));
+  ASSERT_SOME(truncated);
+  EXPECT_ERROR(extract(truncated.get(), directory));
+
+  // A gzip stream that ends early.
+  const string& compressed = archive(entries);
+  EXPECT_ERROR(extract(compressed.substr(0, compressed.size() / 2), directory));
+
+  // Both are fine once complete.
+  EXPECT_SOME(extract(compressed, directory));
+  EXPECT_SOME_EQ(string(4096, 'x'), os::read(path::join(directory, "file")));
+}
+
+
+class FetcherTest : public TemporaryDirectoryTest {};
+
+
+// Serves the URIs to fetch.
+class FileServerProcess : public Process<FileServerProcess>
+{
+public:
+  FileServerProcess()
+  {
+    route("/file", None(), &FileServerProcess::file);
+    route("/archive.tar.gz", None(), &FileServerProcess::archive);
+  }
+
+  MOCK_METHOD1(file, Future<http::Response>(const http::Request&));
+  MOCK_METHOD1(archive, Future<http::Response>(const http::Request&));
+};
+
+
+// Both URIs get fetched at the same time: neither gets served until
+// both have been asked for.
+TEST_F(FetcherTest, Parallel)
+{
+  FileServerProcess server;
+  spawn(server);
+
+  Promise<http::Response> file;
+  Promise<http::Response> tarball;
+
+  Future<Nothing> fileRequested;
+  EXPECT_CALL(server, file(_))
+    .WillOnce(DoAll(FutureSatisfy(&fileRequested),
+                    Return(file.future())));
+
+  Future<Nothing> tarballRequested;
+  EXPECT_CALL(server, archive(_))
+    .WillOnce(DoAll(FutureSatisfy(&tarballRequested),
+                    Return(tarball.future())));
+
+  const string& url =
+    "http://" + strings::split(stringify(server.self()), "@")[1] +
+    "/" + server.self().id;
+
+  CommandInfo commandInfo;
+  commandInfo.add_uris()->set_value(url + "/file");
+  commandInfo.add_uris()->set_value(url + "/archive.tar.gz");
+
+  slave::Flags flags;
+  flags.launcher_dir =
+    path::join(mesos::internal::tests::flags.build_dir, "src");
+
+  const string& directory = os::getcwd();
+
+  Try<Subprocess> fetcher = subprocess(
+      slave::buildCommand(commandInfo, directory, None(), flags) + " " +
+      path::join(flags.launcher_dir, "mesos-fetcher"));
+
+  ASSERT_SOME(fetcher);
+
+  AWAIT_EXPECT_READY(fileRequested);
+  AWAIT_EXPECT_READY(tarballRequested);
+
+  vector<Entry> entries;
+  entries.push_back(Entry("extracted", '0', "extracted"));
+
+  file.set(http::OK("file"));
+  tarball.set(http::OK(archive(entries)));
+
+  AWAIT_READY(fetcher.get().status());
+  ASSERT_SOME(fetcher.get().status().get());
+  EXPECT_EQ(0, fetcher.get().status().get().get());
+
+  EXPECT_SOME_EQ("file", os::read(path::join(directory, "file")));
+  EXPECT_SOME_EQ("extracted", os::read(path::join(directory, "extracted")));
+
+  terminate(server);
+  wait(server);
+}
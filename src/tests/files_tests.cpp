@@ -297,3 +297,54 @@ TEST_F(FilesTest, DownloadTest)
   AWAIT_EXPECT_RESPONSE_HEADER_EQ("image/gif", "Content-Type", response);
   AWAIT_EXPECT_RESPONSE_BODY_EQ(data, response);
 }
+
+
+TEST_F(FilesTest, RawTest)
+{
+  // Cap reads at 8 bytes.
+  Files files(Bytes(8));
+  process::UPID upid("files", process::ip(), process::port());
+
+  ASSERT_SOME(os::write("file", "0123456789"));
+  AWAIT_EXPECT_READY(files.attach("file", "file"));
+
+  // Read the whole file, which gets capped.
+  Future<Response> response = process::http::get(upid, "raw", "path=file");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ("206 Partial Content", response);
+  AWAIT_EXPECT_RESPONSE_HEADER_EQ(
+      "bytes 0-7/10",
+      "Content-Range",
+      response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("01234567", response);
+
+  // Read a range of the file.
+  response = process::http::get(upid, "raw", "path=file&offset=2&length=3");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ("206 Partial Content", response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("234", response);
+
+  // Read past the end of the file.
+  response = process::http::get(upid, "raw", "path=file&offset=10");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("", response);
+
+  // Wait for the file to grow.
+  response = process::http::get(upid, "raw", "path=file&offset=10&follow=true");
+
+  Try<int> fd = os::open("file", O_WRONLY | O_APPEND);
+  ASSERT_SOME(fd);
+  ASSERT_SOME(os::write(fd.get(), "abc"));
+  os::close(fd.get());
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ("206 Partial Content", response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("abc", response);
+
+  // Give up waiting once the timeout expires.
+  response = process::http::get(
+      upid, "raw", "path=file&offset=13&follow=true&timeout=10ms");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ("", response);
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(
+      BadRequest().status,
+      process::http::get(upid, "raw", "path=file&offset=-1"));
+}
@@ -35,9 +35,13 @@
 #include <process/process.hpp>
 
 #include <stout/duration.hpp>
+#include <stout/fs.hpp>
+#include <stout/foreach.hpp>
 #include <stout/gtest.hpp>
 #include <stout/nothing.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
+#include <stout/stringify.hpp>
 
 #include "logging/logging.hpp"
 
@@ -246,6 +250,117 @@ TEST_F(GarbageCollectorTest, Prune)
 }
 
 
+// Unschedules paths right after they are due, i.e., while they are
+// queued or being removed, and checks that an unscheduled path is
+// left alone and that a path that couldn't be unscheduled is gone by
+// the time the unschedule completes.
+TEST_F(GarbageCollectorTest, UnscheduleRemoving)
+{
+  GarbageCollector gc;
+
+  const int DIRECTORIES = 10;
+
+  vector<string> directories;
+  vector<Future<Nothing> > schedules;
+
+  Clock::pause();
+
+  for (int i = 0; i < DIRECTORIES; i++) {
+    const string& directory = "directory" + stringify(i);
+
+    ASSERT_SOME(os::mkdir(directory));
+    for (int j = 0; j < 100; j++) {
+      ASSERT_SOME(os::touch(path::join(directory, stringify(j))));
+    }
+
+    directories.push_back(directory);
+    schedules.push_back(gc.schedule(Seconds(10), directory));
+  }
+
+  // Make the paths due and hand them to the pool.
+  Clock::advance(Seconds(10));
+  Clock::settle();
+
+  vector<Future<bool> > unschedules;
+  foreach (const string& directory, directories) {
+    unschedules.push_back(gc.unschedule(directory));
+  }
+
+  for (int i = 0; i < DIRECTORIES; i++) {
+    AWAIT_READY(unschedules[i]);
+
+    if (unschedules[i].get()) {
+      AWAIT_DISCARDED(schedules[i]);
+      EXPECT_TRUE(os::exists(path::join(directories[i], "0")));
+    } else {
+      AWAIT_READY(schedules[i]);
+      EXPECT_FALSE(os::exists(directories[i]));
+    }
+  }
+
+  Clock::resume();
+}
+
+
+// Removes a number of directory trees concurrently and checks that
+// the space they took is accounted for.
+TEST_F(GarbageCollectorTest, RemoveDirectories)
+{
+  GarbageCollector gc;
+
+  const int DIRECTORIES = 10;
+  const int FILES = 100;
+
+  list<string> directories;
+  list<Future<Nothing> > schedules;
+
+  for (int i = 0; i < DIRECTORIES; i++) {
+    const string& directory = "directory" + stringify(i);
+    const string& subdirectory = path::join(directory, "a/b/c");
+
+    ASSERT_SOME(os::mkdir(subdirectory));
+    ASSERT_SOME(fs::symlink(subdirectory, path::join(directory, "link")));
+
+    for (int j = 0; j < FILES; j++) {
+      ASSERT_SOME(os::write(
+          path::join(j % 2 == 0 ? directory : subdirectory, stringify(j)),
+          string(4096, 'x')));
+    }
+
+    directories.push_back(directory);
+    schedules.push_back(gc.schedule(Seconds(10), directory));
+  }
+
+  gc.prune(Seconds(10));
+
+  foreach (const Future<Nothing>& schedule, schedules) {
+    AWAIT_READY(schedule);
+  }
+
+  foreach (const string& directory, directories) {
+    EXPECT_FALSE(os::exists(directory));
+  }
+
+  Future<JSON::Object> statistics = gc.statistics();
+  AWAIT_READY(statistics);
+
+  JSON::Object object = statistics.get();
+
+  EXPECT_EQ(1u, object.values.count("gc_removals"));
+  EXPECT_EQ(1u, object.values.count("gc_reclaimed_bytes"));
+  EXPECT_EQ(1u, object.values.count("gc_reclaimed_bytes_per_sec"));
+
+  JSON::Value removals = object.values["gc_removals"];
+  ASSERT_TRUE(removals.is<JSON::Number>());
+  EXPECT_EQ(DIRECTORIES, removals.as<JSON::Number>().value);
+
+  // Each file takes at least 4KB.
+  JSON::Value reclaimed = object.values["gc_reclaimed_bytes"];
+  ASSERT_TRUE(reclaimed.is<JSON::Number>());
+  EXPECT_LE(DIRECTORIES * FILES * 4096, reclaimed.as<JSON::Number>().value);
+}
+
+
 class GarbageCollectorIntegrationTest : public MesosTest {};
 
 
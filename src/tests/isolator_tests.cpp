@@ -20,6 +20,7 @@
 
 #include <gmock/gmock.h>
 
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,7 @@
 
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
 
 #include "master/master.hpp"
 #include "master/detector.hpp"
@@ -43,6 +45,7 @@
 #endif // __linux__
 #include "slave/containerizer/isolator.hpp"
 #include "slave/containerizer/launcher.hpp"
+#include "slave/containerizer/process_table.hpp"
 
 #include "slave/containerizer/isolators/posix.hpp"
 #ifdef __linux__
@@ -71,8 +74,10 @@ using mesos::internal::slave::Launcher;
 using mesos::internal::slave::PosixLauncher;
 using mesos::internal::slave::PosixCpuIsolatorProcess;
 using mesos::internal::slave::PosixMemIsolatorProcess;
+using mesos::internal::slave::ProcessTable;
 using mesos::internal::slave::Flags;
 
+using std::list;
 using std::string;
 using std::vector;
 
@@ -576,3 +581,208 @@ TYPED_TEST(MemIsolatorTest, MemUsage)
   delete isolator.get();
   delete launcher.get();
 }
+
+
+#ifdef __linux__
+class LimitedMemIsolatorTest : public MesosTest {};
+
+// This test verifies that the memory pressure events of a container
+// that keeps hitting its memory limit get counted.
+TEST_F(LimitedMemIsolatorTest, ROOT_CGROUPS_MemPressure)
+{
+  Flags flags;
+
+  Try<Isolator*> isolator = CgroupsMemIsolatorProcess::create(flags);
+  CHECK_SOME(isolator);
+
+  Try<Launcher*> launcher = CgroupsLauncher::create(flags);
+  CHECK_SOME(launcher);
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_resources()->CopyFrom(
+      Resources::parse("mem:64").get());
+
+  ContainerID containerId;
+  containerId.set_value("mesos_test_mem_pressure");
+
+  AWAIT_READY(isolator.get()->prepare(containerId, executorInfo));
+
+  Try<string> dir = os::mkdtemp();
+  ASSERT_SOME(dir);
+
+  // Writing more than the limit to a file makes the kernel reclaim
+  // the container's page cache, i.e., puts it under memory pressure.
+  string command = "dd if=/dev/zero of=" + path::join(dir.get(), "file") +
+    " bs=1M count=256";
+
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  lambda::function<int()> inChild = lambda::bind(&execute, command, pipes);
+
+  Try<pid_t> pid = launcher.get()->fork(containerId, inChild);
+  ASSERT_SOME(pid);
+
+  // Reap the forked child.
+  Future<Option<int> > status = process::reap(pid.get());
+
+  // Continue in the parent.
+  ::close(pipes[0]);
+
+  // Isolate the forked child.
+  AWAIT_READY(isolator.get()->isolate(containerId, pid.get()));
+
+  // Now signal the child to continue.
+  int buf;
+  ASSERT_LT(0, ::write(pipes[1], &buf, sizeof(buf)));
+  ::close(pipes[1]);
+
+  // Wait for the command to complete.
+  AWAIT_READY(status);
+
+  // The events are counted asynchronously, wait up to 5 seconds.
+  ResourceStatistics statistics;
+  Duration waited = Duration::zero();
+  do {
+    Future<ResourceStatistics> usage = isolator.get()->usage(containerId);
+    AWAIT_READY(usage);
+
+    statistics = usage.get();
+
+    if (statistics.mem_low_pressure_counter() > 0) {
+      break;
+    }
+
+    os::sleep(Milliseconds(100));
+    waited += Milliseconds(100);
+  } while (waited < Seconds(5));
+
+  EXPECT_LT(0u, statistics.mem_low_pressure_counter());
+
+  // A level's events are counted by the lower levels too.
+  EXPECT_GE(statistics.mem_low_pressure_counter(),
+            statistics.mem_medium_pressure_counter());
+  EXPECT_GE(statistics.mem_medium_pressure_counter(),
+            statistics.mem_critical_pressure_counter());
+
+  // Ensure all processes are killed.
+  AWAIT_READY(launcher.get()->destroy(containerId));
+
+  // Let the isolator clean up.
+  AWAIT_READY(isolator.get()->cleanup(containerId));
+
+  delete isolator.get();
+  delete launcher.get();
+
+  CHECK_SOME(os::rmdir(dir.get()));
+}
+#endif // __linux__
+
+
+TEST(ProcessTableTest, Tree)
+{
+  // The child blocks until the pipe gets closed.
+  int pipes[2];
+  ASSERT_NE(-1, ::pipe(pipes));
+
+  pid_t pid = ::fork();
+  ASSERT_NE(-1, pid);
+
+  if (pid == 0) {
+    ::close(pipes[1]);
+    int buf;
+    while (::read(pipes[0], &buf, sizeof(buf)) == -1 && errno == EINTR);
+    ::_exit(0);
+  }
+
+  ::close(pipes[0]);
+
+  Try<Shared<ProcessTable> > table = ProcessTable::snapshot(Duration::zero());
+  ASSERT_SOME(table);
+
+  // The snapshot is shared while it's fresh enough.
+  Try<Shared<ProcessTable> > same = ProcessTable::snapshot(Days(1));
+  ASSERT_SOME(same);
+  EXPECT_EQ(table.get(), same.get());
+
+  list<ProcessTable::Process> tree = table.get()->tree(::getpid());
+  ASSERT_LE(2u, tree.size());
+  EXPECT_EQ(::getpid(), tree.front().pid);
+
+  bool found = false;
+  foreach (const ProcessTable::Process& process, tree) {
+    if (process.pid == pid) {
+      EXPECT_EQ(::getpid(), process.parent);
+      EXPECT_SOME(process.rss);
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+
+  EXPECT_TRUE(table.get()->tree(-1).empty());
+
+  ::close(pipes[1]);
+  AWAIT_READY(process::reap(pid));
+}
+
+
+// Executed in a (possibly cloned) child, so it only makes system calls.
+static int executeTrue()
+{
+  execl("/bin/true", "true", (char*) NULL);
+  _exit(1);
+  return 1;
+}
+
+
+// Measures how long it takes a big process to launch processes, with
+// fork and with cloneVM (see --launcher_vfork).
+// NOTE: Disabled by default since it grows the heap to 1GB.
+TEST(LauncherTest, DISABLED_ForkBenchmark)
+{
+  const size_t count = 50;
+
+  // Grow the heap, touching every page so that it gets mapped.
+  const Bytes size = Gigabytes(1);
+  char* heap = new char[size.bytes()];
+  memset(heap, 1, size.bytes());
+
+#ifdef __linux__
+  const int variants = 2; // fork and cloneVM.
+#else
+  const int variants = 1; // Only fork, cloneVM needs Linux.
+#endif
+
+  for (int vfork = 0; vfork < variants; vfork++) {
+    Flags flags;
+    flags.launcher_vfork = vfork;
+
+    Try<Launcher*> launcher = PosixLauncher::create(flags);
+    ASSERT_SOME(launcher);
+
+    vector<ContainerID> containerIds;
+
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    for (size_t i = 0; i < count; i++) {
+      ContainerID containerId;
+      containerId.set_value("benchmark_" + stringify(i));
+      containerIds.push_back(containerId);
+
+      ASSERT_SOME(launcher.get()->fork(containerId, &executeTrue));
+    }
+
+    std::cout << "Launched " << count << " processes from a " << size
+              << " heap with " << (vfork ? "cloneVM" : "fork") << " in "
+              << stopwatch.elapsed() << std::endl;
+
+    foreach (const ContainerID& containerId, containerIds) {
+      AWAIT_READY(launcher.get()->destroy(containerId));
+    }
+
+    delete launcher.get();
+  }
+
+  delete[] heap;
+}
@@ -20,6 +20,7 @@
 
 #include <stdint.h>
 
+#include <iostream>
 #include <list>
 #include <set>
 #include <string>
@@ -66,6 +67,8 @@ using namespace mesos::internal::tests;
 
 using namespace process;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::set;
 using std::string;
@@ -1663,6 +1666,83 @@ TEST_F(RecoverTest, CatchupRetry)
 }
 
 
+// Measures the time taken for an empty replica to catch-up a large
+// number of positions from a peer using batched and parallel
+// catch-up.
+TEST_F(RecoverTest, DISABLED_CatchupManyPositions)
+{
+  const uint64_t POSITIONS = 100000;
+
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  initializer.execute();
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  initializer.execute();
+
+  // Write the learned positions directly to the storage of the
+  // up-to-date replica, which is a lot faster than going through a
+  // coordinator.
+  {
+    LevelDBStorage storage;
+    ASSERT_SOME(storage.restore(path1));
+
+    for (uint64_t position = 1; position <= POSITIONS; position++) {
+      Action action;
+      action.set_position(position);
+      action.set_promised(1);
+      action.set_performed(1);
+      action.set_learned(true);
+      action.set_type(Action::APPEND);
+      action.mutable_append()->set_bytes(stringify(position));
+
+      ASSERT_SOME(storage.persist(action));
+    }
+  }
+
+  Shared<Replica> replica1(new Replica(path1));
+  Shared<Replica> replica2(new Replica(path2));
+
+  set<UPID> pids;
+  pids.insert(replica1->pid());
+  pids.insert(replica2->pid());
+
+  Shared<Network> network(new Network(pids));
+
+  IntervalSet<uint64_t> positions(
+      Bound<uint64_t>::closed(1),
+      Bound<uint64_t>::closed(POSITIONS));
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Future<Nothing> catching = catchup(
+      2,
+      replica2,
+      network,
+      None(),
+      positions,
+      Seconds(10),
+      CATCHUP_CONCURRENCY,
+      CATCHUP_BATCH_SIZE);
+
+  AWAIT_READY_FOR(catching, Minutes(5));
+
+  cout << "Caught-up " << POSITIONS << " positions in "
+       << stopwatch.elapsed() << endl;
+
+  Future<IntervalSet<uint64_t> > missing = replica2->missing(1, POSITIONS);
+  AWAIT_READY(missing);
+  EXPECT_TRUE(missing.get().empty());
+
+  Future<list<Action> > actions = replica2->read(POSITIONS, POSITIONS);
+  AWAIT_READY(actions);
+  ASSERT_EQ(1u, actions.get().size());
+  EXPECT_EQ(stringify(POSITIONS), actions.get().front().append().bytes());
+}
+
+
 class LogTest : public TemporaryDirectoryTest
 {
 protected:
@@ -1748,6 +1828,79 @@ TEST_F(LogTest, Position)
 }
 
 
+TEST_F(LogTest, Snapshot)
+{
+  const string path1 = os::getcwd() + "/.log1";
+  initializer.flags.path = path1;
+  initializer.execute();
+
+  const string path2 = os::getcwd() + "/.log2";
+  initializer.flags.path = path2;
+  initializer.execute();
+
+  Replica replica1(path1);
+
+  set<UPID> pids;
+  pids.insert(replica1.pid());
+
+  Log log(2, path2, pids);
+
+  Log::Writer writer(&log);
+
+  Future<Option<Log::Position> > start = writer.start();
+
+  AWAIT_READY(start);
+  ASSERT_SOME(start.get());
+
+  Future<Option<Log::Position> > position = writer.append("hello");
+
+  AWAIT_READY(position);
+  ASSERT_SOME(position.get());
+
+  Log::Position first = position.get().get();
+
+  position = writer.append("world");
+
+  AWAIT_READY(position);
+  ASSERT_SOME(position.get());
+
+  Future<Option<Log::Position> > snapshot = writer.snapshot("hello world");
+
+  AWAIT_READY(snapshot);
+  ASSERT_SOME(snapshot.get());
+  EXPECT_LT(position.get().get(), snapshot.get().get());
+
+  position = writer.append("tail");
+
+  AWAIT_READY(position);
+  ASSERT_SOME(position.get());
+
+  Log::Reader reader(&log);
+
+  // The snapshot is now the beginning of the log.
+  Future<Log::Position> beginning = reader.beginning();
+
+  AWAIT_READY(beginning);
+  EXPECT_EQ(snapshot.get().get(), beginning.get());
+
+  // The entries before the snapshot have been truncated.
+  AWAIT_FAILED(reader.read(first, position.get().get()));
+
+  Future<list<Log::Entry> > entries =
+    reader.read(beginning.get(), position.get().get());
+
+  AWAIT_READY(entries);
+
+  ASSERT_EQ(2u, entries.get().size());
+  EXPECT_EQ(snapshot.get().get(), entries.get().front().position);
+  EXPECT_TRUE(entries.get().front().snapshot);
+  EXPECT_EQ("hello world", entries.get().front().data);
+  EXPECT_EQ(position.get().get(), entries.get().back().position);
+  EXPECT_FALSE(entries.get().back().snapshot);
+  EXPECT_EQ("tail", entries.get().back().data);
+}
+
+
 #ifdef MESOS_HAS_JAVA
 // TODO(jieyu): We copy the code from TemporaryDirectoryTest here
 // because we cannot inherit from two test fixtures. In this future,
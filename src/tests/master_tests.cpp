@@ -20,6 +20,8 @@
 
 #include <gmock/gmock.h>
 
+#include <iostream>
+#include <list>
 #include <string>
 #include <vector>
 
@@ -27,15 +29,25 @@
 #include <mesos/scheduler.hpp>
 
 #include <process/clock.hpp>
+#include <process/collect.hpp>
+#include <process/dispatch.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
+#include <process/http.hpp>
+#include <process/id.hpp>
 #include <process/owned.hpp>
 #include <process/pid.hpp>
+#include <process/protobuf.hpp>
 
+#include <stout/bytes.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
+#include "common/attributes.hpp"
+#include "common/protobuf_utils.hpp"
+
 #include "master/flags.hpp"
 #include "master/master.hpp"
 
@@ -67,7 +79,13 @@ using process::Clock;
 using process::Future;
 using process::Owned;
 using process::PID;
+using process::Promise;
+using process::http::OK;
+using process::http::Response;
 
+using std::cout;
+using std::endl;
+using std::list;
 using std::string;
 using std::vector;
 
@@ -1262,6 +1280,220 @@ TEST_F(MasterTest, LaunchDuplicateOfferTest)
 }
 
 
+// A fake slave which registers with the master and "runs" every task
+// it gets by immediately sending status updates for it. This lets us
+// simulate large clusters without the cost of running real slaves.
+class FakeSlaveProcess : public ProtobufProcess<FakeSlaveProcess>
+{
+public:
+  FakeSlaveProcess(const PID<Master>& _master, const SlaveInfo& _info)
+    : ProcessBase(process::ID::generate("fake-slave")),
+      master(_master),
+      info(_info) {}
+
+  Future<Nothing> registered()
+  {
+    return promise.future();
+  }
+
+  // Sends a TASK_FINISHED update for every task we're running.
+  void finish()
+  {
+    foreach (const TaskID& taskId, tasks) {
+      update(taskId, TASK_FINISHED);
+    }
+    tasks.clear();
+  }
+
+protected:
+  virtual void initialize()
+  {
+    install<SlaveRegisteredMessage>(
+        &FakeSlaveProcess::_registered,
+        &SlaveRegisteredMessage::slave_id);
+
+    install<RunTaskMessage>(
+        &FakeSlaveProcess::runTask,
+        &RunTaskMessage::framework_id,
+        &RunTaskMessage::task);
+
+    RegisterSlaveMessage message;
+    message.mutable_slave()->MergeFrom(info);
+    send(master, message);
+  }
+
+private:
+  void _registered(const SlaveID& slaveId)
+  {
+    info.mutable_id()->MergeFrom(slaveId);
+    promise.set(Nothing());
+  }
+
+  void runTask(const FrameworkID& _frameworkId, const TaskInfo& task)
+  {
+    frameworkId = _frameworkId;
+    tasks.push_back(task.task_id());
+    update(task.task_id(), TASK_RUNNING);
+  }
+
+  void update(const TaskID& taskId, const TaskState& state)
+  {
+    StatusUpdateMessage message;
+    message.mutable_update()->MergeFrom(internal::protobuf::createStatusUpdate(
+        frameworkId, info.id(), taskId, state));
+    message.set_pid(self());
+    send(master, message);
+  }
+
+  const PID<Master> master;
+  SlaveInfo info;
+  FrameworkID frameworkId;
+  list<TaskID> tasks;
+  Promise<Nothing> promise;
+};
+
+
+// Returns the resident set size of the test process.
+static Bytes rss()
+{
+  Result<os::Process> process = os::process(getpid());
+  CHECK_SOME(process);
+  CHECK_SOME(process.get().rss);
+  return process.get().rss.get();
+}
+
+
+// Returns the growth from 'before' to 'after' split over 'count'.
+static Bytes growth(const Bytes& before, const Bytes& after, size_t count)
+{
+  return after > before ? Bytes((after - before).bytes() / count) : Bytes(0);
+}
+
+
+// Measures the master's memory footprint per offer and per task in a
+// simulated cluster of fake slaves. The numbers are only indicative
+// (they're based on the RSS of the whole test process, which also
+// includes the scheduler driver) so we don't assert anything on them.
+// NOTE: This is a benchmark and is disabled by default, run it with
+// --gtest_also_run_disabled_tests.
+TEST_F(MasterTest, DISABLED_MemoryFootprint)
+{
+  const size_t SLAVES = 1000;
+  const size_t TASKS_PER_SLAVE = 20;
+
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  Resources resources = Resources::parse(
+      "cpus:" + stringify(TASKS_PER_SLAVE) +
+      ";mem:" + stringify(TASKS_PER_SLAVE * 32)).get();
+
+  vector<FakeSlaveProcess*> slaves;
+  list<Future<Nothing> > registered;
+
+  for (size_t i = 0; i < SLAVES; i++) {
+    SlaveInfo info;
+    info.set_hostname("fake-slave-" + stringify(i) + ".example.com");
+    info.mutable_resources()->MergeFrom(resources);
+    info.mutable_attributes()->MergeFrom(Attributes::parse(
+        "rack:rack-" + stringify(i % 32) + ";zone:zone-" + stringify(i % 4)));
+
+    FakeSlaveProcess* slave = new FakeSlaveProcess(master.get(), info);
+    registered.push_back(slave->registered());
+    process::spawn(slave);
+    slaves.push_back(slave);
+  }
+
+  AWAIT_READY(process::collect(registered));
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _));
+
+  Future<vector<Offer> > offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  Bytes before = rss();
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_EQ(SLAVES, offers.get().size());
+
+  Bytes offered = rss();
+
+  // The offers still need to carry the slave's hostname and
+  // attributes even though the master doesn't keep them per offer.
+  EXPECT_TRUE(strings::startsWith(offers.get()[0].hostname(), "fake-slave-"));
+  EXPECT_EQ(2, offers.get()[0].attributes().size());
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .Times(SLAVES * TASKS_PER_SLAVE * 2); // TASK_RUNNING + TASK_FINISHED.
+
+  foreach (const Offer& offer, offers.get()) {
+    vector<TaskInfo> tasks;
+    for (size_t i = 0; i < TASKS_PER_SLAVE; i++) {
+      TaskInfo task;
+      task.set_name("task-" + stringify(i));
+      task.mutable_task_id()->set_value(
+          offer.slave_id().value() + "-" + stringify(i));
+      task.mutable_slave_id()->MergeFrom(offer.slave_id());
+      task.mutable_resources()->MergeFrom(
+          Resources::parse("cpus:1;mem:32").get());
+      task.mutable_command()->set_value("sleep 1000");
+      tasks.push_back(task);
+    }
+
+    driver.launchTasks(offer.id(), tasks);
+  }
+
+  // Wait for all of the TASK_RUNNING updates to be processed.
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  Bytes launched = rss();
+
+  cout << "Master memory per offer: " << growth(before, offered, SLAVES)
+       << " (" << SLAVES << " offers)" << endl;
+
+  cout << "Master memory per task: "
+       << growth(offered, launched, SLAVES * TASKS_PER_SLAVE)
+       << " (" << SLAVES * TASKS_PER_SLAVE << " tasks)" << endl;
+
+  // Complete all the tasks and make sure the master can still
+  // render its (now compacted) completed tasks.
+  foreach (FakeSlaveProcess* slave, slaves) {
+    process::dispatch(slave, &FakeSlaveProcess::finish);
+  }
+
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  Future<Response> state = process::http::get(master.get(), "state.json");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, state);
+
+  Future<Response> tasks = process::http::get(master.get(), "tasks.json");
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, tasks);
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+
+  foreach (FakeSlaveProcess* slave, slaves) {
+    process::terminate(slave);
+    process::wait(slave);
+    delete slave;
+  }
+}
+
+
 #ifdef MESOS_HAS_JAVA
 class MasterZooKeeperTest : public MesosTest
 {
@@ -16,8 +16,10 @@
  * limitations under the License.
  */
 
+#include <iostream>
 #include <limits>
 #include <map>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -32,6 +34,8 @@
 #include <process/process.hpp>
 
 #include <stout/nothing.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 
 #include "slave/constants.hpp"
 #include "slave/monitor.hpp"
@@ -44,14 +48,18 @@ using namespace mesos::internal::tests;
 
 using process::Clock;
 using process::Future;
+using process::Promise;
 
 using process::http::BadRequest;
 using process::http::NotFound;
 using process::http::OK;
 using process::http::Response;
 
+using std::cout;
+using std::endl;
 using std::numeric_limits;
 using std::string;
+using std::vector;
 
 using testing::_;
 using testing::DoAll;
@@ -167,6 +175,193 @@ TEST(MonitorTest, Collection)
 }
 
 
+// Checks that containers due at the same time get collected together
+// and that each container gets collected at its own interval.
+TEST(MonitorTest, BatchedCollection)
+{
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_framework_id()->set_value("framework");
+
+  ContainerID containerId1;
+  containerId1.set_value("container1");
+
+  ContainerID containerId2;
+  containerId2.set_value("container2");
+
+  ResourceStatistics statistics;
+  statistics.set_timestamp(0);
+
+  TestContainerizer containerizer;
+
+  Future<Nothing> usage1, usage2, usage3;
+  EXPECT_CALL(containerizer, usage(containerId1))
+    .WillOnce(DoAll(FutureSatisfy(&usage1),
+                    Return(statistics)))
+    .WillOnce(DoAll(FutureSatisfy(&usage2),
+                    Return(statistics)));
+
+  EXPECT_CALL(containerizer, usage(containerId2))
+    .WillOnce(DoAll(FutureSatisfy(&usage3),
+                    Return(statistics)));
+
+  slave::ResourceMonitor monitor(&containerizer);
+
+  process::Clock::pause();
+
+  const Duration interval = slave::RESOURCE_MONITORING_INTERVAL;
+
+  monitor.start(containerId1, executorInfo, interval);
+  monitor.start(containerId2, executorInfo, interval * 2);
+
+  process::Clock::settle();
+
+  // Only the first container is due.
+  process::Clock::advance(interval);
+  process::Clock::settle();
+
+  AWAIT_READY(usage1);
+  EXPECT_TRUE(usage3.isPending());
+
+  // Now both containers are due.
+  process::Clock::advance(interval);
+  process::Clock::settle();
+
+  AWAIT_READY(usage2);
+  AWAIT_READY(usage3);
+
+  monitor.stop(containerId1);
+  monitor.stop(containerId2);
+
+  process::Clock::settle();
+  process::Clock::resume();
+}
+
+
+// Checks that a container whose usage doesn't get collected (e.g.,
+// the containerizer is stuck) doesn't hold up the other containers.
+TEST(MonitorTest, HungCollection)
+{
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_framework_id()->set_value("framework");
+
+  ContainerID containerId1;
+  containerId1.set_value("container1");
+
+  ContainerID containerId2;
+  containerId2.set_value("container2");
+
+  ResourceStatistics statistics;
+  statistics.set_timestamp(0);
+
+  TestContainerizer containerizer;
+
+  // The first collection of the first container never completes.
+  Promise<ResourceStatistics> hung;
+
+  Future<Nothing> usage1, usage2, usage3, usage4;
+  EXPECT_CALL(containerizer, usage(containerId1))
+    .WillOnce(DoAll(FutureSatisfy(&usage1),
+                    Return(hung.future())))
+    .WillOnce(DoAll(FutureSatisfy(&usage3),
+                    Return(statistics)));
+
+  EXPECT_CALL(containerizer, usage(containerId2))
+    .WillOnce(DoAll(FutureSatisfy(&usage2),
+                    Return(statistics)))
+    .WillOnce(DoAll(FutureSatisfy(&usage4),
+                    Return(statistics)));
+
+  slave::ResourceMonitor monitor(&containerizer);
+
+  process::Clock::pause();
+
+  const Duration interval = slave::RESOURCE_MONITORING_INTERVAL;
+
+  monitor.start(containerId1, executorInfo, interval);
+  monitor.start(containerId2, executorInfo, interval);
+
+  process::Clock::settle();
+
+  process::Clock::advance(interval);
+  process::Clock::settle();
+
+  AWAIT_READY(usage1);
+  AWAIT_READY(usage2);
+
+  // The hung collection gets given up on after an interval, and both
+  // containers get collected again.
+  process::Clock::advance(interval);
+  process::Clock::settle();
+
+  EXPECT_TRUE(hung.future().hasDiscard());
+
+  AWAIT_READY(usage3);
+  AWAIT_READY(usage4);
+
+  monitor.stop(containerId1);
+  monitor.stop(containerId2);
+
+  process::Clock::settle();
+  process::Clock::resume();
+}
+
+
+// Measures the cost of a collection tick: how long it takes the
+// monitor to collect the usage of many containers (the containerizer
+// itself takes no time here).
+TEST(MonitorTest, DISABLED_CollectionBenchmark)
+{
+  const int CONTAINERS = 1000;
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_framework_id()->set_value("framework");
+
+  ResourceStatistics statistics;
+  statistics.set_timestamp(0);
+
+  TestContainerizer containerizer;
+
+  EXPECT_CALL(containerizer, usage(_))
+    .WillRepeatedly(Return(statistics));
+
+  slave::ResourceMonitor monitor(&containerizer);
+
+  process::Clock::pause();
+
+  const Duration interval = slave::RESOURCE_MONITORING_INTERVAL;
+
+  vector<ContainerID> containerIds;
+  for (int i = 0; i < CONTAINERS; i++) {
+    ContainerID containerId;
+    containerId.set_value("container" + stringify(i));
+    containerIds.push_back(containerId);
+
+    monitor.start(containerId, executorInfo, interval);
+  }
+
+  process::Clock::settle();
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  process::Clock::advance(interval);
+  process::Clock::settle();
+
+  cout << "Collected the resource usage of " << CONTAINERS
+       << " containers in " << stopwatch.elapsed() << endl;
+
+  foreach (const ContainerID& containerId, containerIds) {
+    monitor.stop(containerId);
+  }
+
+  process::Clock::settle();
+  process::Clock::resume();
+}
+
+
 TEST(MonitorTest, Statistics)
 {
   FrameworkID frameworkId;
@@ -297,3 +492,81 @@ TEST(MonitorTest, Statistics)
       response);
   AWAIT_EXPECT_RESPONSE_BODY_EQ("[]", response);
 }
+
+
+// Checks that the throttling of a container gets derived from its
+// consecutive collections.
+TEST(MonitorTest, Throttling)
+{
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->set_value("executor");
+  executorInfo.mutable_framework_id()->set_value("framework");
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  ResourceStatistics statistics1;
+  statistics1.set_cpus_nr_periods(100);
+  statistics1.set_cpus_nr_throttled(2);
+  statistics1.set_cpus_limit(1.0);
+  statistics1.set_timestamp(0);
+
+  // A quarter of the periods since the first collection throttled.
+  ResourceStatistics statistics2;
+  statistics2.CopyFrom(statistics1);
+  statistics2.set_cpus_nr_periods(200);
+  statistics2.set_cpus_nr_throttled(27);
+  statistics2.set_timestamp(1);
+
+  TestContainerizer containerizer;
+
+  Future<Nothing> usage1, usage2;
+  EXPECT_CALL(containerizer, usage(containerId))
+    .WillOnce(DoAll(FutureSatisfy(&usage1),
+                    Return(statistics1)))
+    .WillOnce(DoAll(FutureSatisfy(&usage2),
+                    Return(statistics2)));
+
+  slave::ResourceMonitor monitor(&containerizer);
+
+  process::Clock::pause();
+
+  monitor.start(
+      containerId,
+      executorInfo,
+      slave::RESOURCE_MONITORING_INTERVAL);
+
+  process::Clock::settle();
+
+  process::Clock::advance(slave::RESOURCE_MONITORING_INTERVAL);
+  process::Clock::settle();
+
+  AWAIT_READY(usage1);
+
+  process::Clock::settle();
+
+  process::Clock::advance(slave::RESOURCE_MONITORING_INTERVAL);
+  process::Clock::settle();
+
+  AWAIT_READY(usage2);
+
+  process::Clock::settle();
+
+  process::UPID upid("monitor", process::ip(), process::port());
+
+  Future<Response> response = process::http::get(upid, "throttling.json");
+
+  AWAIT_EXPECT_RESPONSE_STATUS_EQ(OK().status, response);
+  AWAIT_EXPECT_RESPONSE_BODY_EQ(
+      "[{"
+          "\"executor_id\":\"executor\","
+          "\"framework_id\":\"framework\","
+          "\"throttling\":[{\"ratio\":0.25,\"timestamp\":1}]"
+      "}]",
+      response);
+
+  monitor.stop(containerId);
+
+  process::Clock::settle();
+  process::Clock::resume();
+}
@@ -21,6 +21,7 @@
 
 #include <gtest/gtest.h>
 
+#include <iostream>
 #include <string>
 
 #include <mesos/executor.hpp>
@@ -36,6 +37,8 @@
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/path.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/strings.hpp>
 #include <stout/uuid.hpp>
 
 #include "common/protobuf_utils.hpp"
@@ -67,6 +70,8 @@ using mesos::internal::master::Master;
 using mesos::internal::slave::GarbageCollectorProcess;
 using mesos::internal::slave::Containerizer;
 
+using std::cout;
+using std::endl;
 using std::map;
 using std::string;
 using std::vector;
@@ -107,6 +112,314 @@ TEST_F(SlaveStateTest, CheckpointString)
   ASSERT_SOME_EQ(expected, os::read(file));
 }
 
+
+// Checkpoints the state of a slave running 'tasks' tasks (each with
+// a couple of acknowledged status updates) in an executor of a
+// framework under 'rootDir', the way the slave and the status update
+// manager do.
+static void checkpoint(
+    const string& rootDir,
+    const SlaveID& slaveId,
+    int tasks,
+    const string& framework = "framework",
+    const string& executor = "executor")
+{
+  FrameworkID frameworkId;
+  frameworkId.set_value(framework);
+
+  ExecutorID executorId;
+  executorId.set_value(executor);
+
+  ContainerID containerId;
+  containerId.set_value("container");
+
+  paths::createSlaveDirectory(rootDir, slaveId);
+
+  SlaveInfo slaveInfo;
+  slaveInfo.set_hostname("localhost");
+  slaveInfo.mutable_id()->CopyFrom(slaveId);
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getSlaveInfoPath(rootDir, slaveId), slaveInfo));
+
+  FrameworkInfo frameworkInfo;
+  frameworkInfo.set_user("user");
+  frameworkInfo.set_name("framework");
+  frameworkInfo.mutable_id()->CopyFrom(frameworkId);
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getFrameworkInfoPath(rootDir, slaveId, frameworkId),
+      frameworkInfo));
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getFrameworkPidPath(rootDir, slaveId, frameworkId),
+      "scheduler@127.0.0.1:5050"));
+
+  ExecutorInfo executorInfo;
+  executorInfo.mutable_executor_id()->CopyFrom(executorId);
+  executorInfo.mutable_command()->set_value("exit 0");
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getExecutorInfoPath(rootDir, slaveId, frameworkId, executorId),
+      executorInfo));
+
+  paths::createExecutorDirectory(
+      rootDir, slaveId, frameworkId, executorId, containerId);
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getForkedPidPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      "1"));
+
+  ASSERT_SOME(slave::state::checkpoint(
+      paths::getLibprocessPidPath(
+          rootDir, slaveId, frameworkId, executorId, containerId),
+      "executor@127.0.0.1:5051"));
+
+  for (int i = 0; i < tasks; i++) {
+    TaskID taskId;
+    taskId.set_value(stringify(i));
+
+    Task task;
+    task.set_name("task");
+    task.mutable_task_id()->CopyFrom(taskId);
+    task.mutable_framework_id()->CopyFrom(frameworkId);
+    task.mutable_executor_id()->CopyFrom(executorId);
+    task.mutable_slave_id()->CopyFrom(slaveId);
+    task.set_state(TASK_STAGING);
+
+    ASSERT_SOME(slave::state::checkpoint(
+        paths::getTaskInfoPath(
+            rootDir, slaveId, frameworkId, executorId, containerId, taskId),
+        task));
+
+    const string& path = paths::getTaskUpdatesPath(
+        rootDir, slaveId, frameworkId, executorId, containerId, taskId);
+
+    // Like the status update manager, keep the updates file open.
+    Option<int> fd = None();
+    if (!slave::state::journaled(path)) {
+      ASSERT_SOME(os::mkdir(os::dirname(path).get()));
+
+      Try<int> open = os::open(
+          path,
+          O_CREAT | O_WRONLY | O_APPEND | O_SYNC,
+          S_IRUSR | S_IWUSR | S_IRGRP | S_IRWXO);
+
+      ASSERT_SOME(open);
+      fd = open.get();
+    }
+
+    const TaskState states[] = { TASK_RUNNING, TASK_FINISHED };
+    foreach (const TaskState& state, states) {
+      StatusUpdateRecord update;
+      update.set_type(StatusUpdateRecord::UPDATE);
+      update.mutable_update()->CopyFrom(
+          mesos::internal::protobuf::createStatusUpdate(
+              frameworkId, slaveId, taskId, state, "", executorId));
+
+      StatusUpdateRecord ack;
+      ack.set_type(StatusUpdateRecord::ACK);
+      ack.set_uuid(update.update().uuid());
+
+      if (fd.isSome()) {
+        ASSERT_SOME(::protobuf::write(fd.get(), update));
+        ASSERT_SOME(::protobuf::write(fd.get(), ack));
+      } else {
+        ASSERT_SOME(slave::state::append(path, update));
+        ASSERT_SOME(slave::state::append(path, ack));
+      }
+    }
+
+    if (fd.isSome()) {
+      ASSERT_SOME(os::close(fd.get()));
+    }
+  }
+}
+
+
+// Checks that 'state' holds what 'checkpoint' above checkpointed.
+static void verify(const slave::state::SlaveState& state, int tasks)
+{
+  ASSERT_SOME(state.info);
+  ASSERT_EQ(1u, state.frameworks.size());
+
+  const slave::state::FrameworkState& framework =
+    state.frameworks.begin()->second;
+
+  ASSERT_SOME(framework.info);
+  ASSERT_SOME(framework.pid);
+  ASSERT_EQ(1u, framework.executors.size());
+
+  const slave::state::ExecutorState& executor =
+    framework.executors.begin()->second;
+
+  ASSERT_SOME(executor.info);
+  ASSERT_SOME(executor.latest);
+  ASSERT_EQ(1u, executor.runs.size());
+
+  const slave::state::RunState& run = executor.runs.begin()->second;
+
+  EXPECT_SOME_EQ(1, run.forkedPid);
+  EXPECT_SOME(run.libprocessPid);
+  EXPECT_FALSE(run.completed);
+  ASSERT_EQ((size_t) tasks, run.tasks.size());
+
+  foreachvalue (const slave::state::TaskState& task, run.tasks) {
+    EXPECT_SOME(task.info);
+    EXPECT_EQ(2u, task.updates.size());
+    EXPECT_EQ(2u, task.acks.size());
+  }
+
+  EXPECT_EQ(0u, state.errors);
+}
+
+
+TEST_F(SlaveStateTest, Journal)
+{
+  const string& rootDir = path::join(os::getcwd(), "meta");
+
+  ASSERT_SOME(slave::state::journal(rootDir));
+
+  SlaveID slaveId;
+  slaveId.set_value("slave");
+
+  checkpoint(rootDir, slaveId, 10);
+
+  // Only the directories (and "latest" symlinks) of the slave and
+  // the executor run should have been created.
+  EXPECT_FALSE(os::exists(paths::getSlaveInfoPath(rootDir, slaveId)));
+  EXPECT_TRUE(os::exists(paths::getJournalPath(rootDir)));
+
+  Result<slave::state::SlaveState> state =
+    slave::state::recover(rootDir, true);
+
+  ASSERT_SOME(state);
+  verify(state.get(), 10);
+
+  // Removing the framework should remove all of its state.
+  ASSERT_SOME(slave::state::remove(
+      paths::getFrameworkPath(rootDir, slaveId, state.get().frameworks
+                              .begin()->first)));
+
+  state = slave::state::recover(rootDir, true);
+
+  ASSERT_SOME(state);
+  EXPECT_SOME(state.get().info);
+  EXPECT_TRUE(state.get().frameworks.empty());
+
+  // Once closed, the journal gets reopened (and replayed) on recovery.
+  slave::state::closeJournal(rootDir);
+  EXPECT_FALSE(slave::state::journaled(
+      paths::getSlaveInfoPath(rootDir, slaveId)));
+
+  state = slave::state::recover(rootDir, true);
+
+  ASSERT_SOME(state);
+  EXPECT_SOME(state.get().info);
+  EXPECT_TRUE(state.get().frameworks.empty());
+  EXPECT_TRUE(slave::state::journaled(
+      paths::getSlaveInfoPath(rootDir, slaveId)));
+
+  slave::state::closeJournal(rootDir);
+}
+
+
+// Compares checkpointing and recovering a slave with many tasks
+// using a file per checkpoint and using the journal.
+TEST_F(SlaveStateTest, DISABLED_JournalBenchmark)
+{
+  const int TASKS = 1000;
+
+  SlaveID slaveId;
+  slaveId.set_value("slave");
+
+  const string& files = path::join(os::getcwd(), "files");
+  const string& journal = path::join(os::getcwd(), "journal");
+
+  ASSERT_SOME(slave::state::journal(journal));
+
+  foreach (const string& rootDir, strings::tokenize(
+               files + " " + journal, " ")) {
+    Stopwatch stopwatch;
+    stopwatch.start();
+
+    checkpoint(rootDir, slaveId, TASKS);
+
+    Duration checkpointing = stopwatch.elapsed();
+
+    stopwatch.start();
+
+    Result<slave::state::SlaveState> state =
+      slave::state::recover(rootDir, true);
+
+    Duration recovering = stopwatch.elapsed();
+
+    ASSERT_SOME(state);
+    verify(state.get(), TASKS);
+
+    cout << (rootDir == journal ? "Journal" : "Files") << ": checkpointed "
+         << TASKS << " tasks in " << checkpointing << " ("
+         << (TASKS / checkpointing.secs()) << " tasks/sec), recovered in "
+         << recovering << endl;
+  }
+
+  slave::state::closeJournal(journal);
+}
+
+
+// Recovers a slave with many frameworks and executors, which get
+// recovered in parallel.
+TEST_F(SlaveStateTest, DISABLED_RecoverManyExecutors)
+{
+  const int FRAMEWORKS = 10;
+  const int EXECUTORS = 20;
+  const int TASKS = 5;
+
+  const string& rootDir = path::join(os::getcwd(), "meta");
+
+  SlaveID slaveId;
+  slaveId.set_value("slave");
+
+  for (int i = 0; i < FRAMEWORKS; i++) {
+    for (int j = 0; j < EXECUTORS; j++) {
+      checkpoint(rootDir,
+                 slaveId,
+                 TASKS,
+                 "framework" + stringify(i),
+                 "executor" + stringify(j));
+    }
+  }
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  Result<slave::state::SlaveState> state =
+    slave::state::recover(rootDir, true);
+
+  Duration elapsed = stopwatch.elapsed();
+
+  ASSERT_SOME(state);
+  EXPECT_SOME(state.get().info);
+  EXPECT_EQ(0u, state.get().errors);
+  ASSERT_EQ((size_t) FRAMEWORKS, state.get().frameworks.size());
+
+  foreachvalue (const slave::state::FrameworkState& framework,
+                state.get().frameworks) {
+    EXPECT_SOME(framework.info);
+    EXPECT_SOME(framework.pid);
+    ASSERT_EQ((size_t) EXECUTORS, framework.executors.size());
+
+    foreachvalue (const slave::state::ExecutorState& executor,
+                  framework.executors) {
+      EXPECT_SOME(executor.info);
+      ASSERT_EQ(1u, executor.runs.size());
+      EXPECT_EQ((size_t) TASKS, executor.runs.begin()->second.tasks.size());
+    }
+  }
+
+  cout << "Recovered " << FRAMEWORKS * EXECUTORS << " executors ("
+       << FRAMEWORKS * EXECUTORS * TASKS << " tasks) in " << elapsed << endl;
+}
+
+
 template <typename T>
 class SlaveRecoveryTest : public ContainerizerTest<T>
 {
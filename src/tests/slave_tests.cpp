@@ -29,9 +29,12 @@
 #include <process/clock.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
+#include <process/http.hpp>
 #include <process/owned.hpp>
 #include <process/pid.hpp>
 
+#include <stout/hashmap.hpp>
+#include <stout/json.hpp>
 #include <stout/option.hpp>
 #include <stout/os.hpp>
 #include <stout/try.hpp>
@@ -64,6 +67,8 @@ using process::Future;
 using process::Owned;
 using process::PID;
 
+using process::http::Response;
+
 using std::string;
 using std::vector;
 
@@ -71,6 +76,8 @@ using testing::_;
 using testing::AtMost;
 using testing::DoAll;
 using testing::Eq;
+using testing::IgnoreResult;
+using testing::Invoke;
 using testing::Return;
 
 // Those of the overall Mesos master/slave/scheduler/driver tests
@@ -245,3 +252,345 @@ TEST_F(SlaveTest, RemoveUnregisteredTerminatedExecutor)
   Shutdown(); // Must shutdown before 'containerizer' gets deallocated.
 }
 
+
+
+// A containerizer whose launches can be held up: launches are mocked
+// and launch like the TestContainerizer by default (see '_launch').
+class LaunchContainerizer : public TestContainerizer
+{
+public:
+  explicit LaunchContainerizer(const hashmap<ExecutorID, Executor*>& executors)
+    : TestContainerizer(executors)
+  {
+    EXPECT_CALL(*this, launch(_, _, _, _, _, _, _))
+      .WillRepeatedly(Invoke(this, &LaunchContainerizer::_launch));
+  }
+
+  MOCK_METHOD7(
+      launch,
+      Future<Nothing>(
+          const ContainerID&,
+          const ExecutorInfo&,
+          const string&,
+          const Option<string>&,
+          const SlaveID&,
+          const PID<Slave>&,
+          bool checkpoint));
+
+  Future<Nothing> _launch(
+      const ContainerID& containerId,
+      const ExecutorInfo& executorInfo,
+      const string& directory,
+      const Option<string>& user,
+      const SlaveID& slaveId,
+      const PID<Slave>& slavePid,
+      bool checkpoint)
+  {
+    return TestContainerizer::launch(
+        containerId,
+        executorInfo,
+        directory,
+        user,
+        slaveId,
+        slavePid,
+        checkpoint);
+  }
+};
+
+
+// Returns the value of the statistic in the slave's 'stats.json'.
+static Try<double> statistic(const PID<Slave>& slave, const string& name)
+{
+  Future<Response> response = process::http::get(slave, "stats.json");
+  response.await(Seconds(10));
+
+  if (!response.isReady()) {
+    return Error("Failed to get 'stats.json'");
+  }
+
+  Try<JSON::Object> parse = JSON::parse<JSON::Object>(response.get().body);
+  if (parse.isError()) {
+    return Error(parse.error());
+  }
+
+  JSON::Object stats = parse.get();
+
+  if (stats.values.count(name) == 0 ||
+      !stats.values[name].is<JSON::Number>()) {
+    return Error("Missing statistic '" + name + "'");
+  }
+
+  return stats.values[name].as<JSON::Number>().value;
+}
+
+
+// This test ensures that with --executor_launch_concurrency=1 an
+// executor doesn't get launched while another one is being launched,
+// but gets queued and launched (and runs its task) once the earlier
+// launch finishes.
+TEST_F(SlaveTest, LaunchConcurrency)
+{
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  ExecutorInfo executor1; // Bug in gcc 4.1.*, must assign on next line.
+  executor1 = CREATE_EXECUTOR_INFO("executor-1", "exit 1");
+
+  ExecutorInfo executor2; // Bug in gcc 4.1.*, must assign on next line.
+  executor2 = CREATE_EXECUTOR_INFO("executor-2", "exit 1");
+
+  MockExecutor exec1(executor1.executor_id());
+  MockExecutor exec2(executor2.executor_id());
+
+  hashmap<ExecutorID, Executor*> execs;
+  execs[executor1.executor_id()] = &exec1;
+  execs[executor2.executor_id()] = &exec2;
+
+  LaunchContainerizer containerizer(execs);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.executor_launch_concurrency = 1;
+
+  Try<PID<Slave> > slave = StartSlave(&containerizer, flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .Times(1);
+
+  Future<vector<Offer> > offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_NE(0u, offers.get().size());
+
+  TaskInfo task1;
+  task1.set_name("");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task1.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:1;mem:512").get());
+  task1.mutable_executor()->MergeFrom(executor1);
+
+  TaskInfo task2;
+  task2.set_name("");
+  task2.mutable_task_id()->set_value("2");
+  task2.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task2.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:1;mem:512").get());
+  task2.mutable_executor()->MergeFrom(executor2);
+
+  vector<TaskInfo> tasks;
+  tasks.push_back(task1);
+  tasks.push_back(task2);
+
+  EXPECT_CALL(exec1, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec1, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  EXPECT_CALL(exec2, registered(_, _, _, _))
+    .Times(1);
+
+  EXPECT_CALL(exec2, launchTask(_, _))
+    .WillOnce(SendStatusUpdateFromTask(TASK_RUNNING));
+
+  Future<TaskStatus> status1, status2;
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillOnce(FutureArg<1>(&status1))
+    .WillOnce(FutureArg<1>(&status2));
+
+  // The first launch doesn't finish until we let it.
+  process::Promise<Nothing> launch;
+
+  Future<Nothing> launch1, launch2;
+  EXPECT_CALL(containerizer, launch(_, _, _, _, _, _, _))
+    .WillOnce(DoAll(IgnoreResult(
+                        Invoke(&containerizer, &LaunchContainerizer::_launch)),
+                    FutureSatisfy(&launch1),
+                    Return(launch.future())))
+    .WillOnce(DoAll(IgnoreResult(
+                        Invoke(&containerizer, &LaunchContainerizer::_launch)),
+                    FutureSatisfy(&launch2),
+                    Return(Nothing())));
+
+  Future<RunTaskMessage> runTask1 = FUTURE_PROTOBUF(RunTaskMessage(), _, _);
+  Future<RunTaskMessage> runTask2 = FUTURE_PROTOBUF(RunTaskMessage(), _, _);
+
+  driver.launchTasks(offers.get()[0].id(), tasks);
+
+  AWAIT_READY(runTask1);
+  AWAIT_READY(runTask2);
+  AWAIT_READY(launch1);
+
+  // Once the slave has handled both tasks, the second executor is
+  // queued rather than being launched.
+  Clock::pause();
+  Clock::settle();
+
+  EXPECT_TRUE(launch2.isPending());
+
+  Clock::resume();
+
+  EXPECT_SOME_EQ(1.0, statistic(slave.get(), "queued_launches_gauge"));
+  EXPECT_SOME_EQ(1.0, statistic(slave.get(), "launching_executors_gauge"));
+
+  // Finishing the first launch admits the second one.
+  launch.set(Nothing());
+
+  AWAIT_READY(launch2);
+
+  AWAIT_READY(status1);
+  EXPECT_EQ(TASK_RUNNING, status1.get().state());
+
+  AWAIT_READY(status2);
+  EXPECT_EQ(TASK_RUNNING, status2.get().state());
+
+  EXPECT_SOME_EQ(0.0, statistic(slave.get(), "queued_launches_gauge"));
+
+  EXPECT_CALL(exec1, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(exec2, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown(); // Must shutdown before 'containerizer' gets deallocated.
+}
+
+
+// This test ensures that an executor which is shut down while its
+// launch is queued terminates right away, without ever getting
+// launched.
+TEST_F(SlaveTest, ShutdownQueuedExecutor)
+{
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  ExecutorInfo executor1; // Bug in gcc 4.1.*, must assign on next line.
+  executor1 = CREATE_EXECUTOR_INFO("executor-1", "exit 1");
+
+  ExecutorInfo executor2; // Bug in gcc 4.1.*, must assign on next line.
+  executor2 = CREATE_EXECUTOR_INFO("executor-2", "exit 1");
+
+  MockExecutor exec1(executor1.executor_id());
+  MockExecutor exec2(executor2.executor_id());
+
+  hashmap<ExecutorID, Executor*> execs;
+  execs[executor1.executor_id()] = &exec1;
+  execs[executor2.executor_id()] = &exec2;
+
+  LaunchContainerizer containerizer(execs);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.executor_launch_concurrency = 1;
+
+  Try<PID<Slave> > slave = StartSlave(&containerizer, flags);
+  ASSERT_SOME(slave);
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, DEFAULT_FRAMEWORK_INFO, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(&driver, _, _))
+    .Times(1);
+
+  Future<vector<Offer> > offers;
+  EXPECT_CALL(sched, resourceOffers(&driver, _))
+    .WillOnce(FutureArg<1>(&offers))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  driver.start();
+
+  AWAIT_READY(offers);
+  ASSERT_NE(0u, offers.get().size());
+
+  TaskInfo task1;
+  task1.set_name("");
+  task1.mutable_task_id()->set_value("1");
+  task1.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task1.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:1;mem:512").get());
+  task1.mutable_executor()->MergeFrom(executor1);
+
+  TaskInfo task2;
+  task2.set_name("");
+  task2.mutable_task_id()->set_value("2");
+  task2.mutable_slave_id()->MergeFrom(offers.get()[0].slave_id());
+  task2.mutable_resources()->MergeFrom(
+      Resources::parse("cpus:1;mem:512").get());
+  task2.mutable_executor()->MergeFrom(executor2);
+
+  vector<TaskInfo> tasks;
+  tasks.push_back(task1);
+  tasks.push_back(task2);
+
+  EXPECT_CALL(exec1, registered(_, _, _, _))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(exec1, launchTask(_, _))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(exec1, shutdown(_))
+    .Times(AtMost(1));
+
+  EXPECT_CALL(sched, statusUpdate(&driver, _))
+    .WillRepeatedly(Return());
+
+  // The first launch never finishes, so the second executor stays
+  // queued. It must never get launched.
+  process::Promise<Nothing> launch;
+
+  Future<Nothing> launch1;
+  EXPECT_CALL(containerizer, launch(_, _, _, _, _, _, _))
+    .WillOnce(DoAll(IgnoreResult(
+                        Invoke(&containerizer, &LaunchContainerizer::_launch)),
+                    FutureSatisfy(&launch1),
+                    Return(launch.future())));
+
+  Future<RunTaskMessage> runTask1 = FUTURE_PROTOBUF(RunTaskMessage(), _, _);
+  Future<RunTaskMessage> runTask2 = FUTURE_PROTOBUF(RunTaskMessage(), _, _);
+
+  driver.launchTasks(offers.get()[0].id(), tasks);
+
+  AWAIT_READY(runTask1);
+  AWAIT_READY(runTask2);
+  AWAIT_READY(launch1);
+
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  EXPECT_SOME_EQ(1.0, statistic(slave.get(), "queued_launches_gauge"));
+
+  // Shutting down the framework shuts down its executors, the queued
+  // one terminates right away (the other one can't, it's launching).
+  Future<Nothing> executorTerminated =
+    FUTURE_DISPATCH(_, &Slave::executorTerminated);
+
+  driver.stop();
+  driver.join();
+
+  AWAIT_READY(executorTerminated);
+
+  EXPECT_SOME_EQ(0.0, statistic(slave.get(), "queued_launches_gauge"));
+
+  // Finishing the first launch doesn't launch the second executor.
+  launch.set(Nothing());
+
+  Clock::pause();
+  Clock::settle();
+  Clock::resume();
+
+  Shutdown(); // Must shutdown before 'containerizer' gets deallocated.
+}
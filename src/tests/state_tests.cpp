@@ -278,6 +278,52 @@ void FetchAndStoreAndExpungeAndStoreAndFetch(State* state)
 }
 
 
+void FetchAndStoreManyAndFetch(State* state)
+{
+  Future<Variable<Slaves> > future1 = state->fetch<Slaves>("slaves1");
+  AWAIT_READY(future1);
+
+  Future<Variable<Slaves> > future2 = state->fetch<Slaves>("slaves2");
+  AWAIT_READY(future2);
+
+  Slaves slaves1 = future1.get().get();
+  slaves1.add_slaves()->mutable_info()->set_hostname("localhost1");
+
+  Slaves slaves2 = future2.get().get();
+  slaves2.add_slaves()->mutable_info()->set_hostname("localhost2");
+
+  std::vector<Variable<Slaves> > variables;
+  variables.push_back(future1.get().mutate(slaves1));
+  variables.push_back(future2.get().mutate(slaves2));
+
+  Future<Option<std::vector<Variable<Slaves> > > > future3 =
+    state->store(variables);
+  AWAIT_READY(future3);
+  ASSERT_SOME(future3.get());
+  ASSERT_EQ(2u, future3.get().get().size());
+
+  // Storing the same variables again should succeed while storing
+  // the stale versions should fail and store neither of them.
+  std::vector<Variable<Slaves> > stale;
+  stale.push_back(future3.get().get()[0].mutate(Slaves()));
+  stale.push_back(future2.get().mutate(Slaves()));
+
+  future3 = state->store(stale);
+  AWAIT_READY(future3);
+  EXPECT_TRUE(future3.get().isNone());
+
+  future1 = state->fetch<Slaves>("slaves1");
+  AWAIT_READY(future1);
+  ASSERT_EQ(1, future1.get().get().slaves().size());
+  EXPECT_EQ("localhost1", future1.get().get().slaves(0).info().hostname());
+
+  future2 = state->fetch<Slaves>("slaves2");
+  AWAIT_READY(future2);
+  ASSERT_EQ(1, future2.get().get().slaves().size());
+  EXPECT_EQ("localhost2", future2.get().get().slaves(0).info().hostname());
+}
+
+
 void Names(State* state)
 {
   Future<Variable<Slaves> > future1 = state->fetch<Slaves>("slaves");
@@ -365,6 +411,12 @@ TEST_F(InMemoryStateTest, FetchAndStoreAndExpungeAndStoreAndFetch)
 }
 
 
+TEST_F(InMemoryStateTest, FetchAndStoreManyAndFetch)
+{
+  FetchAndStoreManyAndFetch(state);
+}
+
+
 TEST_F(InMemoryStateTest, Names)
 {
   Names(state);
@@ -438,6 +490,12 @@ TEST_F(LevelDBStateTest, FetchAndStoreAndExpungeAndStoreAndFetch)
 }
 
 
+TEST_F(LevelDBStateTest, FetchAndStoreManyAndFetch)
+{
+  FetchAndStoreManyAndFetch(state);
+}
+
+
 TEST_F(LevelDBStateTest, Names)
 {
   Names(state);
@@ -511,8 +569,104 @@ TEST_F(ZooKeeperStateTest, FetchAndStoreAndExpungeAndStoreAndFetch)
 }
 
 
+TEST_F(ZooKeeperStateTest, FetchAndStoreManyAndFetch)
+{
+  FetchAndStoreManyAndFetch(state);
+}
+
+
 TEST_F(ZooKeeperStateTest, Names)
 {
   Names(state);
 }
+
+
+// Tests that storing variables that fit in a znode each but are too
+// big (> 1 MB) to store together fails and stores none of them.
+TEST_F(ZooKeeperStateTest, StoreManyTooBig)
+{
+  Future<Variable<Slaves> > future1 = state->fetch<Slaves>("slaves1");
+  AWAIT_READY(future1);
+
+  Future<Variable<Slaves> > future2 = state->fetch<Slaves>("slaves2");
+  AWAIT_READY(future2);
+
+  Slaves slaves;
+  slaves.add_slaves()->mutable_info()->set_hostname(
+      std::string(600 * 1024, 'x'));
+
+  std::vector<Variable<Slaves> > variables;
+  variables.push_back(future1.get().mutate(slaves));
+  variables.push_back(future2.get().mutate(slaves));
+
+  AWAIT_FAILED(state->store(variables));
+
+  future1 = state->fetch<Slaves>("slaves1");
+  AWAIT_READY(future1);
+  EXPECT_EQ(0, future1.get().get().slaves().size());
+
+  future2 = state->fetch<Slaves>("slaves2");
+  AWAIT_READY(future2);
+  EXPECT_EQ(0, future2.get().get().slaves().size());
+
+  // Each of them still fits on its own.
+  Future<Option<Variable<Slaves> > > future3 =
+    state->store(future1.get().mutate(slaves));
+  AWAIT_READY(future3);
+  EXPECT_SOME(future3.get());
+}
+
+
+// Tests that a caching ZooKeeperStorage sees writes made through
+// another storage (via watches) as well as its own writes.
+TEST_F(ZooKeeperStateTest, Cache)
+{
+  ZooKeeperStorage cachedStorage(
+      server->connectString(),
+      NO_TIMEOUT,
+      "/state/",
+      None(),
+      true);
+
+  State cached(&cachedStorage);
+
+  // Check that our own writes are seen through the cache.
+  FetchAndStoreAndFetch(&cached);
+
+  Future<Variable<Slaves> > future1 = cached.fetch<Slaves>("cached");
+  AWAIT_READY(future1);
+  EXPECT_EQ(0, future1.get().get().slaves().size());
+
+  // Now store through the non-caching storage.
+  Future<Variable<Slaves> > future2 = state->fetch<Slaves>("cached");
+  AWAIT_READY(future2);
+
+  Slaves slaves = future2.get().get();
+  slaves.add_slaves()->mutable_info()->set_hostname("localhost");
+
+  Future<Option<Variable<Slaves> > > future3 =
+    state->store(future2.get().mutate(slaves));
+  AWAIT_READY(future3);
+  ASSERT_SOME(future3.get());
+
+  // The watch gets delivered asynchronously so poll until the
+  // caching storage sees the new value.
+  Duration waited = Duration::zero();
+  Variable<Slaves> variable = future1.get();
+  do {
+    os::sleep(Milliseconds(10));
+    waited += Milliseconds(10);
+
+    Future<Variable<Slaves> > future4 = cached.fetch<Slaves>("cached");
+    AWAIT_READY(future4);
+    variable = future4.get();
+  } while (variable.get().slaves().size() == 0 && waited < Seconds(10));
+
+  ASSERT_EQ(1, variable.get().slaves().size());
+  EXPECT_EQ("localhost", variable.get().slaves(0).info().hostname());
+
+  Future<std::vector<std::string> > names = cached.names();
+  AWAIT_READY(names);
+  EXPECT_EQ(2u, names.get().size());
+}
 #endif // MESOS_HAS_JAVA
@@ -18,6 +18,7 @@
 
 #include <gmock/gmock.h>
 
+#include <iostream>
 #include <list>
 #include <string>
 #include <vector>
@@ -26,14 +27,18 @@
 #include <mesos/scheduler.hpp>
 
 #include <process/clock.hpp>
+#include <process/collect.hpp>
 #include <process/future.hpp>
 #include <process/gmock.hpp>
 #include <process/pid.hpp>
 
 #include <stout/none.hpp>
 #include <stout/os.hpp>
+#include <stout/path.hpp>
 #include <stout/protobuf.hpp>
 #include <stout/result.hpp>
+#include <stout/stopwatch.hpp>
+#include <stout/stringify.hpp>
 #include <stout/try.hpp>
 
 #include "master/master.hpp"
@@ -41,10 +46,13 @@
 #include "slave/constants.hpp"
 #include "slave/paths.hpp"
 #include "slave/slave.hpp"
+#include "slave/state.hpp"
+#include "slave/status_update_manager.hpp"
 
 #include "messages/messages.hpp"
 
 #include "tests/mesos.hpp"
+#include "tests/utils.hpp"
 
 using namespace mesos;
 using namespace mesos::internal;
@@ -54,11 +62,15 @@ using namespace mesos::internal::slave::paths;
 using mesos::internal::master::Master;
 
 using mesos::internal::slave::Slave;
+using mesos::internal::slave::StatusUpdateWriter;
 
 using process::Clock;
+using process::collect;
 using process::Future;
 using process::PID;
 
+using std::cout;
+using std::endl;
 using std::list;
 using std::string;
 using std::vector;
@@ -780,3 +792,145 @@ TEST_F(StatusUpdateManagerTest, DuplicateUpdateBeforeAck)
 
   Shutdown();
 }
+
+
+// This test verifies that the status updates of many tasks, which
+// get forwarded and acknowledged in batches, all make it to the
+// scheduler and reports the end-to-end status update throughput.
+TEST_F(StatusUpdateManagerTest, DISABLED_StatusUpdateThroughput)
+{
+  const size_t tasks = 100;
+
+  Try<PID<Master> > master = StartMaster();
+  ASSERT_SOME(master);
+
+  MockExecutor exec(DEFAULT_EXECUTOR_ID);
+
+  slave::Flags flags = CreateSlaveFlags();
+  flags.checkpoint = true;
+
+  Try<PID<Slave> > slave = StartSlave(&exec, flags);
+  ASSERT_SOME(slave);
+
+  FrameworkInfo frameworkInfo; // Bug in gcc 4.1.*, must assign on next line.
+  frameworkInfo = DEFAULT_FRAMEWORK_INFO;
+  frameworkInfo.set_checkpoint(true); // Enable checkpointing.
+
+  MockScheduler sched;
+  MesosSchedulerDriver driver(
+      &sched, frameworkInfo, master.get(), DEFAULT_CREDENTIAL);
+
+  EXPECT_CALL(sched, registered(_, _, _))
+    .Times(1);
+
+  EXPECT_CALL(sched, resourceOffers(_, _))
+    .WillOnce(LaunchTasks(DEFAULT_EXECUTOR_INFO, tasks, 0.01, 1, "*"))
+    .WillRepeatedly(Return()); // Ignore subsequent offers.
+
+  Future<Nothing> registered;
+  EXPECT_CALL(exec, registered(_, _, _, _))
+    .WillOnce(FutureSatisfy(&registered));
+
+  EXPECT_CALL(exec, launchTask(_, _))
+    .WillRepeatedly(SendStatusUpdateFromTask(TASK_FINISHED));
+
+  vector<Future<TaskStatus> > statuses(tasks);
+  for (size_t i = 0; i < tasks; i++) {
+    EXPECT_CALL(sched, statusUpdate(&driver, _))
+      .WillOnce(FutureArg<1>(&statuses[i]))
+      .RetiresOnSaturation();
+  }
+
+  driver.start();
+
+  AWAIT_READY(registered);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  foreach (const Future<TaskStatus>& status, statuses) {
+    AWAIT_READY(status);
+    EXPECT_EQ(TASK_FINISHED, status.get().state());
+  }
+
+  cout << "Received " << tasks << " status updates in "
+       << stopwatch.elapsed() << endl;
+
+  EXPECT_CALL(exec, shutdown(_))
+    .Times(AtMost(1));
+
+  driver.stop();
+  driver.join();
+
+  Shutdown();
+}
+
+
+class StatusUpdateWriterTest : public TemporaryDirectoryTest {};
+
+
+// This test verifies that the records appended to many updates files
+// at once all get written, in order, and compares the time it takes
+// with synchronously appending the records one at a time.
+TEST_F(StatusUpdateWriterTest, DISABLED_GroupCommit)
+{
+  const size_t tasks = 100;
+  const size_t records = 10;
+
+  StatusUpdateRecord record;
+  record.set_type(StatusUpdateRecord::ACK);
+
+  Stopwatch stopwatch;
+  stopwatch.start();
+
+  for (size_t i = 0; i < records; i++) {
+    record.set_uuid(stringify(i));
+    for (size_t j = 0; j < tasks; j++) {
+      const string& path = path::join(os::getcwd(), "sync", stringify(j));
+      ASSERT_SOME(slave::state::append(path, record));
+    }
+  }
+
+  cout << "Synchronously appended " << tasks * records << " records in "
+       << stopwatch.elapsed() << endl;
+
+  StatusUpdateWriter writer;
+
+  list<Future<Nothing> > futures;
+
+  stopwatch.start();
+
+  for (size_t i = 0; i < records; i++) {
+    record.set_uuid(stringify(i));
+    for (size_t j = 0; j < tasks; j++) {
+      const string& path = path::join(os::getcwd(), "async", stringify(j));
+      futures.push_back(writer.append(path, record));
+    }
+  }
+
+  AWAIT_READY(collect(futures));
+
+  cout << "Group committed " << tasks * records << " records in "
+       << stopwatch.elapsed() << endl;
+
+  for (size_t j = 0; j < tasks; j++) {
+    const string& path = path::join(os::getcwd(), "async", stringify(j));
+
+    Try<int> fd = os::open(path, O_RDONLY);
+    ASSERT_SOME(fd);
+
+    for (size_t i = 0; i < records; i++) {
+      Result<StatusUpdateRecord> record =
+        ::protobuf::read<StatusUpdateRecord>(fd.get());
+
+      ASSERT_SOME(record);
+      EXPECT_EQ(stringify(i), record.get().uuid());
+    }
+
+    EXPECT_NONE(::protobuf::read<StatusUpdateRecord>(fd.get()));
+
+    close(fd.get());
+
+    writer.close(path);
+  }
+}
@@ -229,6 +229,25 @@ public:
     return future;
   }
 
+  Future<int> multi(int count, const zoo_op_t* ops, zoo_op_result_t* results)
+  {
+    Promise<int>* promise = new Promise<int>();
+
+    Future<int> future = promise->future();
+
+    tuple<Promise<int>*>* args = new tuple<Promise<int>*>(promise);
+
+    int ret = zoo_amulti(zh, count, ops, results, voidCompletion, args);
+
+    if (ret != ZOK) {
+      delete promise;
+      delete args;
+      return ret;
+    }
+
+    return future;
+  }
+
 private:
   // This method is registered as a watcher callback function and is
   // invoked by a single ZooKeeper event thread.
@@ -480,6 +499,12 @@ int ZooKeeper::set(const string& path, const string& data, int version)
 }
 
 
+int ZooKeeper::multi(int count, const zoo_op_t* ops, zoo_op_result_t* results)
+{
+  return impl->multi(count, ops, results).get();
+}
+
+
 string ZooKeeper::message(int code) const
 {
   return string(zerror(code));
@@ -302,6 +302,28 @@ public:
    */
   int set(const std::string &path, const std::string &data, int version);
 
+  /**
+   * \brief atomically commits a group of operations synchronously.
+   *
+   * \param count the number of operations.
+   * \param ops the operations, initialized with zoo_create_op_init,
+   * zoo_delete_op_init, zoo_set_op_init or zoo_check_op_init.
+   * \param results the results of the individual operations (must
+   * have room for 'count' results).
+   * \return the return code for the function call. Either all of the
+   * operations are applied or none of them are, in which case the
+   * code of the first operation that failed is returned.
+   * ZOK operation completed succesfully
+   * ZNONODE a node does not exist.
+   * ZNODEEXISTS a node already exists.
+   * ZNOAUTH the client does not have permission.
+   * ZBADVERSION expected version does not match actual version.
+   * ZBADARGUMENTS - invalid input parameters
+   * ZINVALIDSTATE - zhandle state is either ZOO_SESSION_EXPIRED_STATE or ZOO_AUTH_FAILED_STATE
+   * ZMARSHALLINGERROR - failed to marshall a request; possibly, out of memory
+   */
+  int multi(int count, const zoo_op_t* ops, zoo_op_result_t* results);
+
   /**
    * \brief return a message describing the return code.
    *